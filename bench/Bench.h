@@ -0,0 +1,377 @@
+/*
+     Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+     This file is shared by the benchmarks of CCSoft and RSSoft
+
+     This program is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published by
+     the Free Software Foundation; either version 2 of the License, or
+     (at your option) any later version.
+
+     This program is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+     GNU General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with this program; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+     Minimal benchmark harness in the style of Google Benchmark. Each
+     benchmark loops on while (state.keep_running()) and the number of
+     iterations is doubled until the run lasts at least the minimum time.
+     Both wall clock and thread CPU times are measured. Results are
+     printed as a table and optionally written as JSON with the fields of
+     Google Benchmark's --benchmark_format=json iteration runs (name,
+     run_name, run_type, iterations, real_time, cpu_time, time_unit) so
+     that its compare.py tool can be used on two result files.
+
+*/
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <time.h>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <functional>
+
+/**
+ * Prevents the compiler from optimizing away a value computed in a benchmark loop
+ */
+template<typename T>
+inline void bench_do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// ================================================================================================
+// State of one benchmark run: drives the loop and collects user counters
+class BenchState
+{
+public:
+    BenchState(unsigned long long _max_iterations) :
+        max_iterations(_max_iterations),
+        nb_iterations(0),
+        elapsed_ns(0),
+        cpu_elapsed_ns(0),
+        paused(false)
+    {}
+
+    /**
+     * Loop condition of the benchmark. Starts the clock on the first call and stops it on the last.
+     */
+    bool keep_running()
+    {
+        if (nb_iterations == 0)
+        {
+            start_clock();
+        }
+
+        if (nb_iterations < max_iterations)
+        {
+            nb_iterations++;
+            return true;
+        }
+
+        stop_clock();
+        return false;
+    }
+
+    /**
+     * Stop the clock e.g. while preparing the input of the next iteration
+     */
+    void pause_timing()
+    {
+        stop_clock();
+        paused = true;
+    }
+
+    /**
+     * Restart the clock after pause_timing()
+     */
+    void resume_timing()
+    {
+        paused = false;
+        start_clock();
+    }
+
+    /**
+     * Set a user counter reported with the benchmark results (e.g. success rate, nodes per decode)
+     */
+    void set_counter(const std::string& name, double value)
+    {
+        counters[name] = value;
+    }
+
+    unsigned long long get_max_iterations() const { return max_iterations; }
+    unsigned long long get_nb_iterations() const { return nb_iterations; }
+    unsigned long long get_elapsed_ns() const { return elapsed_ns; }
+    unsigned long long get_cpu_elapsed_ns() const { return cpu_elapsed_ns; }
+    const std::map<std::string, double>& get_counters() const { return counters; }
+
+protected:
+    static unsigned long long interval_ns(const timespec& start, const timespec& stop)
+    {
+        return (stop.tv_sec - start.tv_sec)*1000000000ULL + stop.tv_nsec - start.tv_nsec;
+    }
+
+    void start_clock()
+    {
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_start_time);
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+    }
+
+    void stop_clock()
+    {
+        if (!paused)
+        {
+            timespec stop_time, cpu_stop_time;
+            clock_gettime(CLOCK_MONOTONIC, &stop_time);
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_stop_time);
+            elapsed_ns += interval_ns(start_time, stop_time);
+            cpu_elapsed_ns += interval_ns(cpu_start_time, cpu_stop_time);
+        }
+    }
+
+    unsigned long long max_iterations;
+    unsigned long long nb_iterations;
+    unsigned long long elapsed_ns;
+    unsigned long long cpu_elapsed_ns;
+    bool paused;
+    timespec start_time;
+    timespec cpu_start_time;
+    std::map<std::string, double> counters;
+};
+
+typedef std::function<void(BenchState&)> BenchFunction;
+
+// ================================================================================================
+// Registry and runner of the benchmarks of a program
+class BenchRunner
+{
+public:
+    /**
+     * Constructor. Recognized options:
+     *   --filter=STRING    run only the benchmarks whose name contains STRING
+     *   --min-time=SECONDS minimum duration of each benchmark (default 0.5)
+     *   --json=FILE        write the results as JSON to FILE
+     *   --list             list the benchmarks and exit
+     */
+    BenchRunner(const std::string& _program_name, int argc, char *argv[]) :
+        program_name(_program_name),
+        min_time(0.5),
+        list_only(false),
+        valid_options(true)
+    {
+        for (int i=1; i<argc; i++)
+        {
+            if (strncmp(argv[i], "--filter=", 9) == 0)
+            {
+                filter = argv[i] + 9;
+            }
+            else if (strncmp(argv[i], "--min-time=", 11) == 0)
+            {
+                min_time = atof(argv[i] + 11);
+            }
+            else if (strncmp(argv[i], "--json=", 7) == 0)
+            {
+                json_filename = argv[i] + 7;
+            }
+            else if (strcmp(argv[i], "--list") == 0)
+            {
+                list_only = true;
+            }
+            else
+            {
+                std::cerr << "Unknown option " << argv[i] << std::endl;
+                std::cerr << "Usage: " << argv[0] << " [--filter=STRING] [--min-time=SECONDS] [--json=FILE] [--list]" << std::endl;
+                valid_options = false;
+            }
+        }
+    }
+
+    /**
+     * Register a benchmark
+     * \param name Benchmark name. By convention family/parameter1/parameter2...
+     * \param function Benchmark function
+     * \param max_iterations Cap on the number of iterations e.g. for slow macro benchmarks
+     */
+    void add(const std::string& name, const BenchFunction& function, unsigned long long max_iterations = 1ULL<<30)
+    {
+        benchmarks.push_back(Benchmark(name, function, max_iterations));
+    }
+
+    /**
+     * Run the selected benchmarks, print the results and write the JSON file if requested
+     * \return Program exit code
+     */
+    int run()
+    {
+        if (!valid_options)
+        {
+            return -1;
+        }
+
+        std::vector<Result> results;
+
+        if (!list_only)
+        {
+            std::cout << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(16) << "Time (ns)" << std::setw(14) << "Iterations" << "  Counters" << std::endl;
+        }
+
+        for (std::vector<Benchmark>::const_iterator it = benchmarks.begin(); it != benchmarks.end(); ++it)
+        {
+            if (it->name.find(filter) == std::string::npos)
+            {
+                continue;
+            }
+
+            if (list_only)
+            {
+                std::cout << it->name << std::endl;
+                continue;
+            }
+
+            results.push_back(run_benchmark(*it));
+            print_result(results.back());
+        }
+
+        if (!list_only && (json_filename.size() > 0))
+        {
+            std::ofstream json_file(json_filename.c_str());
+            print_json(json_file, results);
+        }
+
+        return 0;
+    }
+
+protected:
+    struct Benchmark
+    {
+        Benchmark(const std::string& _name, const BenchFunction& _function, unsigned long long _max_iterations) :
+            name(_name), function(_function), max_iterations(_max_iterations)
+        {}
+
+        std::string name;
+        BenchFunction function;
+        unsigned long long max_iterations;
+    };
+
+    struct Result
+    {
+        std::string name;
+        unsigned long long nb_iterations;
+        double ns_per_iteration;
+        double cpu_ns_per_iteration;
+        std::map<std::string, double> counters;
+    };
+
+    /**
+     * Run one benchmark doubling (at least) the iterations until it lasts min_time
+     */
+    Result run_benchmark(const Benchmark& benchmark)
+    {
+        unsigned long long nb_iterations = 1;
+
+        while (true)
+        {
+            BenchState state(nb_iterations);
+            benchmark.function(state);
+            double elapsed = state.get_elapsed_ns() / 1e9;
+
+            if ((elapsed >= min_time) || (nb_iterations >= benchmark.max_iterations))
+            {
+                Result result;
+                result.name = benchmark.name;
+                result.nb_iterations = state.get_nb_iterations();
+                result.ns_per_iteration = (result.nb_iterations ? ((double) state.get_elapsed_ns()) / result.nb_iterations : 0.0);
+                result.cpu_ns_per_iteration = (result.nb_iterations ? ((double) state.get_cpu_elapsed_ns()) / result.nb_iterations : 0.0);
+                result.counters = state.get_counters();
+                return result;
+            }
+
+            // aim 40% beyond the minimum time from the current rate, growing by at least 2 and at most 10 times
+            double factor = (elapsed > 0.0 ? (1.4 * min_time) / elapsed : 10.0);
+            factor = (factor < 2.0 ? 2.0 : (factor > 10.0 ? 10.0 : factor));
+            nb_iterations = (unsigned long long) (nb_iterations * factor);
+
+            if (nb_iterations > benchmark.max_iterations)
+            {
+                nb_iterations = benchmark.max_iterations;
+            }
+        }
+    }
+
+    void print_result(const Result& result)
+    {
+        std::cout << std::left << std::setw(48) << result.name << std::right
+                << std::setw(16) << std::fixed << std::setprecision(1) << result.ns_per_iteration
+                << std::setw(14) << result.nb_iterations << " ";
+        std::cout.unsetf(std::ios_base::floatfield);
+        std::cout << std::setprecision(6);
+
+        for (std::map<std::string, double>::const_iterator it = result.counters.begin(); it != result.counters.end(); ++it)
+        {
+            std::cout << " " << it->first << "=" << it->second;
+        }
+
+        std::cout << std::endl;
+    }
+
+    void print_json(std::ostream& os, const std::vector<Result>& results)
+    {
+        char date[32];
+        time_t now = time(0);
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+        os << "{" << std::endl;
+        os << "  \"context\": {" << std::endl;
+        os << "    \"date\": \"" << date << "\"," << std::endl;
+        os << "    \"executable\": \"" << program_name << "\"," << std::endl;
+        os << "    \"min_time\": " << min_time << std::endl;
+        os << "  }," << std::endl;
+        os << "  \"benchmarks\": [" << std::endl;
+
+        for (std::vector<Result>::const_iterator it = results.begin(); it != results.end(); ++it)
+        {
+            os << "    {" << std::endl;
+            os << "      \"name\": \"" << it->name << "\"," << std::endl;
+            os << "      \"run_name\": \"" << it->name << "\"," << std::endl;
+            os << "      \"run_type\": \"iteration\"," << std::endl;
+            os << "      \"repetitions\": 1," << std::endl;
+            os << "      \"repetition_index\": 0," << std::endl;
+            os << "      \"threads\": 1," << std::endl;
+            os << "      \"iterations\": " << it->nb_iterations << "," << std::endl;
+            os << "      \"real_time\": " << std::setprecision(10) << it->ns_per_iteration << "," << std::endl;
+            os << "      \"cpu_time\": " << it->cpu_ns_per_iteration << "," << std::endl;
+
+            for (std::map<std::string, double>::const_iterator cit = it->counters.begin(); cit != it->counters.end(); ++cit)
+            {
+                os << "      \"" << cit->first << "\": " << cit->second << "," << std::endl;
+            }
+
+            os << "      \"time_unit\": \"ns\"" << std::endl;
+            os << "    }" << (it+1 != results.end() ? "," : "") << std::endl;
+        }
+
+        os << "  ]" << std::endl;
+        os << "}" << std::endl;
+    }
+
+    std::string program_name;
+    std::vector<Benchmark> benchmarks;
+    std::string filter;
+    double min_time;
+    std::string json_filename;
+    bool list_only;
+    bool valid_options;
+};
+
+#endif // __BENCH_H__
@@ -0,0 +1,347 @@
+/*
+     Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+     This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+     This program is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published by
+     the Free Software Foundation; either version 2 of the License, or
+     (at your option) any later version.
+
+     This program is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+     GNU General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with this program; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+     Micro and macro benchmarks of the convolutional codes library:
+     encoding, channel noise generation and Stack/Fano decoding of AWGN
+     frames at several SNRs.
+     Inputs are generated from fixed seeds so that runs are comparable.
+
+*/
+
+#include "CC_Encoding.h"
+#include "CC_Encoding_FA.h"
+#include "CC_ReliabilityMatrix.h"
+#include "CC_StackDecoding.h"
+#include "CC_FanoDecoding.h"
+#include "CC_Channel.h"
+#include "URandom.h"
+#include "Bench.h"
+
+#include <cmath>
+#include <sstream>
+
+static URandom ur; // Global random generator object
+
+// ================================================================================================
+// K=7 rate 1/2 code (91,121) and a k=2 K=3 rate 2/3 code
+struct CodeParameters
+{
+    CodeParameters(const std::string& _name, unsigned int nb_inputs) :
+        name(_name),
+        genpolys(nb_inputs)
+    {}
+
+    std::string name;
+    std::vector<unsigned int> constraints;
+    std::vector<std::vector<unsigned int> > genpolys;
+};
+
+CodeParameters code_k1_K7()
+{
+    CodeParameters code("k1_K7", 1);
+    code.constraints.push_back(7);
+    code.genpolys[0].push_back(91);
+    code.genpolys[0].push_back(121);
+    return code;
+}
+
+CodeParameters code_k2_K3()
+{
+    CodeParameters code("k2_K3", 2);
+    code.constraints.push_back(3);
+    code.constraints.push_back(3);
+    code.genpolys[0].push_back(1);
+    code.genpolys[0].push_back(0);
+    code.genpolys[0].push_back(2);
+    code.genpolys[1].push_back(0);
+    code.genpolys[1].push_back(1);
+    code.genpolys[1].push_back(6);
+    return code;
+}
+
+// ================================================================================================
+// random input symbols from a fixed seed
+std::vector<unsigned int> random_symbols(unsigned int seed, unsigned int nb_symbols, unsigned int nb_values)
+{
+    ur.set_stream_seed(seed);
+    std::vector<unsigned int> symbols(nb_symbols);
+
+    for (unsigned int i=0; i<nb_symbols; i++)
+    {
+        symbols[i] = ur.rand_int(nb_values);
+    }
+
+    return symbols;
+}
+
+// ================================================================================================
+// AWGN frames: random messages with a zero tail encoded and turned into normalized reliability matrices
+struct Frames
+{
+    std::vector<std::vector<unsigned int> > messages;
+    std::vector<ccsoft::CC_ReliabilityMatrix> relmats;
+};
+
+void create_frames(const CodeParameters& code, unsigned int seed, unsigned int nb_frames, unsigned int nb_symbols, float snr_dB, Frames& frames)
+{
+    ccsoft::CC_Encoding<unsigned int, unsigned int> encoding(code.constraints, code.genpolys);
+    unsigned int nb_out_symbols = 1<<encoding.get_n();
+    double std_dev = 1.0 / pow(10.0, (snr_dB/10.0)); // Standard deviation for power AWGN
+    std::vector<float> symbol_data(nb_out_symbols);
+
+    ur.set_stream_seed(seed);
+
+    for (unsigned int fi=0; fi<nb_frames; fi++)
+    {
+        std::vector<unsigned int> message;
+
+        for (unsigned int i=0; i<nb_symbols; i++)
+        {
+            message.push_back(ur.rand_int(1<<encoding.get_k()));
+        }
+
+        for (unsigned int i=0; i<encoding.get_m()-1; i++)
+        {
+            message.push_back(0);
+        }
+
+        ccsoft::CC_ReliabilityMatrix relmat(encoding.get_n(), message.size());
+        encoding.clear();
+
+        for (unsigned int i=0; i<message.size(); i++)
+        {
+            unsigned int out_symbol;
+            encoding.encode(message[i], out_symbol);
+
+            for (unsigned int si=0; si<nb_out_symbols; si++)
+            {
+                symbol_data[si] = (si == out_symbol ? 1.0 : 0.0) + std_dev * ur.rand_gaussian();
+                symbol_data[si] *= symbol_data[si];
+            }
+
+            relmat.enter_symbol_data(&symbol_data[0]);
+        }
+
+        relmat.normalize();
+        frames.messages.push_back(message);
+        frames.relmats.push_back(relmat);
+    }
+}
+
+// ================================================================================================
+// micro: one symbol through CC_Encoding_base::encode
+void bench_encode(BenchState& state, const CodeParameters& code)
+{
+    ccsoft::CC_Encoding<unsigned int, unsigned int> encoding(code.constraints, code.genpolys);
+    std::vector<unsigned int> in_symbols = random_symbols(1, 4096, 1<<encoding.get_k());
+    unsigned int out_symbol = 0;
+    unsigned int i = 0;
+
+    while (state.keep_running())
+    {
+        encoding.encode(in_symbols[i], out_symbol);
+        bench_do_not_optimize(out_symbol);
+        i = (i+1) & 4095;
+    }
+}
+
+// ================================================================================================
+// micro: one symbol through the fixed array encoding
+template<unsigned int N_k>
+void bench_encode_FA(BenchState& state, const CodeParameters& code)
+{
+    ccsoft::CC_Encoding_FA<unsigned int, unsigned int, N_k> encoding(code.constraints, code.genpolys);
+    std::vector<unsigned int> in_symbols = random_symbols(1, 4096, 1<<encoding.get_k());
+    unsigned int out_symbol = 0;
+    unsigned int i = 0;
+
+    while (state.keep_running())
+    {
+        encoding.encode(in_symbols[i], out_symbol);
+        bench_do_not_optimize(out_symbol);
+        i = (i+1) & 4095;
+    }
+}
+
+// ================================================================================================
+// micro: a whole bit packed message through encode_bulk
+void bench_encode_bulk(BenchState& state, const CodeParameters& code, unsigned int nb_symbols)
+{
+    ccsoft::CC_Encoding<unsigned int, unsigned int> encoding(code.constraints, code.genpolys);
+    std::vector<unsigned int> in_bytes = random_symbols(1, (nb_symbols*encoding.get_k()+7)/8, 256);
+    std::vector<unsigned char> in_packed(in_bytes.begin(), in_bytes.end());
+    std::vector<unsigned char> out_packed;
+
+    while (state.keep_running())
+    {
+        encoding.clear();
+        encoding.encode_bulk(&in_packed[0], nb_symbols, out_packed, true);
+        bench_do_not_optimize(out_packed[0]);
+    }
+
+    state.set_counter("symbols", nb_symbols);
+}
+
+// ================================================================================================
+// micro: AWGN reliability matrix of a whole frame with a URandom gaussian sample per matrix element
+void bench_noise_urandom(BenchState& state, unsigned int n, unsigned int nb_columns)
+{
+    unsigned int nb_out_symbols = 1<<n;
+    std::vector<unsigned int> out_symbols = random_symbols(1, nb_columns, nb_out_symbols);
+    std::vector<float> symbol_data(nb_out_symbols);
+    ccsoft::CC_ReliabilityMatrix relmat(n, nb_columns);
+    double std_dev = 1.0 / pow(10.0, (8.0/10.0));
+
+    while (state.keep_running())
+    {
+        relmat.reset_message_symbol_count();
+
+        for (unsigned int c=0; c<nb_columns; c++)
+        {
+            for (unsigned int si=0; si<nb_out_symbols; si++)
+            {
+                symbol_data[si] = (si == out_symbols[c] ? 1.0 : 0.0) + std_dev * ur.rand_gaussian();
+                symbol_data[si] *= symbol_data[si];
+            }
+
+            relmat.enter_symbol_data(&symbol_data[0]);
+        }
+
+        bench_do_not_optimize(relmat(0,0));
+    }
+
+    state.set_counter("samples", nb_columns*nb_out_symbols);
+}
+
+// ================================================================================================
+// micro: same reliability matrix generated in one block by the bulk channel generator
+void bench_noise_channel(BenchState& state, unsigned int n, unsigned int nb_columns, ccsoft::CC_ChannelModel model)
+{
+    std::vector<unsigned int> out_symbols = random_symbols(1, nb_columns, 1<<n);
+    ccsoft::CC_ReliabilityMatrix relmat(n, nb_columns);
+    ccsoft::CC_Channel channel(model, 1);
+    channel.set_snr(8.0);
+
+    while (state.keep_running())
+    {
+        relmat.reset_message_symbol_count();
+        channel.fill(relmat, out_symbols);
+        bench_do_not_optimize(relmat(0,0));
+    }
+
+    state.set_counter("samples", nb_columns*(1<<n));
+}
+
+// ================================================================================================
+// macro: decode frames in turn and report the success rate and the mean number of nodes
+void bench_decode(BenchState& state, ccsoft::CC_SequentialDecoding<unsigned int, unsigned int>& decoding, const Frames& frames)
+{
+    std::vector<unsigned int> decoded_message;
+    unsigned int nb_decodes = 0;
+    unsigned int nb_ok = 0;
+    unsigned long long nb_nodes = 0;
+    unsigned int fi = 0;
+
+    while (state.keep_running())
+    {
+        bool success = decoding.decode(frames.relmats[fi], decoded_message);
+
+        state.pause_timing();
+        nb_decodes++;
+        nb_nodes += decoding.get_decode_stats().nb_nodes;
+
+        if (success && (decoded_message == frames.messages[fi]))
+        {
+            nb_ok++;
+        }
+
+        fi = (fi+1) % frames.relmats.size();
+        state.resume_timing();
+    }
+
+    state.set_counter("success_rate", nb_decodes ? ((double) nb_ok) / nb_decodes : 0.0);
+    state.set_counter("nodes", nb_decodes ? ((double) nb_nodes) / nb_decodes : 0.0);
+}
+
+// node and metric limits bound the effort spent on frames that cannot be decoded
+static const unsigned int decode_node_limit = 1<<17;
+static const float decode_metric_limit = -300.0;
+
+void bench_decode_stack(BenchState& state, const CodeParameters& code, const Frames& frames)
+{
+    ccsoft::CC_StackDecoding<unsigned int, unsigned int> decoding(code.constraints, code.genpolys);
+    decoding.set_node_limit(decode_node_limit);
+    decoding.set_metric_limit(decode_metric_limit);
+    bench_decode(state, decoding, frames);
+}
+
+void bench_decode_fano(BenchState& state, const CodeParameters& code, const Frames& frames)
+{
+    // initial threshold -1, delta 1, no tree cache, restart with a lower initial threshold on loops
+    ccsoft::CC_FanoDecoding<unsigned int, unsigned int> decoding(code.constraints, code.genpolys, -1.0, 1.0, 0, -1.0);
+    decoding.set_node_limit(decode_node_limit);
+    decoding.set_metric_limit(decode_metric_limit);
+    bench_decode(state, decoding, frames);
+}
+
+// ================================================================================================
+int main(int argc, char *argv[])
+{
+    BenchRunner runner("CCBench", argc, argv);
+    static const unsigned int nb_frames = 16;
+    static const unsigned int nb_frame_symbols = 100;
+    static const float snrs_dB[] = {6.0, 7.0, 8.0, 10.0};
+    std::vector<CodeParameters> codes;
+    codes.push_back(code_k1_K7());
+    codes.push_back(code_k2_K3());
+
+    for (std::vector<CodeParameters>::const_iterator it = codes.begin(); it != codes.end(); ++it)
+    {
+        const CodeParameters& code = *it;
+        runner.add("encode/" + code.name, [code](BenchState& state) { bench_encode(state, code); });
+        runner.add("encode_bulk/" + code.name + "/1024", [code](BenchState& state) { bench_encode_bulk(state, code, 1024); });
+    }
+
+    runner.add("encode_FA/k1_K7", [codes](BenchState& state) { bench_encode_FA<1>(state, codes[0]); });
+    runner.add("encode_FA/k2_K3", [codes](BenchState& state) { bench_encode_FA<2>(state, codes[1]); });
+
+    runner.add("noise/urandom/n:2/1024", [](BenchState& state) { bench_noise_urandom(state, 2, 1024); });
+    runner.add("noise/awgn/n:2/1024", [](BenchState& state) { bench_noise_channel(state, 2, 1024, ccsoft::CC_Channel_AWGN); });
+    runner.add("noise/rayleigh/n:2/1024", [](BenchState& state) { bench_noise_channel(state, 2, 1024, ccsoft::CC_Channel_Rayleigh); });
+
+    // frames are shared by the stack and Fano decoders and generated once for each code and SNR
+    std::vector<Frames> all_frames(codes.size() * (sizeof(snrs_dB)/sizeof(float)));
+    std::vector<Frames>::iterator frames_it = all_frames.begin();
+
+    for (std::vector<CodeParameters>::const_iterator it = codes.begin(); it != codes.end(); ++it)
+    {
+        for (unsigned int si=0; si<sizeof(snrs_dB)/sizeof(float); si++, ++frames_it)
+        {
+            const CodeParameters& code = *it;
+            const Frames& frames = *frames_it;
+            create_frames(code, 100+si, nb_frames, nb_frame_symbols, snrs_dB[si], *frames_it);
+            std::ostringstream suffix;
+            suffix << code.name << "/snr:" << snrs_dB[si];
+            runner.add("decode_stack/" + suffix.str(), [code, &frames](BenchState& state) { bench_decode_stack(state, code, frames); }, 1<<16);
+            runner.add("decode_fano/" + suffix.str(), [code, &frames](BenchState& state) { bench_decode_fano(state, code, frames); }, 1<<16);
+        }
+    }
+
+    return runner.run();
+}
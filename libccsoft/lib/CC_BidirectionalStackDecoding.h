@@ -0,0 +1,530 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Convolutional soft-decision decoder based on the bidirectional stack
+ algorithm. A forward stack search from the start of the message and a
+ backward stack search in the reverse trellis from the known zero tail
+ state run alternately until they merge on a common state.
+ Uses the node+edge combination in the code tree. Needs C++11.
+
+ */
+#ifndef __CC_BIDIRECTIONAL_STACK_DECODING_H__
+#define __CC_BIDIRECTIONAL_STACK_DECODING_H__
+
+#include "CC_SequentialDecoding.h"
+#include "CC_SequentialDecodingInternal.h"
+#include "CC_Encoding.h"
+#include "CCSoft_Exception.h"
+#include "CC_TreeNodeEdge.h"
+#include "CC_ReliabilityMatrix.h"
+#include "CC_NodeEdgeOrdering.h"
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <iostream>
+#include <new>
+
+
+namespace ccsoft
+{
+
+/**
+ * \brief The bidirectional Stack Decoding class with node+edge combination. The forward search is the plain stack
+ * algorithm from the root node. The backward search starts from the all zeros state one symbol past the end of the
+ * message and expands nodes into their preceding states: a backward node at depth d holds the encoder state at depth d
+ * and the path metric of depths d to the end of the message. Both searches alternate one expansion at a time. Every node
+ * is indexed by depth and state and the decode stops as soon as the node at the top of one stack has a counterpart in the
+ * other tree: the forward path to this node and the backward path from it are joined into the decoded message.
+ * Since a noise burst only stalls the search running into it, the worst case number of nodes is much lower than with
+ * the forward search alone. The backward search needs the zero tail: without it (see set_tail_zeros) only the forward
+ * search runs.
+ * \tparam T_Register Type of the encoder internal registers
+ * \tparam T_IOSymbol Type of the input and output symbols
+ */
+template<typename T_Register, typename T_IOSymbol>
+class CC_BidirectionalStackDecoding : public CC_SequentialDecoding<T_Register, T_IOSymbol>, public CC_SequentialDecodingInternal<T_Register, T_IOSymbol, CC_TreeNodeEdgeTag_Empty>
+{
+public:
+    /**
+     * Constructor
+     * \param _constraints Vector of register lengths (constraint length + 1). The number of elements determines k.
+     * \param genpoly_representations Generator polynomial numeric representations. There are as many elements as there
+     * are input bits (k). Each element is itself a vector with one polynomial value per output bit. The smallest size of
+     * these vectors is retained as the number of output bits n. The input bits of a symbol are clocked simultaneously into
+     * the right hand side, or least significant position of the internal registers. Therefore the given polynomial representation
+     * of generators should follow the same convention.
+     */
+    CC_BidirectionalStackDecoding(const std::vector<unsigned int>& _constraints,
+            const std::vector<std::vector<T_Register> >& genpoly_representations) :
+                CC_SequentialDecoding<T_Register, T_IOSymbol>(_constraints, genpoly_representations),
+                CC_SequentialDecodingInternal<T_Register, T_IOSymbol, CC_TreeNodeEdgeTag_Empty>(_constraints.size()),
+                constraints(_constraints),
+                backward_root_node(0),
+                forward_node_count(0),
+                backward_node_count(0),
+                meeting_depth(-1)
+    {}
+
+    /**
+     * Destructor
+     */
+    virtual ~CC_BidirectionalStackDecoding()
+    {}
+
+    /**
+     * Reset the decoding process
+     */
+    void reset()
+    {
+        ParentInternal::reset();
+        Parent::reset();
+        forward_stack.clear();
+        backward_stack.clear();
+        backward_root_node = 0;
+        forward_node_count = 0;
+        backward_node_count = 0;
+        meeting_depth = -1;
+
+        for (unsigned int i=0; i<forward_index.size(); i++)
+        {
+            forward_index[i].clear();
+            backward_index[i].clear();
+        }
+    }
+
+    /**
+     * Get the score at the top of the forward stack. Valid anytime the process has started (stack not empty).
+     */
+    float get_stack_score() const
+    {
+        if (forward_stack.empty())
+        {
+            return 0.0;
+        }
+
+        return forward_stack.top().ordering.path_metric;
+    }
+
+    /**
+     * Get the total size of the forward and backward stacks
+     */
+    unsigned int get_stack_size() const
+    {
+        return forward_stack.size() + backward_stack.size();
+    }
+
+    /**
+     * Get the number of nodes created by the forward search
+     */
+    unsigned int get_nb_forward_nodes() const
+    {
+        return forward_node_count;
+    }
+
+    /**
+     * Get the number of nodes created by the backward search
+     */
+    unsigned int get_nb_backward_nodes() const
+    {
+        return backward_node_count;
+    }
+
+    /**
+     * Get the depth where the forward and backward searches met. -1 if they did not meet.
+     */
+    int get_meeting_depth() const
+    {
+        return meeting_depth;
+    }
+
+    /**
+     * Decodes given the reliability matrix
+     * \param relmat Reference to the reliability matrix
+     * \param decoded_message Vector of symbols of retrieved message
+     */
+    virtual bool decode(const CC_ReliabilityMatrix& relmat, std::vector<T_IOSymbol>& decoded_message)
+    {
+        if (relmat.get_message_length() < Parent::encoding.get_m())
+        {
+            throw CCSoft_Exception("Reliability Matrix should have a number of columns at least equal to the code constraint");
+        }
+
+        if (relmat.get_nb_symbols_log2() != Parent::encoding.get_n())
+        {
+            throw CCSoft_Exception("Reliability Matrix is not compatible with code output symbol size");
+        }
+
+        int message_length = relmat.get_message_length();
+
+        if (forward_index.size() < (unsigned int) message_length) // one index per depth
+        {
+            forward_index.resize(message_length);
+            backward_index.resize(message_length);
+        }
+
+        reset();
+        CC_DecodingBudgetScope budget_scope(Parent::budget);
+        ParentInternal::init_edge_metrics(relmat, Parent::edge_bias);
+        ParentInternal::init_root(); // initialize the root node
+        Parent::node_count++;
+        visit_node_forward(ParentInternal::root_node, relmat); // visit the root node
+
+        if (Parent::tail_zeros) // the state one symbol past the end is all zeros
+        {
+            backward_root_node = new_backward_node_edge(0, 0, 0, 0.0, message_length, 0);
+            Parent::node_count++;
+            visit_node_backward(backward_root_node, relmat);
+        }
+
+        bool forward_turn = true;
+
+        while (!forward_stack.empty()) // the forward search carries on alone if the backward search runs out of paths
+        {
+            if (forward_turn || backward_stack.empty())
+            {
+                BidirNodeEdge *node_edge = forward_stack.top_node_edge();
+
+                if (node_edge->get_depth() == message_length - 1) // the forward search alone got to the end
+                {
+                    ParentInternal::back_track(node_edge, decoded_message, true);
+                    Parent::codeword_score = node_edge->get_path_metric();
+                    return true;
+                }
+
+                BidirNodeEdge *backward_node_edge = find_node_edge(backward_index, node_edge);
+
+                if (backward_node_edge)
+                {
+                    join_paths(node_edge, backward_node_edge, decoded_message);
+                    return true;
+                }
+
+                forward_stack.pop();
+                visit_node_forward(node_edge, relmat);
+            }
+            else
+            {
+                BidirNodeEdge *node_edge = backward_stack.top_node_edge();
+                BidirNodeEdge *forward_node_edge = find_node_edge(forward_index, node_edge);
+
+                if (forward_node_edge)
+                {
+                    join_paths(forward_node_edge, node_edge, decoded_message);
+                    return true;
+                }
+
+                backward_stack.pop();
+                visit_node_backward(node_edge, relmat);
+            }
+
+            if (Parent::tail_zeros)
+            {
+                forward_turn = !forward_turn;
+            }
+
+            Parent::status = Parent::budget.move();
+
+            if ((Parent::use_node_limit) && (Parent::node_count > Parent::node_limit))
+            {
+                Parent::status = CC_Decoding_NodeLimit;
+            }
+
+            if (Parent::status != CC_Decoding_Success) // give up with the best partial forward path
+            {
+                ParentInternal::back_track_partial((forward_stack.size() > 0 ? forward_stack.top_node_edge() : 0), decoded_message);
+                return false;
+            }
+        }
+
+        Parent::status = CC_Decoding_MetricLimit; // no path left above the metric limit
+        ParentInternal::back_track_partial((forward_stack.size() > 0 ? forward_stack.top_node_edge() : 0), decoded_message);
+        return false;
+    }
+
+    /**
+     * Get the effort statistics of the last decode
+     */
+    virtual CC_DecodeStats get_decode_stats() const
+    {
+        CC_DecodeStats stats = Parent::get_decode_stats();
+        stats.stack_size = get_stack_size();
+        return stats;
+    }
+
+    /**
+     * Print stats to an output stream
+     * \param os Output stream
+     * \param success True if decoding was successful
+     */
+    virtual void print_stats(std::ostream& os, bool success)
+    {
+        os << "score = " << Parent::get_score()
+                << " stack_score = " << get_stack_score()
+                << " #nodes = " << Parent::get_nb_nodes()
+                << " (" << forward_node_count << " fwd, " << backward_node_count << " bwd)"
+                << " stack_size = " << get_stack_size()
+                << " max depth = " << Parent::get_max_depth()
+                << " meeting depth = " << meeting_depth;
+    }
+
+    /**
+     * Print stats summary to an output stream
+     * \param os Output stream
+     * \param success True if decoding was successful
+     */
+    virtual void print_stats_summary(std::ostream& os, bool success)
+    {
+        os << "_RES " << (success ? 1 : 0) << ","
+                << Parent::get_score() << ","
+                << get_stack_score() << ","
+                << Parent::get_nb_nodes() << ","
+                << get_stack_size() << ","
+                << Parent::get_max_depth() << ","
+                << meeting_depth;
+    }
+
+    /**
+     * Print the dot (Graphviz) file of the current forward decode tree to an output stream
+     * \param os Output stream
+     */
+    virtual void print_dot(std::ostream& os)
+    {
+        ParentInternal::print_dot_internal(os);
+    }
+
+protected:
+    typedef CC_SequentialDecoding<T_Register, T_IOSymbol> Parent;                                       //!< Parent class this class inherits from
+    typedef CC_SequentialDecodingInternal<T_Register, T_IOSymbol, CC_TreeNodeEdgeTag_Empty> ParentInternal; //!< Parent class this class inherits from
+    typedef CC_TreeNodeEdge<T_IOSymbol, T_Register, CC_TreeNodeEdgeTag_Empty> BidirNodeEdge;             //!< Class of code tree nodes in the bidirectional stack algorithm
+    typedef std::vector<std::unordered_map<unsigned long long, unsigned int> > NodeEdgeIndex;          //!< Pool index of node+edges by depth then by state
+
+    /**
+     * Visit a new node in the forward direction
+     * \node Node+edge combo to visit
+     * \relmat Reliability matrix being used
+     */
+    virtual void visit_node_forward(BidirNodeEdge* node_edge, const CC_ReliabilityMatrix& relmat)
+    {
+        int forward_depth = node_edge->get_depth() + 1;
+        T_IOSymbol out_symbol;
+        T_IOSymbol end_symbol;
+
+        unsigned long long state = node_edge->get_state(); // encoder state at this node
+
+        if ((Parent::tail_zeros) && (forward_depth > (int) (relmat.get_message_length()-Parent::encoding.get_m())))
+        {
+            end_symbol = 1; // if zero tail option assume tail symbols are all zeros
+        }
+        else
+        {
+            end_symbol = (1<<Parent::encoding.get_k()); // full scan all possible input symbols
+        }
+
+        // loop through assumption for this symbol place
+        for (T_IOSymbol in_symbol = 0; in_symbol < end_symbol; in_symbol++)
+        {
+            unsigned long long forward_state = Parent::encoding.get_next_packed_state(state, in_symbol);
+            out_symbol = Parent::encoding.get_output_symbol(forward_state);
+            float forward_path_metric = ParentInternal::edge_metrics(out_symbol, forward_depth) + node_edge->get_path_metric();
+
+            if ((!Parent::use_metric_limit) || (forward_path_metric > Parent::metric_limit))
+            {
+                BidirNodeEdge *next_node_edge = ParentInternal::new_node_edge(node_edge, in_symbol, forward_path_metric, forward_depth, forward_state); // add forward edge+node combo
+                forward_stack.push(forward_path_metric, Parent::node_count, next_node_edge);
+                index_node_edge(forward_index, next_node_edge);
+                Parent::node_count++;
+                forward_node_count++;
+            }
+        }
+
+        Parent::cur_depth = forward_depth; // new encoder position
+
+        if (Parent::cur_depth > Parent::max_depth)
+        {
+            Parent::max_depth = Parent::cur_depth;
+        }
+    }
+
+    /**
+     * Visit a new node in the backward direction i.e. create the node+edges of its preceding states
+     * \node Node+edge combo to visit
+     * \relmat Reliability matrix being used
+     */
+    void visit_node_backward(BidirNodeEdge* node_edge, const CC_ReliabilityMatrix& relmat)
+    {
+        int backward_depth = node_edge->get_depth() - 1;
+        unsigned long long state = node_edge->get_state();
+
+        if (backward_depth < 0) // preceding state is the root
+        {
+            return;
+        }
+
+        // loop through the bits shifted out of the registers
+        for (T_IOSymbol high_bits = 0; high_bits < (T_IOSymbol) (1<<Parent::encoding.get_k()); high_bits++)
+        {
+            if (!is_valid_high_bits(high_bits, backward_depth))
+            {
+                continue;
+            }
+
+            unsigned long long backward_state = Parent::encoding.get_previous_packed_state(state, high_bits);
+            T_IOSymbol out_symbol = Parent::encoding.get_output_symbol(backward_state);
+            float backward_path_metric = ParentInternal::edge_metrics(out_symbol, backward_depth) + node_edge->get_path_metric();
+
+            if ((!Parent::use_metric_limit) || (backward_path_metric > Parent::metric_limit))
+            {
+                BidirNodeEdge *next_node_edge = new_backward_node_edge(node_edge,
+                        high_bits,
+                        Parent::encoding.get_input_symbol(backward_state),
+                        backward_path_metric,
+                        backward_depth,
+                        backward_state);
+                backward_stack.push(backward_path_metric, Parent::node_count, next_node_edge);
+                index_node_edge(backward_index, next_node_edge);
+                Parent::node_count++;
+                backward_node_count++;
+            }
+        }
+    }
+
+    /**
+     * Tells if the most significant register bits of a backward state can be set at a given depth. The registers hold
+     * zeros before the first symbol so a register bit can only be set if it has been clocked in at depth 0 or later.
+     * \param high_bits Bit ki is the most significant bit of register ki
+     * \param depth Depth of the backward state
+     */
+    bool is_valid_high_bits(T_IOSymbol high_bits, int depth) const
+    {
+        for (unsigned int ki=0; ki<constraints.size(); ki++)
+        {
+            if (((high_bits >> ki) & 1) && (depth < (int) constraints[ki] - 1))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Allocate a new backward node+edge from the pool and link it to the node+edge it precedes. The node+edge holds the
+     * input symbol clocked in at its own depth so that the message reads along the backward path.
+     * \param p_incoming_node_edge Node+edge of the following state or 0 for the backward root
+     * \param slot Outgoing slot in the following node+edge i.e. the bits shifted out of the registers
+     * \param in_symbol Input symbol clocked in to reach this state
+     * \param path_metric Path metric from this node to the end of the message
+     * \param depth Node depth
+     * \param state Packed encoder registers at the node
+     */
+    BidirNodeEdge *new_backward_node_edge(BidirNodeEdge *p_incoming_node_edge,
+            unsigned int slot,
+            const T_IOSymbol& in_symbol,
+            float path_metric,
+            int depth,
+            unsigned long long state)
+    {
+        unsigned int index;
+        void *record = ParentInternal::node_edge_pool.allocate(index);
+        unsigned int incoming_index = (p_incoming_node_edge ? p_incoming_node_edge->get_id() : BidirNodeEdge::null_index);
+        BidirNodeEdge *node_edge = new (record) BidirNodeEdge(index, incoming_index, in_symbol, path_metric, depth, state, 1<<ParentInternal::k);
+
+        if (p_incoming_node_edge)
+        {
+            p_incoming_node_edge->set_outgoing_index(slot, index);
+        }
+
+        return node_edge;
+    }
+
+    /**
+     * Record a node+edge in a depth and state index. Keeps the best path metric node+edge for a given depth and state.
+     */
+    void index_node_edge(NodeEdgeIndex& node_edge_index, BidirNodeEdge *node_edge)
+    {
+        std::unordered_map<unsigned long long, unsigned int>& depth_index = node_edge_index[node_edge->get_depth()];
+        std::pair<std::unordered_map<unsigned long long, unsigned int>::iterator, bool> ret = depth_index.insert(std::make_pair(node_edge->get_state(), node_edge->get_id()));
+
+        if (!ret.second && (ParentInternal::node_edge_pool.get(ret.first->second)->get_path_metric() < node_edge->get_path_metric()))
+        {
+            ret.first->second = node_edge->get_id();
+        }
+    }
+
+    /**
+     * Find the node+edge at the same depth and state as a given node+edge in a depth and state index
+     * \return Pointer to the node+edge found or 0 if none
+     */
+    BidirNodeEdge *find_node_edge(const NodeEdgeIndex& node_edge_index, const BidirNodeEdge *node_edge) const
+    {
+        const std::unordered_map<unsigned long long, unsigned int>& depth_index = node_edge_index[node_edge->get_depth()];
+        std::unordered_map<unsigned long long, unsigned int>::const_iterator it = depth_index.find(node_edge->get_state());
+
+        if (it == depth_index.end())
+        {
+            return 0;
+        }
+
+        return ParentInternal::node_edge_pool.get(it->second);
+    }
+
+    /**
+     * Join the forward path to a node+edge and the backward path from the node+edge of the same depth and state to make the decoded message
+     * \param forward_node_edge Forward node+edge
+     * \param backward_node_edge Backward node+edge
+     * \param decoded_message Decoded message
+     */
+    void join_paths(BidirNodeEdge *forward_node_edge, BidirNodeEdge *backward_node_edge, std::vector<T_IOSymbol>& decoded_message)
+    {
+        int depth = forward_node_edge->get_depth();
+        meeting_depth = depth;
+        ParentInternal::back_track(forward_node_edge, decoded_message, true); // symbols from the first to the meeting depth
+        Parent::codeword_score = forward_node_edge->get_path_metric() + backward_node_edge->get_path_metric()
+                - ParentInternal::edge_metrics(Parent::encoding.get_output_symbol(forward_node_edge->get_state()), depth); // metric of the meeting depth is in both
+
+        BidirNodeEdge *node_edge = ParentInternal::get_incoming_node_edge(backward_node_edge); // the meeting symbol is already in
+
+        while (node_edge && (node_edge != backward_root_node))
+        {
+            node_edge->set_on_final_path(true);
+            decoded_message.push_back(node_edge->get_in_symbol());
+            node_edge = ParentInternal::get_incoming_node_edge(node_edge);
+        }
+
+        if (depth+1 > Parent::max_depth)
+        {
+            Parent::max_depth = depth+1;
+        }
+    }
+
+    std::vector<unsigned int> constraints;         //!< Register lengths
+    BidirNodeEdge *backward_root_node;             //!< Root of the backward search one symbol past the end of the message
+    CC_NodeEdgeHeap<BidirNodeEdge> forward_stack;  //!< Stack of the forward search as a heap ordered by decreasing path metric
+    CC_NodeEdgeHeap<BidirNodeEdge> backward_stack; //!< Stack of the backward search as a heap ordered by decreasing path metric
+    NodeEdgeIndex forward_index;                   //!< Forward node+edges by depth and state
+    NodeEdgeIndex backward_index;                  //!< Backward node+edges by depth and state
+    unsigned int forward_node_count;               //!< Number of nodes created by the forward search
+    unsigned int backward_node_count;              //!< Number of nodes created by the backward search
+    int meeting_depth;                             //!< Depth where the searches met or -1
+};
+
+} // namespace ccsoft
+
+#endif // __CC_BIDIRECTIONAL_STACK_DECODING_H__
@@ -0,0 +1,194 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Channel simulation. Fast pseudo random generator, block gaussian noise
+ generation and symbol power models filling a whole reliability matrix.
+
+ */
+
+#ifndef __CC_CHANNEL_H__
+#define __CC_CHANNEL_H__
+
+#include "CC_ReliabilityMatrix.h"
+#include <vector>
+
+namespace ccsoft
+{
+
+/**
+ * \brief xoshiro256** pseudo random generator by D. Blackman and S. Vigna. The 256 bit state is initialized from a
+ * 64 bit seed with SplitMix64. Much faster than rand() and each instance has its own state.
+ */
+class CC_Xoshiro256
+{
+public:
+    /**
+     * Constructor
+     * \param seed Seed of the generator
+     */
+    CC_Xoshiro256(unsigned long long seed = 0);
+
+    /**
+     * Destructor
+     */
+    ~CC_Xoshiro256();
+
+    /**
+     * Restart the generator from a seed
+     */
+    void set_seed(unsigned long long seed);
+
+    /**
+     * Next 64 bit random value
+     */
+    unsigned long long next()
+    {
+        unsigned long long result = rotl(s[1] * 5, 7) * 9;
+        unsigned long long t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    /**
+     * Random integer from 0 to n-1 (multiply and shift of the 32 high bits)
+     */
+    unsigned int rand_int(unsigned int n)
+    {
+        return (unsigned int) (((next() >> 32) * n) >> 32);
+    }
+
+    /**
+     * Uniform random value in [0,1)
+     */
+    double rand_uniform()
+    {
+        return (next() >> 11) * (1.0 / 9007199254740992.0); // 53 bits mantissa
+    }
+
+    /**
+     * Fill an array with standard normal samples. Uniforms are drawn first for the whole block then transformed with
+     * the Box-Muller method two samples at a time (cosine and sine branches) in a loop without dependencies between
+     * iterations that the compiler can vectorize.
+     * \param samples Array of nb_samples samples
+     * \param nb_samples Number of samples
+     */
+    void fill_gaussian(float *samples, unsigned int nb_samples);
+
+protected:
+    static unsigned long long rotl(unsigned long long x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    unsigned long long s[4];       //!< Generator state
+    std::vector<float> radii;      //!< Uniforms in (0,1) of the Box-Muller radius of a block
+    std::vector<float> angles;     //!< Uniforms in [0,1) of the Box-Muller angle of a block
+};
+
+/**
+ * \brief Channel models
+ */
+typedef enum
+{
+    CC_Channel_AWGN,    //!< Additive white gaussian noise
+    CC_Channel_Rayleigh //!< Rayleigh fading of unit mean power per symbol position followed by AWGN
+} CC_ChannelModel;
+
+/**
+ * \brief Symbol power channel model. For each symbol position the power of each possible output symbol is (s + n)^2
+ * where n is a gaussian noise sample of standard deviation 10^(-SNR/10) and s is 0 except for the sent symbol where it
+ * is 1 (AWGN) or a Rayleigh distributed amplitude (Rayleigh). This is the model of the FullTest programs with the noise
+ * of a whole message generated in one block.
+ */
+class CC_Channel
+{
+public:
+    /**
+     * Constructor
+     * \param _model Channel model
+     * \param seed Seed of the random generator
+     */
+    CC_Channel(CC_ChannelModel _model = CC_Channel_AWGN, unsigned long long seed = 0);
+
+    /**
+     * Destructor
+     */
+    ~CC_Channel();
+
+    /**
+     * Set the SNR in dB
+     */
+    void set_snr(float snr_dB);
+
+    /**
+     * Get the random generator e.g. to draw random messages from the same stream
+     */
+    CC_Xoshiro256& get_random()
+    {
+        return random;
+    }
+
+    /**
+     * Enter the received symbol powers of a sent sequence of output symbols in the reliability matrix. The symbols
+     * are entered after the columns entered so far. The matrix is not normalized.
+     * \param relmat Reliability matrix
+     * \param out_symbols Sent output symbols in channel order
+     */
+    template<typename T_IOSymbol>
+    void fill(CC_ReliabilityMatrix& relmat, const std::vector<T_IOSymbol>& out_symbols)
+    {
+        unsigned int nb_rows = relmat.get_nb_symbols();
+        generate_noise(nb_rows, out_symbols.size());
+
+        for (unsigned int c=0; c<out_symbols.size(); c++)
+        {
+            float *column = &noise[c*nb_rows];
+            column[out_symbols[c]] += amplitudes[c];
+
+            for (unsigned int r=0; r<nb_rows; r++)
+            {
+                column[r] *= column[r];
+            }
+
+            relmat.enter_symbol_data(column);
+        }
+    }
+
+protected:
+    /**
+     * Generate the scaled noise samples of nb_columns columns of nb_rows rows and the sent symbol amplitude of each column
+     */
+    void generate_noise(unsigned int nb_rows, unsigned int nb_columns);
+
+    CC_ChannelModel model;         //!< Channel model
+    CC_Xoshiro256 random;          //!< Random generator
+    float std_dev;                 //!< Noise standard deviation
+    std::vector<float> noise;      //!< Noise samples column first
+    std::vector<float> amplitudes; //!< Amplitude of the sent symbol of each column
+    std::vector<float> fading;     //!< In-phase and quadrature fading components of unit mean power of each column
+};
+
+} // namespace ccsoft
+
+#endif // __CC_CHANNEL_H__
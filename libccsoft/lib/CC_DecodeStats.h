@@ -0,0 +1,93 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Effort statistics of a decode
+
+ */
+#ifndef __CC_DECODE_STATS_H__
+#define __CC_DECODE_STATS_H__
+
+#include "CC_DecodingBudget.h"
+
+#include <iostream>
+
+namespace ccsoft
+{
+
+/**
+ * \brief Effort statistics of the last decode of a decoder. Counters a decoding algorithm does not have are zero
+ * except the effective node count that is the node count when nodes are never deleted.
+ */
+struct CC_DecodeStats
+{
+    CC_DecodeStats()
+    {
+        clear();
+    }
+
+    /**
+     * Zero all statistics
+     */
+    void clear()
+    {
+        status = CC_Decoding_Success;
+        score = 0.0;
+        nb_nodes = 0;
+        nb_effective_nodes = 0;
+        nb_moves = 0;
+        max_depth = 0;
+        stack_size = 0;
+        nb_threshold_changes = 0;
+        nb_cache_evictions = 0;
+        elapsed_ns = 0;
+    }
+
+    /**
+     * Print the statistics on one line as comma separated values in the order of the members
+     * \param os Output stream
+     */
+    void print(std::ostream& os) const
+    {
+        os << (int) status << ","
+                << score << ","
+                << nb_nodes << ","
+                << nb_effective_nodes << ","
+                << nb_moves << ","
+                << max_depth << ","
+                << stack_size << ","
+                << nb_threshold_changes << ","
+                << nb_cache_evictions << ","
+                << elapsed_ns;
+    }
+
+    CC_DecodingStatus status;           //!< Status of the decode
+    float score;                        //!< Codeword score or best partial path metric
+    unsigned int nb_nodes;              //!< Nodes created including the root node
+    unsigned int nb_effective_nodes;    //!< Nodes created not counting those re-created after being dropped from a cache
+    unsigned int nb_moves;              //!< Iterations of the decoding algorithm main loop
+    unsigned int max_depth;             //!< Maximum depth reached in the code tree
+    unsigned int stack_size;            //!< Stack size at the end of the decode (stack algorithms)
+    unsigned int nb_threshold_changes;  //!< Number of threshold tightenings and loosenings (Fano algorithm)
+    unsigned int nb_cache_evictions;    //!< Number of nodes evicted from the code tree cache (Fano algorithm)
+    unsigned long long elapsed_ns;      //!< Wall clock duration of the decode in nanoseconds
+};
+
+} // namespace ccsoft
+
+#endif // __CC_DECODE_STATS_H__
@@ -0,0 +1,220 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Aggregation of the effort statistics of many decodes shared by threads.
+ Needs C++11 (-std=c++0x)
+
+ */
+#ifndef __CC_DECODE_STATS_AGGREGATOR_H__
+#define __CC_DECODE_STATS_AGGREGATOR_H__
+
+#include "CC_DecodeStats.h"
+#include "CC_DecodingBudget.h"
+
+#include <atomic>
+#include <iostream>
+
+namespace ccsoft
+{
+
+/**
+ * \brief Sums and maxima of the decode statistics of many decodes and count of decodes by status. Decoders running in
+ * different threads add their statistics concurrently without locking: every counter is an independent atomic updated
+ * with relaxed ordering so a reading taken while decodes are added may mix statistics of different decodes.
+ */
+class CC_DecodeStatsAggregator
+{
+public:
+    /**
+     * \brief Aggregated counters
+     */
+    typedef enum
+    {
+        Counter_Nodes,
+        Counter_EffectiveNodes,
+        Counter_Moves,
+        Counter_MaxDepth,
+        Counter_StackSize,
+        Counter_ThresholdChanges,
+        Counter_CacheEvictions,
+        Counter_ElapsedNs,
+        Counter_Count
+    } Counter;
+
+    static const unsigned int nb_status = CC_Decoding_NoPath + 1; //!< Number of decoding status values
+
+    CC_DecodeStatsAggregator()
+    {
+        clear();
+    }
+
+    ~CC_DecodeStatsAggregator()
+    {}
+
+    /**
+     * Zero all counters. Not to be called while decodes are being added.
+     */
+    void clear()
+    {
+        nb_decodes.store(0, std::memory_order_relaxed);
+
+        for (unsigned int i=0; i<nb_status; i++)
+        {
+            status_counts[i].store(0, std::memory_order_relaxed);
+        }
+
+        for (unsigned int i=0; i<Counter_Count; i++)
+        {
+            sums[i].store(0, std::memory_order_relaxed);
+            maxima[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Add the statistics of one decode. Safe to call from several threads.
+     */
+    void add(const CC_DecodeStats& stats)
+    {
+        nb_decodes.fetch_add(1, std::memory_order_relaxed);
+
+        if ((unsigned int) stats.status < nb_status)
+        {
+            status_counts[stats.status].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        add_counter(Counter_Nodes, stats.nb_nodes);
+        add_counter(Counter_EffectiveNodes, stats.nb_effective_nodes);
+        add_counter(Counter_Moves, stats.nb_moves);
+        add_counter(Counter_MaxDepth, stats.max_depth);
+        add_counter(Counter_StackSize, stats.stack_size);
+        add_counter(Counter_ThresholdChanges, stats.nb_threshold_changes);
+        add_counter(Counter_CacheEvictions, stats.nb_cache_evictions);
+        add_counter(Counter_ElapsedNs, stats.elapsed_ns);
+    }
+
+    /**
+     * Number of decodes added
+     */
+    unsigned long long get_nb_decodes() const
+    {
+        return nb_decodes.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Number of decodes that ended with the given status
+     */
+    unsigned long long get_nb_status(CC_DecodingStatus status) const
+    {
+        return status_counts[status].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Sum of a counter over all decodes
+     */
+    unsigned long long get_sum(Counter counter) const
+    {
+        return sums[counter].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Largest value of a counter in one decode
+     */
+    unsigned long long get_max(Counter counter) const
+    {
+        return maxima[counter].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Mean value of a counter per decode
+     */
+    double get_mean(Counter counter) const
+    {
+        unsigned long long n = get_nb_decodes();
+        return (n ? ((double) get_sum(counter)) / n : 0.0);
+    }
+
+    /**
+     * Name of a counter for display
+     */
+    static const char *get_counter_name(Counter counter)
+    {
+        switch (counter)
+        {
+        case Counter_Nodes:
+            return "nodes";
+        case Counter_EffectiveNodes:
+            return "eff_nodes";
+        case Counter_Moves:
+            return "moves";
+        case Counter_MaxDepth:
+            return "max_depth";
+        case Counter_StackSize:
+            return "stack_size";
+        case Counter_ThresholdChanges:
+            return "threshold_changes";
+        case Counter_CacheEvictions:
+            return "cache_evictions";
+        case Counter_ElapsedNs:
+            return "elapsed_ns";
+        default:
+            return "unknown";
+        }
+    }
+
+    /**
+     * Print the number of decodes by status then the mean and maximum of each counter
+     * \param os Output stream
+     */
+    void print(std::ostream& os) const
+    {
+        os << "decodes = " << get_nb_decodes();
+
+        for (unsigned int i=0; i<nb_status; i++)
+        {
+            os << " " << (int) i << ":" << get_nb_status((CC_DecodingStatus) i);
+        }
+
+        for (unsigned int i=0; i<Counter_Count; i++)
+        {
+            os << " " << get_counter_name((Counter) i) << " = " << get_mean((Counter) i) << "/" << get_max((Counter) i);
+        }
+    }
+
+protected:
+    /**
+     * Add a value to the sum of a counter and raise its maximum
+     */
+    void add_counter(Counter counter, unsigned long long value)
+    {
+        sums[counter].fetch_add(value, std::memory_order_relaxed);
+        unsigned long long current_max = maxima[counter].load(std::memory_order_relaxed);
+
+        while ((value > current_max) && !maxima[counter].compare_exchange_weak(current_max, value, std::memory_order_relaxed))
+        {} // current_max is reloaded by a failed exchange
+    }
+
+    std::atomic<unsigned long long> nb_decodes;                 //!< Number of decodes
+    std::atomic<unsigned long long> status_counts[nb_status];   //!< Number of decodes by status
+    std::atomic<unsigned long long> sums[Counter_Count];        //!< Sum of each counter
+    std::atomic<unsigned long long> maxima[Counter_Count];      //!< Maximum of each counter
+};
+
+} // namespace ccsoft
+
+#endif // __CC_DECODE_STATS_AGGREGATOR_H__
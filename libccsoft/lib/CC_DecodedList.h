@@ -0,0 +1,153 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ List of decoded messages with their scores as returned by list decoding
+
+ */
+#ifndef __CC_DECODED_LIST_H__
+#define __CC_DECODED_LIST_H__
+
+#include <vector>
+
+namespace ccsoft
+{
+
+/**
+ * \brief List of decoded messages ordered by decreasing path metric. The messages are stored one after the other
+ * in a single array that keeps its capacity from one decode to the next so a list reused across decodes does not
+ * allocate once it has grown to the largest list size and message length.
+ * \tparam T_IOSymbol Type of the input and output symbols
+ */
+template<typename T_IOSymbol>
+class CC_DecodedList
+{
+public:
+    CC_DecodedList() :
+        message_length(0),
+        nb_messages(0)
+    {}
+
+    ~CC_DecodedList()
+    {}
+
+    /**
+     * Empty the list before a new decode
+     * \param _message_length Number of symbols of each message
+     * \param max_nb_messages Maximum number of messages expected. Storage is reserved for them.
+     */
+    void clear(unsigned int _message_length, unsigned int max_nb_messages = 0)
+    {
+        message_length = _message_length;
+        nb_messages = 0;
+
+        if (max_nb_messages*message_length > symbols.size())
+        {
+            symbols.resize(max_nb_messages*message_length);
+        }
+
+        if (max_nb_messages > scores.size())
+        {
+            scores.resize(max_nb_messages);
+        }
+    }
+
+    /**
+     * Append a new message to the list
+     * \param score Score of the message
+     * \return Pointer to the storage of the message symbols. It is valid until the next message is appended.
+     */
+    T_IOSymbol *add_message(float score)
+    {
+        if ((nb_messages+1)*message_length > symbols.size())
+        {
+            symbols.resize((nb_messages+1)*message_length);
+        }
+
+        if (nb_messages+1 > scores.size())
+        {
+            scores.resize(nb_messages+1);
+        }
+
+        scores[nb_messages] = score;
+        return &symbols[(nb_messages++)*message_length];
+    }
+
+    /**
+     * Number of messages in the list
+     */
+    unsigned int size() const
+    {
+        return nb_messages;
+    }
+
+    /**
+     * Tells if the list is empty
+     */
+    bool empty() const
+    {
+        return nb_messages == 0;
+    }
+
+    /**
+     * Number of symbols of each message
+     */
+    unsigned int get_message_length() const
+    {
+        return message_length;
+    }
+
+    /**
+     * Get the symbols of a message
+     * \param index Rank of the message in the list
+     * \return Pointer to the first of get_message_length() symbols
+     */
+    const T_IOSymbol *get_message(unsigned int index) const
+    {
+        return &symbols[index*message_length];
+    }
+
+    /**
+     * Copy the symbols of a message
+     * \param index Rank of the message in the list
+     * \param message Vector receiving the symbols
+     */
+    void get_message(unsigned int index, std::vector<T_IOSymbol>& message) const
+    {
+        message.assign(symbols.begin() + index*message_length, symbols.begin() + (index+1)*message_length);
+    }
+
+    /**
+     * Get the score i.e. the path metric of a message
+     * \param index Rank of the message in the list
+     */
+    float get_score(unsigned int index) const
+    {
+        return scores[index];
+    }
+
+protected:
+    unsigned int message_length;     //!< Number of symbols of each message
+    unsigned int nb_messages;        //!< Number of messages in the list
+    std::vector<T_IOSymbol> symbols; //!< Symbols of all messages one after the other
+    std::vector<float> scores;       //!< Score of each message
+};
+
+} // namespace ccsoft
+
+#endif // __CC_DECODED_LIST_H__
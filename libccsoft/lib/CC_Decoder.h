@@ -0,0 +1,180 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Decoder interface independent of the register type and register storage
+ and its implementation over any of the decoder classes
+
+ */
+#ifndef __CC_DECODER_H__
+#define __CC_DECODER_H__
+
+#include "CC_ReliabilityMatrix.h"
+#include "CC_InterleaverPermutation.h"
+#include "CC_DecodingBudget.h"
+#include "CC_DecodeStats.h"
+
+#include <iostream>
+#include <vector>
+
+namespace ccsoft
+{
+
+/**
+ * \brief Decoder interface that depends only on the I/O symbol type. It hides the register type and whether the
+ * registers are stored in a fixed array (_FA classes) or a vector. Instances are usually obtained from
+ * create_decoder (CC_DecoderFactory.h).
+ * \tparam T_IOSymbol Type of the input and output symbols
+ */
+template<typename T_IOSymbol>
+class CC_Decoder
+{
+public:
+    virtual ~CC_Decoder()
+    {}
+
+    /**
+     * Decode a message
+     * \param relmat Reliability matrix
+     * \param decoded_message Decoded message
+     * \return true if successful
+     */
+    virtual bool decode(const CC_ReliabilityMatrix& relmat, std::vector<T_IOSymbol>& decoded_message) = 0;
+
+    virtual void set_node_limit(unsigned int node_limit) = 0;      //!< Set the node limit threshold
+    virtual void set_metric_limit(float metric_limit) = 0;         //!< Set the metric limit threshold
+    virtual void set_time_limit(double time_limit) = 0;            //!< Set the time limit of a decode in seconds
+    virtual void set_move_limit(unsigned int move_limit) = 0;      //!< Set the moves limit of a decode
+    virtual void set_tail_zeros(bool tail_zeros) = 0;              //!< Tells if the message ends with m-1 zero symbols
+    virtual void set_edge_bias(float edge_bias) = 0;               //!< Set the edge metric bias
+    virtual void set_verbosity(unsigned int verbosity) = 0;        //!< Set verbosity level
+
+    virtual float get_score() const = 0;                           //!< Codeword score of the last decode
+    virtual CC_DecodingStatus get_status() const = 0;              //!< Status of the last decode
+    virtual const char *get_status_string() const = 0;             //!< Status of the last decode as a string
+    virtual unsigned int get_nb_nodes() const = 0;                 //!< Number of nodes created by the last decode
+    virtual CC_DecodeStats get_decode_stats() const = 0;           //!< Effort statistics of the last decode
+
+    virtual void print_dot(std::ostream& os) = 0;                  //!< Print the Graphviz code tree of the last decode
+    virtual void print_stats(std::ostream& os, bool success) = 0;  //!< Print statistics of the last decode
+    virtual void print_stats_summary(std::ostream& os, bool success) = 0; //!< Print statistics summary of the last decode
+
+    virtual unsigned int get_k() const = 0;                        //!< Number of input bits
+    virtual unsigned int get_n() const = 0;                        //!< Number of output bits
+    virtual unsigned int get_m() const = 0;                        //!< Largest register length
+
+    /**
+     * Encode one symbol with the decoder's encoding
+     * \param in_symbol Input symbol
+     * \param out_symbol Output symbol
+     * \param no_step Do not shift the registers
+     */
+    virtual bool encode(const T_IOSymbol& in_symbol, T_IOSymbol& out_symbol, bool no_step = false) = 0;
+
+    virtual void clear_encoding() = 0;                             //!< Zero the registers of the decoder's encoding
+    virtual void print_encoding(std::ostream& os) = 0;             //!< Print the encoding parameters
+
+    virtual void interleave(std::vector<T_IOSymbol>& symbols, bool forward = true) = 0;  //!< See CC_Interleaver
+    virtual void deinterleave(CC_ReliabilityMatrix& relmat, bool forward = false) = 0;  //!< See CC_Interleaver
+    virtual const CC_InterleaverPermutation& get_permutation(unsigned int length) = 0;   //!< See CC_Interleaver
+
+    virtual bool is_fixed_array() const = 0;                       //!< Tells if a fixed array (_FA) class is used
+    virtual unsigned int get_register_bits() const = 0;            //!< Size of the register type in bits
+};
+
+/**
+ * \brief Implementation of the decoder interface that forwards to a decoder instance it owns
+ * \tparam T_Decoding Decoder class derived from CC_SequentialDecoding or CC_SequentialDecoding_FA
+ * \tparam T_Register Type of the encoder internal registers of the decoder class
+ * \tparam T_IOSymbol Type of the input and output symbols
+ * \tparam Fixed_Array true for the _FA classes
+ */
+template<typename T_Decoding, typename T_Register, typename T_IOSymbol, bool Fixed_Array>
+class CC_DecoderAdapter : public CC_Decoder<T_IOSymbol>
+{
+public:
+    /**
+     * Constructor
+     * \param _decoding Decoder instance. It is deleted with the adapter.
+     */
+    CC_DecoderAdapter(T_Decoding *_decoding) :
+        decoding(_decoding)
+    {}
+
+    virtual ~CC_DecoderAdapter()
+    {
+        delete decoding;
+    }
+
+    /**
+     * Get the underlying decoder e.g. to use methods that are not part of the interface
+     */
+    T_Decoding& get_decoding()
+    {
+        return *decoding;
+    }
+
+    virtual bool decode(const CC_ReliabilityMatrix& relmat, std::vector<T_IOSymbol>& decoded_message)
+    {
+        return decoding->decode(relmat, decoded_message);
+    }
+
+    virtual void set_node_limit(unsigned int node_limit) { decoding->set_node_limit(node_limit); }
+    virtual void set_metric_limit(float metric_limit) { decoding->set_metric_limit(metric_limit); }
+    virtual void set_time_limit(double time_limit) { decoding->set_time_limit(time_limit); }
+    virtual void set_move_limit(unsigned int move_limit) { decoding->set_move_limit(move_limit); }
+    virtual void set_tail_zeros(bool tail_zeros) { decoding->set_tail_zeros(tail_zeros); }
+    virtual void set_edge_bias(float edge_bias) { decoding->set_edge_bias(edge_bias); }
+    virtual void set_verbosity(unsigned int verbosity) { decoding->set_verbosity(verbosity); }
+
+    virtual float get_score() const { return decoding->get_score(); }
+    virtual CC_DecodingStatus get_status() const { return decoding->get_status(); }
+    virtual const char *get_status_string() const { return decoding->get_status_string(); }
+    virtual unsigned int get_nb_nodes() const { return decoding->get_nb_nodes(); }
+    virtual CC_DecodeStats get_decode_stats() const { return decoding->get_decode_stats(); }
+
+    virtual void print_dot(std::ostream& os) { decoding->print_dot(os); }
+    virtual void print_stats(std::ostream& os, bool success) { decoding->print_stats(os, success); }
+    virtual void print_stats_summary(std::ostream& os, bool success) { decoding->print_stats_summary(os, success); }
+
+    virtual unsigned int get_k() const { return decoding->get_encoding().get_k(); }
+    virtual unsigned int get_n() const { return decoding->get_encoding().get_n(); }
+    virtual unsigned int get_m() const { return decoding->get_encoding().get_m(); }
+
+    virtual bool encode(const T_IOSymbol& in_symbol, T_IOSymbol& out_symbol, bool no_step = false)
+    {
+        return decoding->get_encoding().encode(in_symbol, out_symbol, no_step);
+    }
+
+    virtual void clear_encoding() { decoding->get_encoding().clear(); }
+    virtual void print_encoding(std::ostream& os) { decoding->get_encoding().print(os); }
+
+    virtual void interleave(std::vector<T_IOSymbol>& symbols, bool forward = true) { decoding->interleave(symbols, forward); }
+    virtual void deinterleave(CC_ReliabilityMatrix& relmat, bool forward = false) { decoding->deinterleave(relmat, forward); }
+    virtual const CC_InterleaverPermutation& get_permutation(unsigned int length) { return decoding->get_permutation(length); }
+
+    virtual bool is_fixed_array() const { return Fixed_Array; }
+    virtual unsigned int get_register_bits() const { return 8*sizeof(T_Register); }
+
+protected:
+    T_Decoding *decoding; //!< Decoder instance
+};
+
+} // namespace ccsoft
+
+#endif // __CC_DECODER_H__
@@ -0,0 +1,234 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Creates the decoder best suited to code parameters only known at run time.
+ Needs C++11 (-std=c++0x) for the fixed array classes.
+
+ */
+#ifndef __CC_DECODER_FACTORY_H__
+#define __CC_DECODER_FACTORY_H__
+
+#include "CC_Decoder.h"
+#include "CC_StackDecoding.h"
+#include "CC_FanoDecoding.h"
+#include "CC_StackBucketDecoding.h"
+#include "CC_StackDecoding_FA.h"
+#include "CC_FanoDecoding_FA.h"
+#include "CC_StackBucketDecoding_FA.h"
+#include "CCSoft_Exception.h"
+
+#include <vector>
+#include <algorithm>
+
+namespace ccsoft
+{
+
+/**
+ * \brief Decoding algorithms available from the factory
+ */
+typedef enum
+{
+    CC_Algorithm_Stack,       //!< CC_StackDecoding
+    CC_Algorithm_Fano,        //!< CC_FanoDecoding
+    CC_Algorithm_StackBucket  //!< CC_StackBucketDecoding
+} CC_DecoderAlgorithm;
+
+/**
+ * \brief Algorithm specific parameters of the decoders created by the factory. Defaults are the constructors defaults.
+ */
+struct CC_DecoderParameters
+{
+    CC_DecoderParameters() :
+        fano_init_threshold(0.0),
+        fano_delta_threshold(1.0),
+        fano_tree_cache_size(0),
+        fano_delta_init_threshold(0.0),
+        bucket_width(1.0),
+        stack_size_limit(0),
+        stack_merge_detection(false)
+    {}
+
+    float fano_init_threshold;         //!< Fano initial threshold
+    float fano_delta_threshold;        //!< Fano threshold step
+    unsigned int fano_tree_cache_size; //!< Fano code tree cache size. 0 for no cache.
+    float fano_delta_init_threshold;   //!< Fano initial threshold step when going back to the root
+    float bucket_width;                //!< Stack bucket width
+    unsigned int stack_size_limit;     //!< Stack bucket size limit. 0 for no limit.
+    bool stack_merge_detection;        //!< Stack merge detection (see CC_StackDecoding::set_merge_detection)
+};
+
+/**
+ * Largest number of input bits (k) with a pre-instantiated fixed array (_FA) decoder. Larger k fall back to the
+ * vector based classes.
+ */
+static const unsigned int cc_decoder_factory_max_fixed_array_k = 4;
+
+/**
+ * \brief Instantiates one algorithm with a given register type using the vector based classes
+ */
+template<typename T_Register, typename T_IOSymbol>
+struct CC_DecoderFactoryAlgorithms
+{
+    static CC_Decoder<T_IOSymbol> *create(CC_DecoderAlgorithm algorithm,
+            const std::vector<unsigned int>& constraints,
+            const std::vector<std::vector<T_Register> >& genpolys,
+            const CC_DecoderParameters& parameters)
+    {
+        switch (algorithm)
+        {
+        case CC_Algorithm_Fano:
+            return new CC_DecoderAdapter<CC_FanoDecoding<T_Register, T_IOSymbol>, T_Register, T_IOSymbol, false>(
+                new CC_FanoDecoding<T_Register, T_IOSymbol>(constraints, genpolys,
+                        parameters.fano_init_threshold,
+                        parameters.fano_delta_threshold,
+                        parameters.fano_tree_cache_size,
+                        parameters.fano_delta_init_threshold));
+        case CC_Algorithm_StackBucket:
+            return new CC_DecoderAdapter<CC_StackBucketDecoding<T_Register, T_IOSymbol>, T_Register, T_IOSymbol, false>(
+                new CC_StackBucketDecoding<T_Register, T_IOSymbol>(constraints, genpolys,
+                        parameters.bucket_width,
+                        parameters.stack_size_limit));
+        default:
+        {
+            CC_StackDecoding<T_Register, T_IOSymbol> *stack_decoding = new CC_StackDecoding<T_Register, T_IOSymbol>(constraints, genpolys);
+            stack_decoding->set_merge_detection(parameters.stack_merge_detection);
+            return new CC_DecoderAdapter<CC_StackDecoding<T_Register, T_IOSymbol>, T_Register, T_IOSymbol, false>(stack_decoding);
+        }
+        }
+    }
+};
+
+/**
+ * \brief Instantiates one algorithm with a given register type using the fixed array classes with k = N_k
+ */
+template<typename T_Register, typename T_IOSymbol, unsigned int N_k>
+struct CC_DecoderFactoryAlgorithms_FA
+{
+    static CC_Decoder<T_IOSymbol> *create(CC_DecoderAlgorithm algorithm,
+            const std::vector<unsigned int>& constraints,
+            const std::vector<std::vector<T_Register> >& genpolys,
+            const CC_DecoderParameters& parameters)
+    {
+        switch (algorithm)
+        {
+        case CC_Algorithm_Fano:
+            return new CC_DecoderAdapter<CC_FanoDecoding_FA<T_Register, T_IOSymbol, N_k>, T_Register, T_IOSymbol, true>(
+                new CC_FanoDecoding_FA<T_Register, T_IOSymbol, N_k>(constraints, genpolys,
+                        parameters.fano_init_threshold,
+                        parameters.fano_delta_threshold,
+                        parameters.fano_tree_cache_size,
+                        parameters.fano_delta_init_threshold));
+        case CC_Algorithm_StackBucket:
+            return new CC_DecoderAdapter<CC_StackBucketDecoding_FA<T_Register, T_IOSymbol, N_k>, T_Register, T_IOSymbol, true>(
+                new CC_StackBucketDecoding_FA<T_Register, T_IOSymbol, N_k>(constraints, genpolys,
+                        parameters.bucket_width,
+                        parameters.stack_size_limit));
+        default:
+        {
+            CC_StackDecoding_FA<T_Register, T_IOSymbol, N_k> *stack_decoding = new CC_StackDecoding_FA<T_Register, T_IOSymbol, N_k>(constraints, genpolys);
+            stack_decoding->set_merge_detection(parameters.stack_merge_detection);
+            return new CC_DecoderAdapter<CC_StackDecoding_FA<T_Register, T_IOSymbol, N_k>, T_Register, T_IOSymbol, true>(stack_decoding);
+        }
+        }
+    }
+};
+
+/**
+ * Create a decoder for a given register type. Dispatches k to the fixed array instantiations up to
+ * cc_decoder_factory_max_fixed_array_k else uses the vector based classes.
+ */
+template<typename T_Register, typename T_IOSymbol, typename T_GenPoly>
+CC_Decoder<T_IOSymbol> *create_decoder_with_register(CC_DecoderAlgorithm algorithm,
+        const std::vector<unsigned int>& constraints,
+        const std::vector<std::vector<T_GenPoly> >& genpoly_representations,
+        const CC_DecoderParameters& parameters,
+        bool use_fixed_array)
+{
+    std::vector<std::vector<T_Register> > genpolys(genpoly_representations.size());
+
+    for (unsigned int i=0; i<genpoly_representations.size(); i++)
+    {
+        genpolys[i].assign(genpoly_representations[i].begin(), genpoly_representations[i].end());
+    }
+
+    if (use_fixed_array)
+    {
+        switch (constraints.size())
+        {
+        case 1:
+            return CC_DecoderFactoryAlgorithms_FA<T_Register, T_IOSymbol, 1>::create(algorithm, constraints, genpolys, parameters);
+        case 2:
+            return CC_DecoderFactoryAlgorithms_FA<T_Register, T_IOSymbol, 2>::create(algorithm, constraints, genpolys, parameters);
+        case 3:
+            return CC_DecoderFactoryAlgorithms_FA<T_Register, T_IOSymbol, 3>::create(algorithm, constraints, genpolys, parameters);
+        case 4:
+            return CC_DecoderFactoryAlgorithms_FA<T_Register, T_IOSymbol, 4>::create(algorithm, constraints, genpolys, parameters);
+        default:
+            break;
+        }
+    }
+
+    return CC_DecoderFactoryAlgorithms<T_Register, T_IOSymbol>::create(algorithm, constraints, genpolys, parameters);
+}
+
+/**
+ * Create the decoder best suited to code parameters known at run time. The register type is the narrowest of
+ * unsigned int and unsigned long long that holds the longest register. A fixed array (_FA) class is used when k is
+ * at most cc_decoder_factory_max_fixed_array_k else the vector based class of the same algorithm is used. The I/O
+ * symbol type is checked against k and n by the encoding constructor.
+ * \tparam T_IOSymbol Type of the input and output symbols
+ * \tparam T_GenPoly Type of the generator polynomials representations given
+ * \param algorithm Decoding algorithm
+ * \param constraints Vector of register lengths (constraint length + 1). The number of elements determines k.
+ * \param genpoly_representations Generator polynomial numeric representations (see CC_Encoding)
+ * \param parameters Algorithm specific parameters
+ * \param use_fixed_array false to force the vector based classes
+ * \return New decoder. It is to be deleted by the caller.
+ */
+template<typename T_IOSymbol, typename T_GenPoly>
+CC_Decoder<T_IOSymbol> *create_decoder(CC_DecoderAlgorithm algorithm,
+        const std::vector<unsigned int>& constraints,
+        const std::vector<std::vector<T_GenPoly> >& genpoly_representations,
+        const CC_DecoderParameters& parameters = CC_DecoderParameters(),
+        bool use_fixed_array = true)
+{
+    if (constraints.size() == 0)
+    {
+        throw CCSoft_Exception("There must be at least one constraint size");
+    }
+
+    unsigned int max_constraint = *std::max_element(constraints.begin(), constraints.end());
+
+    if (max_constraint <= 8*sizeof(unsigned int))
+    {
+        return create_decoder_with_register<unsigned int, T_IOSymbol>(algorithm, constraints, genpoly_representations, parameters, use_fixed_array);
+    }
+    else if (max_constraint <= 8*sizeof(unsigned long long))
+    {
+        return create_decoder_with_register<unsigned long long, T_IOSymbol>(algorithm, constraints, genpoly_representations, parameters, use_fixed_array);
+    }
+    else
+    {
+        throw CCSoft_Exception("One constraint size is too large for the size of the registers");
+    }
+}
+
+} // namespace ccsoft
+
+#endif // __CC_DECODER_FACTORY_H__
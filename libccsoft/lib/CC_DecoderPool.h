@@ -0,0 +1,311 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Batch decoding of many frames over a pool of worker threads each owning
+ its own decoder instance. Needs C++11 (-std=c++0x -pthread).
+
+ */
+#ifndef __CC_DECODER_POOL_H__
+#define __CC_DECODER_POOL_H__
+
+#include "CC_ReliabilityMatrix.h"
+#include "CC_DecodingBudget.h"
+#include "CC_DecodeStatsAggregator.h"
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <exception>
+
+namespace ccsoft
+{
+
+/**
+ * \brief Decoding result of one frame of a batch
+ * \tparam T_IOSymbol Type of the input and output symbols
+ */
+template<typename T_IOSymbol>
+struct CC_DecoderPoolResult
+{
+    CC_DecoderPoolResult() :
+        success(false),
+        status(CC_Decoding_Success),
+        score(0.0),
+        nb_nodes(0)
+    {}
+
+    std::vector<T_IOSymbol> decoded_message; //!< Decoded message (best partial path if the decode failed)
+    bool success;                            //!< Value returned by the decoder
+    CC_DecodingStatus status;                //!< Decoding status
+    float score;                             //!< Codeword score
+    unsigned int nb_nodes;                   //!< Number of nodes or node+edges created by the decoder
+};
+
+/**
+ * \brief Decodes a batch of frames in parallel. Each worker thread owns a decoder instance obtained from a factory
+ * so that the decoders state (encoding registers, code tree, stack...) is never shared. Sequential decoding cost varies
+ * a lot from frame to frame so frames are not statically partitioned: each worker starts on a contiguous range of frames
+ * taken from the front and when it runs dry it steals frames from the back of the largest remaining range.
+ * Results are stored by frame index so they come back in the order of the frames.
+ * \tparam T_Decoding Decoder class. It must implement decode(relmat, decoded_message), get_status(), get_score(),
+ * get_nb_nodes() and get_decode_stats() like the CC_SequentialDecoding and CC_SequentialDecoding_FA classes.
+ * \tparam T_IOSymbol Type of the input and output symbols
+ */
+template<typename T_Decoding, typename T_IOSymbol>
+class CC_DecoderPool
+{
+public:
+    typedef std::function<T_Decoding*()> DecoderFactory; //!< Creates a new configured decoder instance
+    typedef CC_DecoderPoolResult<T_IOSymbol> Result;
+
+    /**
+     * Constructor
+     * \param decoder_factory Creates one decoder per worker thread. Decoders are deleted by the pool.
+     * \param _nb_threads Number of worker threads. 0 to use the number of hardware threads.
+     */
+    CC_DecoderPool(const DecoderFactory& decoder_factory, unsigned int _nb_threads = 0) :
+        nb_threads(_nb_threads > 0 ? _nb_threads : std::max(std::thread::hardware_concurrency(), 1U)),
+        work_ranges(nb_threads),
+        nb_steals(0),
+        stats_aggregator(0)
+    {
+        for (unsigned int i=0; i<nb_threads; i++)
+        {
+            decoders.push_back(decoder_factory());
+        }
+    }
+
+    /**
+     * Destructor. Deletes the decoders.
+     */
+    ~CC_DecoderPool()
+    {
+        for (unsigned int i=0; i<decoders.size(); i++)
+        {
+            delete decoders[i];
+        }
+    }
+
+    /**
+     * Number of worker threads
+     */
+    unsigned int get_nb_threads() const
+    {
+        return nb_threads;
+    }
+
+    /**
+     * Decoder instance of a worker thread e.g. to get its statistics after a batch
+     * \param thread_index Index of the worker thread
+     */
+    T_Decoding& get_decoder(unsigned int thread_index)
+    {
+        return *decoders.at(thread_index);
+    }
+
+    /**
+     * Number of frames stolen from another worker during the last batch
+     */
+    unsigned int get_nb_steals() const
+    {
+        return nb_steals;
+    }
+
+    /**
+     * Set the aggregator the workers add the statistics of each decode to
+     * \param _stats_aggregator Pointer to the aggregator or 0 for none (default)
+     */
+    void set_stats_aggregator(CC_DecodeStatsAggregator *_stats_aggregator)
+    {
+        stats_aggregator = _stats_aggregator;
+    }
+
+    /**
+     * Decode a batch of frames
+     * \param relmats Array of reliability matrices of the frames
+     * \param nb_frames Number of frames
+     * \param results Decoding results in frame order
+     */
+    void decode(const CC_ReliabilityMatrix *relmats, unsigned int nb_frames, std::vector<Result>& results)
+    {
+        results.clear();
+        results.resize(nb_frames);
+        nb_steals = 0;
+        worker_exception = std::exception_ptr();
+
+        for (unsigned int i=0; i<nb_threads; i++)
+        {
+            work_ranges[i].begin = (unsigned int) (((unsigned long long) nb_frames * i) / nb_threads);
+            work_ranges[i].end = (unsigned int) (((unsigned long long) nb_frames * (i+1)) / nb_threads);
+        }
+
+        std::vector<std::thread> threads;
+
+        for (unsigned int i=1; i<nb_threads; i++)
+        {
+            threads.push_back(std::thread(&CC_DecoderPool::work, this, i, relmats, &results));
+        }
+
+        work(0, relmats, &results); // calling thread is worker #0
+
+        for (unsigned int i=0; i<threads.size(); i++)
+        {
+            threads[i].join();
+        }
+
+        if (worker_exception)
+        {
+            std::rethrow_exception(worker_exception);
+        }
+    }
+
+    /**
+     * Decode a batch of frames
+     * \param relmats Reliability matrices of the frames
+     * \param results Decoding results in frame order
+     */
+    void decode(const std::vector<CC_ReliabilityMatrix>& relmats, std::vector<Result>& results)
+    {
+        decode(relmats.data(), relmats.size(), results);
+    }
+
+protected:
+    /**
+     * \brief Range of frame indexes left to a worker
+     */
+    struct WorkRange
+    {
+        WorkRange() : begin(0), end(0) {}
+
+        std::mutex mutex;  //!< Guards the range against the owner and thieves
+        unsigned int begin; //!< Next frame index of the owner
+        unsigned int end;   //!< One past the last frame index. Thieves take from there.
+    };
+
+    /**
+     * Take the next frame of a worker from the front of its own range else steal one from the back of the largest range
+     * \param worker_index Index of the worker thread
+     * \param frame_index Index of the frame to decode
+     * \return false if there is no more work
+     */
+    bool next_frame(unsigned int worker_index, unsigned int& frame_index)
+    {
+        {
+            WorkRange& own_range = work_ranges[worker_index];
+            std::lock_guard<std::mutex> lock(own_range.mutex);
+
+            if (own_range.begin < own_range.end)
+            {
+                frame_index = own_range.begin++;
+                return true;
+            }
+        }
+
+        while (true)
+        {
+            unsigned int victim_index = nb_threads;
+            unsigned int victim_size = 0;
+
+            for (unsigned int i=0; i<nb_threads; i++) // look up the largest range. It may shrink before it is locked again below
+            {
+                WorkRange& range = work_ranges[i];
+                std::lock_guard<std::mutex> lock(range.mutex);
+
+                if (range.end - range.begin > victim_size)
+                {
+                    victim_size = range.end - range.begin;
+                    victim_index = i;
+                }
+            }
+
+            if (victim_index == nb_threads)
+            {
+                return false;
+            }
+
+            WorkRange& victim_range = work_ranges[victim_index];
+            std::lock_guard<std::mutex> lock(victim_range.mutex);
+
+            if (victim_range.begin < victim_range.end)
+            {
+                frame_index = --victim_range.end;
+                std::lock_guard<std::mutex> steals_lock(steals_mutex);
+                nb_steals++;
+                return true;
+            }
+        }
+    }
+
+    /**
+     * Worker thread loop
+     */
+    void work(unsigned int worker_index, const CC_ReliabilityMatrix *relmats, std::vector<Result> *results)
+    {
+        T_Decoding& decoder = *decoders[worker_index];
+        unsigned int frame_index;
+
+        try
+        {
+            while (next_frame(worker_index, frame_index))
+            {
+                Result& result = (*results)[frame_index];
+                result.success = decoder.decode(relmats[frame_index], result.decoded_message);
+                result.status = decoder.get_status();
+                result.score = decoder.get_score();
+                result.nb_nodes = decoder.get_nb_nodes();
+
+                if (stats_aggregator)
+                {
+                    stats_aggregator->add(decoder.get_decode_stats());
+                }
+            }
+        }
+        catch (...)
+        {
+            {
+                std::lock_guard<std::mutex> lock(steals_mutex);
+
+                if (!worker_exception)
+                {
+                    worker_exception = std::current_exception();
+                }
+            }
+
+            for (unsigned int i=0; i<nb_threads; i++) // let the other workers finish early
+            {
+                std::lock_guard<std::mutex> range_lock(work_ranges[i].mutex);
+                work_ranges[i].begin = work_ranges[i].end;
+            }
+        }
+    }
+
+    unsigned int nb_threads;                 //!< Number of worker threads
+    std::vector<WorkRange> work_ranges;      //!< Frames left to each worker thread
+    std::vector<T_Decoding*> decoders;       //!< Decoder instance of each worker thread
+    std::mutex steals_mutex;                 //!< Guards the steals count and the worker exception
+    unsigned int nb_steals;                  //!< Number of frames stolen during the last batch
+    std::exception_ptr worker_exception;     //!< First exception thrown by a worker during the last batch
+    CC_DecodeStatsAggregator *stats_aggregator; //!< Aggregator of the decode statistics, 0 for none
+};
+
+} // namespace ccsoft
+
+#endif // __CC_DECODER_POOL_H__
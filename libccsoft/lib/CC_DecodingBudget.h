@@ -0,0 +1,234 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Decoding status and per decode work and wall clock time budgets
+
+ */
+#ifndef __CC_DECODING_BUDGET_H__
+#define __CC_DECODING_BUDGET_H__
+
+#include <time.h>
+
+namespace ccsoft
+{
+
+/**
+ * \brief Outcome of a decode
+ */
+typedef enum
+{
+    CC_Decoding_Success,     //!< A terminal node was reached: the decoded message is a full codeword
+    CC_Decoding_NodeLimit,   //!< Node limit exhausted: the decoded message is the best partial path
+    CC_Decoding_MetricLimit, //!< Metric limit encountered: the decoded message is the best partial path if any
+    CC_Decoding_TimeLimit,   //!< Time limit reached: the decoded message is the best partial path
+    CC_Decoding_MoveLimit,   //!< Move limit reached: the decoded message is the best partial path
+    CC_Decoding_Loop,        //!< Loop condition detected: the decoded message is the best partial path
+    CC_Decoding_NoPath       //!< No valid path through the code trellis
+} CC_DecodingStatus;
+
+/**
+ * \brief Human readable decoding status
+ */
+inline const char *get_decoding_status_string(CC_DecodingStatus status)
+{
+    switch (status)
+    {
+    case CC_Decoding_Success:
+        return "Success";
+    case CC_Decoding_NodeLimit:
+        return "Node limit exhausted";
+    case CC_Decoding_MetricLimit:
+        return "Metric limit encountered";
+    case CC_Decoding_TimeLimit:
+        return "Time limit reached";
+    case CC_Decoding_MoveLimit:
+        return "Move limit reached";
+    case CC_Decoding_Loop:
+        return "Loop condition detected";
+    case CC_Decoding_NoPath:
+        return "No valid path";
+    default:
+        return "Unknown status";
+    }
+}
+
+/**
+ * \brief Work and wall clock time budgets of a decode. A move is one iteration of the decoding algorithm main loop
+ * (a node expansion in the stack algorithms, a forward or backward move or a threshold change in the Fano algorithm).
+ * The clock is read only once every (1<<time_check_log2) moves to keep it out of the hot path. It is also read at the
+ * start and at the end of the decode to measure its duration.
+ */
+class CC_DecodingBudget
+{
+public:
+    CC_DecodingBudget() :
+        use_time_limit(false),
+        time_limit(0.0),
+        use_move_limit(false),
+        move_limit(0),
+        nb_moves(0),
+        elapsed_ns(0)
+    {
+        start_time.tv_sec = 0;
+        start_time.tv_nsec = 0;
+    }
+
+    ~CC_DecodingBudget()
+    {}
+
+    /**
+     * Set the wall clock time limit
+     * \param _time_limit Time limit in seconds
+     */
+    void set_time_limit(double _time_limit)
+    {
+        time_limit = _time_limit;
+        use_time_limit = true;
+    }
+
+    /**
+     * Remove the wall clock time limit
+     */
+    void reset_time_limit()
+    {
+        use_time_limit = false;
+    }
+
+    /**
+     * Set the move limit
+     * \param _move_limit Maximum number of moves
+     */
+    void set_move_limit(unsigned int _move_limit)
+    {
+        move_limit = _move_limit;
+        use_move_limit = true;
+    }
+
+    /**
+     * Remove the move limit
+     */
+    void reset_move_limit()
+    {
+        use_move_limit = false;
+    }
+
+    /**
+     * Start the budgets at the beginning of a decode
+     */
+    void start()
+    {
+        nb_moves = 0;
+        elapsed_ns = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+    }
+
+    /**
+     * Record the duration of the decode at its end
+     */
+    void stop()
+    {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        elapsed_ns = (now.tv_sec - start_time.tv_sec)*1000000000ULL + now.tv_nsec - start_time.tv_nsec;
+    }
+
+    /**
+     * Count one move and check the budgets
+     * \return CC_Decoding_Success if the decode can continue else the limit reached
+     */
+    CC_DecodingStatus move()
+    {
+        nb_moves++;
+
+        if (use_move_limit && (nb_moves > move_limit))
+        {
+            return CC_Decoding_MoveLimit;
+        }
+
+        if (use_time_limit && ((nb_moves & ((1<<time_check_log2) - 1)) == 0) && (get_elapsed_time() > time_limit))
+        {
+            return CC_Decoding_TimeLimit;
+        }
+
+        return CC_Decoding_Success;
+    }
+
+    /**
+     * Number of moves since the start of the decode
+     */
+    unsigned int get_nb_moves() const
+    {
+        return nb_moves;
+    }
+
+    /**
+     * Duration of the last decode in nanoseconds as recorded by stop()
+     */
+    unsigned long long get_elapsed_ns() const
+    {
+        return elapsed_ns;
+    }
+
+    /**
+     * Time elapsed since the start of the decode in seconds
+     */
+    double get_elapsed_time() const
+    {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (now.tv_sec - start_time.tv_sec) + (now.tv_nsec - start_time.tv_nsec) / 1e9;
+    }
+
+protected:
+    static const unsigned int time_check_log2 = 8; //!< Log2 of the number of moves between clock readings
+
+    bool use_time_limit;     //!< True if a wall clock time limit is used
+    double time_limit;       //!< Wall clock time limit in seconds
+    bool use_move_limit;     //!< True if a move limit is used
+    unsigned int move_limit; //!< Maximum number of moves
+    unsigned int nb_moves;   //!< Number of moves since the start of the decode
+    unsigned long long elapsed_ns; //!< Duration of the last decode in nanoseconds
+    timespec start_time;     //!< Start time of the decode
+};
+
+/**
+ * \brief Starts a budget on construction and records the duration of the decode on destruction whichever way the
+ * decode returns
+ */
+class CC_DecodingBudgetScope
+{
+public:
+    CC_DecodingBudgetScope(CC_DecodingBudget& _budget) :
+        budget(_budget)
+    {
+        budget.start();
+    }
+
+    ~CC_DecodingBudgetScope()
+    {
+        budget.stop();
+    }
+
+protected:
+    CC_DecodingBudget& budget; //!< Budget of the decode
+};
+
+} // namespace ccsoft
+
+#endif // __CC_DECODING_BUDGET_H__
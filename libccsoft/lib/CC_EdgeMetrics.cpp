@@ -0,0 +1,103 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Edge metrics table
+
+ */
+
+#include "CC_EdgeMetrics.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace ccsoft
+{
+
+// ================================================================================================
+CC_EdgeMetrics::CC_EdgeMetrics() :
+        _nb_symbols(0),
+        _message_length(0)
+{}
+
+// ================================================================================================
+CC_EdgeMetrics::~CC_EdgeMetrics()
+{}
+
+// ================================================================================================
+void CC_EdgeMetrics::init(const CC_ReliabilityMatrix& relmat, float edge_bias)
+{
+    _nb_symbols = relmat.get_nb_symbols();
+    _message_length = relmat.get_message_length();
+    unsigned int nb_cells = _nb_symbols*_message_length;
+
+    if (_metrics.size() < nb_cells)
+    {
+        _metrics.resize(nb_cells);
+    }
+
+    // single pass over the contiguous storage of both matrices
+    const float *rel = relmat.get_raw_matrix();
+    float *metrics = &_metrics[0];
+    unsigned int i = 0;
+
+#ifdef __SSE2__
+    // log2_reliability() four values at a time with the conditions turned into masks
+    const __m128i exponent_mask = _mm_set1_epi32(0x7f800000);
+    const __m128i mantissa_mask = _mm_set1_epi32(0x7fffff);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 bias = _mm_set1_ps(edge_bias);
+
+    for (; i + 4 <= nb_cells; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(rel + i);
+        __m128i bits = _mm_castps_si128(x);
+        __m128i is_zero = _mm_cmpeq_epi32(_mm_and_si128(bits, _mm_set1_epi32(0x7fffffff)), zero);
+        __m128i denormal = _mm_cmpeq_epi32(_mm_and_si128(bits, exponent_mask), zero);
+        __m128 scale = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(denormal, _mm_set1_epi32(0x4b000000)),
+                _mm_andnot_si128(denormal, _mm_set1_epi32(0x3f800000)))); // 2^23 or 1
+        bits = _mm_castps_si128(_mm_mul_ps(x, scale));
+        __m128i mantissa_bits = _mm_and_si128(bits, mantissa_mask);
+        __m128i upper = _mm_cmpgt_epi32(mantissa_bits, _mm_set1_epi32(0x3504f3));
+        __m128i exponent = _mm_sub_epi32(_mm_srli_epi32(_mm_and_si128(bits, exponent_mask), 23), _mm_set1_epi32(127));
+        exponent = _mm_sub_epi32(exponent, _mm_and_si128(denormal, _mm_set1_epi32(23)));
+        exponent = _mm_sub_epi32(exponent, upper); // upper is -1 where set
+        __m128 mantissa = _mm_castsi128_ps(_mm_or_si128(mantissa_bits, _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi32(0x3f000000)),
+                _mm_andnot_si128(upper, _mm_set1_epi32(0x3f800000)))));
+        __m128 f = _mm_sub_ps(mantissa, _mm_set1_ps(1.0f));
+        __m128 s = _mm_div_ps(f, _mm_add_ps(_mm_set1_ps(2.0f), f));
+        __m128 s2 = _mm_mul_ps(s, s);
+        __m128 p = _mm_add_ps(_mm_set1_ps(2.0f/7.0f), _mm_mul_ps(s2, _mm_set1_ps(2.0f/9.0f)));
+        p = _mm_add_ps(_mm_set1_ps(2.0f/5.0f), _mm_mul_ps(s2, p));
+        p = _mm_add_ps(_mm_set1_ps(2.0f/3.0f), _mm_mul_ps(s2, p));
+        p = _mm_add_ps(_mm_set1_ps(2.0f), _mm_mul_ps(s2, p));
+        __m128 ln = _mm_mul_ps(s, p);
+        __m128 result = _mm_add_ps(_mm_cvtepi32_ps(exponent), _mm_mul_ps(ln, _mm_set1_ps(1.44269504f)));
+        result = _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(is_zero), _mm_set1_ps(-INFINITY)), _mm_andnot_ps(_mm_castsi128_ps(is_zero), result));
+        _mm_storeu_ps(metrics + i, _mm_sub_ps(result, bias));
+    }
+#endif
+
+    for (; i<nb_cells; i++)
+    {
+        metrics[i] = log2_reliability(rel[i]) - edge_bias;
+    }
+}
+
+} // namespace ccsoft
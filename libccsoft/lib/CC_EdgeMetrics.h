@@ -0,0 +1,134 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Edge metrics table. Biased log2 of the reliability values computed once
+ per decode for the whole reliability matrix.
+
+ */
+
+#ifndef __CC_EDGE_METRICS_H__
+#define __CC_EDGE_METRICS_H__
+
+#include "CC_ReliabilityMatrix.h"
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+
+namespace ccsoft
+{
+
+/**
+ * \brief Edge metrics table. Holds the biased log2 of each value of a reliability matrix so that the sequential
+ * decoders do not compute a logarithm each time they create an edge. It has the same layout as the reliability
+ * matrix (column first). The storage is kept between decodes and only grows when needed.
+ */
+class CC_EdgeMetrics
+{
+public:
+    /**
+     * Constructor
+     */
+    CC_EdgeMetrics();
+
+    /**
+     * Destructor
+     */
+    ~CC_EdgeMetrics();
+
+    /**
+     * Compute the table for the whole reliability matrix
+     * \param relmat Reference to the reliability matrix
+     * \param edge_bias Edge metric bias subtracted from log2 of reliability of the edge
+     */
+    void init(const CC_ReliabilityMatrix& relmat, float edge_bias);
+
+    /**
+     * Get the number of symbols (i.e. rows)
+     */
+    unsigned int get_nb_symbols() const
+    {
+        return _nb_symbols;
+    }
+
+    /**
+     * Get the number of message symbols (i.e. columns)
+     */
+    unsigned int get_message_length() const
+    {
+        return _message_length;
+    }
+
+    /**
+     * Operator to get the edge metric for a given output symbol at a given depth (column)
+     */
+    float operator()(unsigned int out_symbol, unsigned int depth) const
+    {
+        return _metrics[_nb_symbols*depth + out_symbol];
+    }
+
+    /**
+     * Get a pointer to the metrics of one column
+     */
+    const float *get_column(unsigned int depth) const
+    {
+        return &_metrics[_nb_symbols*depth];
+    }
+
+    /**
+     * Base 2 logarithm of a reliability value as used by the sequential decoders, in single precision. The mantissa is
+     * reduced to [sqrt(2)/2,sqrt(2)] and log(1+f) is evaluated as 2*atanh(f/(2+f)) with five terms of the series. The
+     * result is within a few units in the last place of log(x)/log(2) computed in double precision. Zero gives minus
+     * infinity as with log(). init() runs the same steps on four values at a time when SSE2 is available.
+     * \param x Reliability value (non negative and finite)
+     */
+    static float log2_reliability(float x)
+    {
+        uint32_t bits;
+        memcpy(&bits, &x, sizeof(bits));
+
+        if ((bits & 0x7fffffff) == 0)
+        {
+            return -INFINITY;
+        }
+
+        bool denormal = (bits & 0x7f800000) == 0;
+        float scaled = x * (denormal ? 8388608.0f : 1.0f); // denormals are scaled by 2^23 first
+        memcpy(&bits, &scaled, sizeof(bits));
+        bool upper = (bits & 0x7fffff) > 0x3504f3; // mantissa above sqrt(2) is halved
+        int exponent = (int) ((bits >> 23) & 0xff) - 127 - (denormal ? 23 : 0) + (upper ? 1 : 0);
+        bits = (bits & 0x7fffff) | (upper ? 0x3f000000 : 0x3f800000);
+        float mantissa;
+        memcpy(&mantissa, &bits, sizeof(mantissa));
+        float f = mantissa - 1.0f;
+        float s = f / (2.0f + f);
+        float s2 = s*s;
+        float ln = s * (2.0f + s2*(2.0f/3.0f + s2*(2.0f/5.0f + s2*(2.0f/7.0f + s2*(2.0f/9.0f)))));
+        return exponent + ln * 1.44269504f; // 1/log(2)
+    }
+
+protected:
+    unsigned int _nb_symbols;
+    unsigned int _message_length;
+    std::vector<float> _metrics; //!< Biased log2 reliabilities stored column first
+};
+
+} // namespace ccsoft
+
+#endif // __CC_EDGE_METRICS_H__
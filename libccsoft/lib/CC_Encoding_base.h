@@ -71,6 +71,26 @@ void print_symbol(const T_IOSymbol& sym, std::ostream& os)
 template<>
 void print_symbol<unsigned char>(const unsigned char& sym, std::ostream& os);
 
+/**
+ * Parity of a 64 bit word. Uses the hardware population count when available.
+ * \param w Word
+ * \return true if the number of bits set is odd
+ */
+inline bool parity64(unsigned long long w)
+{
+#ifdef __GNUC__
+    return __builtin_parityll(w);
+#else
+    w ^= w >> 32;
+    w ^= w >> 16;
+    w ^= w >> 8;
+    w ^= w >> 4;
+    w ^= w >> 2;
+    w ^= w >> 1;
+    return (w & 1) != 0;
+#endif
+}
+
 /**
  * Calculate the Convolutional Coding parameters (n,k,m factors)
  */
@@ -182,6 +202,29 @@ public:
         {
             throw CCSoft_Exception("Number of output bits not supported by I/O symbol type");
         }
+
+        // layout of the registers in the packed state: register 0 in the least significant bits
+        total_register_length = 0;
+
+        for (unsigned int ci=0; ci < k; ci++)
+        {
+            register_shifts.push_back(total_register_length);
+            register_masks.push_back(constraints[ci] < sizeof(T_Register)*8 ? (((T_Register) 1) << constraints[ci]) - 1 : ~((T_Register) 0));
+            total_register_length += constraints[ci];
+
+            for (unsigned int ni=0; ni < n; ni++)
+            {
+                if (genpoly_representations[ci][ni] & ~register_masks[ci])
+                {
+                    throw CCSoft_Exception("One generator polynomial is larger than its constraint size");
+                }
+            }
+        }
+
+        if (total_register_length <= 8*sizeof(unsigned long long))
+        {
+            init_packed_tables();
+        }
     }
 
     //=============================================================================================
@@ -240,6 +283,250 @@ public:
         return true;
     }
 
+    //=============================================================================================
+    /**
+     * Encode a whole bit packed message in one call. The result is identical to calling encode() on each symbol in
+     * sequence: encoding starts from the current registers and leaves the registers as they would be after the last
+     * symbol. Each input bit is processed as a separate bit stream so that 64 consecutive output bits of an output
+     * bit position are obtained with one shift and one XOR per generator polynomial tap (bit slicing across time).
+     * \param in_packed Input message. Symbol i occupies bits i*k to i*k+k-1, least significant bit of the first byte first.
+     * \param nb_symbols Number of input symbols in the message
+     * \param out_packed Output symbols. Symbol i occupies bits i*n to i*n+n-1, least significant bit of the first byte first.
+     * Resized to hold all output symbols.
+     * \param zero_tail Append m-1 zero symbols to the message to bring the registers back to the zero state
+     * \return Number of output symbols
+     */
+    unsigned int encode_bulk(const unsigned char *in_packed,
+            unsigned int nb_symbols,
+            std::vector<unsigned char>& out_packed,
+            bool zero_tail = false)
+    {
+        static const unsigned int history_length = 8*sizeof(T_Register); // register bits preceding the message
+        unsigned int nb_out_symbols = nb_symbols + (zero_tail ? m-1 : 0);
+        unsigned int nb_words = (nb_out_symbols + 63) / 64;
+        unsigned int nb_stream_words = (history_length + 64*nb_words) / 64 + 2; // room for unaligned windows
+        std::vector<std::vector<unsigned long long> > in_streams(k, std::vector<unsigned long long>(nb_stream_words, 0));
+
+        // input bit streams: bit position p holds register bit history_length-1-p for p < history_length and
+        // the input bit of symbol p-history_length after
+        for (unsigned int ki=0; ki<k; ki++)
+        {
+            std::vector<unsigned long long>& in_stream = in_streams[ki];
+            T_Register reg = get_register(ki);
+
+            for (unsigned int i=0; i<history_length; i++)
+            {
+                in_stream[(history_length-1-i) / 64] |= ((unsigned long long) ((reg >> i) & 1)) << ((history_length-1-i) % 64);
+            }
+
+            if (k == 1) // the message is already the bit stream and history is a whole number of bytes
+            {
+                for (unsigned int bi=0; bi<nb_symbols/8; bi++)
+                {
+                    unsigned int byte_index = history_length/8 + bi;
+                    in_stream[byte_index / 8] |= ((unsigned long long) in_packed[bi]) << (8*(byte_index % 8));
+                }
+
+                for (unsigned int si=8*(nb_symbols/8); si<nb_symbols; si++)
+                {
+                    unsigned int p = history_length + si;
+                    in_stream[p / 64] |= ((unsigned long long) ((in_packed[si / 8] >> (si % 8)) & 1)) << (p % 64);
+                }
+            }
+            else
+            {
+                for (unsigned int si=0; si<nb_symbols; si++)
+                {
+                    unsigned int in_bit_index = si*k + ki;
+                    unsigned int p = history_length + si;
+                    in_stream[p / 64] |= ((unsigned long long) ((in_packed[in_bit_index / 8] >> (in_bit_index % 8)) & 1)) << (p % 64);
+                }
+            }
+        }
+
+        // output bit streams computed 64 symbols at a time
+        out_packed.assign((nb_out_symbols*n + 7) / 8, 0);
+        std::vector<unsigned long long> out_words(n);
+
+        for (unsigned int wi=0; wi<nb_words; wi++)
+        {
+            for (unsigned int ni=0; ni<n; ni++)
+            {
+                unsigned long long out_word = 0;
+
+                for (unsigned int ki=0; ki<k; ki++)
+                {
+                    T_Register genpoly = genpoly_representations[ki][ni];
+
+                    for (unsigned int tap=0; genpoly != 0; tap++, genpoly >>= 1)
+                    {
+                        if (genpoly & 1) // output bit of symbol t gets the input bit of symbol t-tap
+                        {
+                            out_word ^= get_stream_window(in_streams[ki], history_length + 64*wi - tap);
+                        }
+                    }
+                }
+
+                out_words[ni] = out_word;
+            }
+
+            unsigned int nb_word_symbols = (nb_out_symbols - 64*wi < 64 ? nb_out_symbols - 64*wi : 64);
+
+            if (n == 2) // interleave the two output streams with bit spreading
+            {
+                unsigned long long word_mask = (nb_word_symbols == 64 ? ~0ULL : (1ULL << nb_word_symbols) - 1);
+                unsigned long long out_stream_0 = out_words[0] & word_mask;
+                unsigned long long out_stream_1 = out_words[1] & word_mask;
+                unsigned long long interleaved[2];
+                interleaved[0] = spread_bits((unsigned int) out_stream_0) | (spread_bits((unsigned int) out_stream_1) << 1);
+                interleaved[1] = spread_bits((unsigned int) (out_stream_0 >> 32)) | (spread_bits((unsigned int) (out_stream_1 >> 32)) << 1);
+
+                for (unsigned int bi=0; (bi < 16) && (16*wi + bi < out_packed.size()); bi++)
+                {
+                    out_packed[16*wi + bi] = (unsigned char) (interleaved[bi / 8] >> (8*(bi % 8)));
+                }
+            }
+            else
+            {
+                for (unsigned int ti=0; ti<nb_word_symbols; ti++)
+                {
+                    for (unsigned int ni=0; ni<n; ni++)
+                    {
+                        unsigned int out_bit_index = (64*wi + ti)*n + ni;
+                        out_packed[out_bit_index / 8] |= ((out_words[ni] >> ti) & 1) << (out_bit_index % 8);
+                    }
+                }
+            }
+        }
+
+        // registers as left by the last symbol
+        for (unsigned int ki=0; ki<k; ki++)
+        {
+            T_Register reg = 0;
+
+            for (unsigned int i=0; i<history_length; i++)
+            {
+                unsigned int p = history_length + nb_out_symbols - 1 - i;
+                reg |= ((T_Register) ((in_streams[ki][p / 64] >> (p % 64)) & 1)) << i;
+            }
+
+            get_register(ki) = reg;
+        }
+
+        return nb_out_symbols;
+    }
+
+    //=============================================================================================
+    /**
+     * Get the state of the encoder as a single integer. Each register is truncated to its constraint length and the
+     * registers are concatenated, register 0 in the least significant bits. Only valid if the total register length
+     * does not exceed 64 bits.
+     */
+    unsigned long long get_packed_state()
+    {
+        unsigned long long state = 0;
+
+        for (unsigned int ki=0; ki<k; ki++)
+        {
+            state |= ((unsigned long long) (get_register(ki) & register_masks[ki])) << register_shifts[ki];
+        }
+
+        return state;
+    }
+
+    //=============================================================================================
+    /**
+     * Set the state of the encoder from a single integer as returned by get_packed_state()
+     * \param state Packed state
+     */
+    void set_packed_state(unsigned long long state)
+    {
+        for (unsigned int ki=0; ki<k; ki++)
+        {
+            get_register(ki) = ((T_Register) (state >> register_shifts[ki])) & register_masks[ki];
+        }
+    }
+
+    //=============================================================================================
+    /**
+     * Get the packed state following a packed state when a new symbol is clocked in. Does not change the encoder
+     * registers. Only valid if the total register length does not exceed 64 bits.
+     * \param state Packed state before the symbol is clocked in
+     * \param in_symbol Input symbol
+     * \return Packed state after the symbol is clocked in
+     */
+    unsigned long long get_next_packed_state(unsigned long long state, const T_IOSymbol& in_symbol) const
+    {
+        if (input_deposits.size() > 0)
+        {
+            return ((state << 1) & shift_mask) | input_deposits[in_symbol];
+        }
+        else
+        {
+            return ((state << 1) & shift_mask) | deposit_input(in_symbol);
+        }
+    }
+
+    //=============================================================================================
+    /**
+     * Get a packed state preceding a packed state i.e. one of the states from which the given state is reached when
+     * its last input symbol is clocked in. The bits shifted out of the registers are not known from the given state and
+     * are supplied by the caller. Only valid if the total register length does not exceed 64 bits.
+     * \param state Packed state after the symbol is clocked in
+     * \param high_bits Bit ki is the most significant bit of register ki in the preceding state
+     * \return Preceding packed state
+     */
+    unsigned long long get_previous_packed_state(unsigned long long state, const T_IOSymbol& high_bits) const
+    {
+        unsigned long long previous_state = (state >> 1) & unshift_mask;
+
+        for (unsigned int ki=0; ki<k; ki++)
+        {
+            previous_state |= ((unsigned long long) ((high_bits >> ki) & 1)) << (register_shifts[ki] + constraints[ki] - 1);
+        }
+
+        return previous_state;
+    }
+
+    //=============================================================================================
+    /**
+     * Get the last input symbol clocked in to reach a packed state. Only valid if the total register length does not
+     * exceed 64 bits.
+     * \param state Packed state
+     * \return Input symbol
+     */
+    T_IOSymbol get_input_symbol(unsigned long long state) const
+    {
+        T_IOSymbol in_symbol = 0;
+
+        for (unsigned int ki=0; ki<k; ki++)
+        {
+            in_symbol |= ((T_IOSymbol) ((state >> register_shifts[ki]) & 1)) << ki;
+        }
+
+        return in_symbol;
+    }
+
+    //=============================================================================================
+    /**
+     * Get the output symbol of a packed state i.e. the output symbol produced when the last input symbol was clocked in.
+     * It is a single lookup when the total register length is small enough for the output table (see output_table_max_bits).
+     * Only valid if the total register length does not exceed 64 bits.
+     * \param state Packed state
+     * \return Output symbol
+     */
+    T_IOSymbol get_output_symbol(unsigned long long state) const
+    {
+        if (output_table.size() > 0)
+        {
+            return output_table[state];
+        }
+        else
+        {
+            return compute_output_symbol(state);
+        }
+    }
+
     //=============================================================================================
     /**
      * Prints encoding characteristics to an output stream
@@ -247,7 +534,7 @@ public:
      */
     void print(std::ostream& os)
     {
-        std::cout << "k=" << k << ", n=" << n << ", m=" << m << std::endl;
+        os << "k=" << k << ", n=" << n << ", m=" << m << std::endl;
 
         for (unsigned int ci=0; ci<k; ci++)
         {
@@ -287,31 +574,151 @@ public:
         return m;
     }
 
+    /**
+     * Get the sum of all register lengths i.e. the number of bits of the packed state
+     */
+    unsigned int get_total_register_length() const
+    {
+        return total_register_length;
+    }
+
 protected:
 
     /**
-     * XOR all bits in a register. Uses the bit counting method.
+     * XOR all bits in a register
      * \tparam T_Register Type of register
      * \param reg Register
      * \return true=1 or false=0
      */
     bool xorbits(const T_Register& reg)
     {
-        T_Register w_reg = reg;
-        unsigned int nb_ones = 0;
+        return parity64((unsigned long long) reg);
+    }
+
+    /**
+     * Get 64 consecutive bits of a bit stream
+     * \param stream Bit stream
+     * \param bit_index Index of the first bit
+     */
+    static unsigned long long get_stream_window(const std::vector<unsigned long long>& stream, unsigned int bit_index)
+    {
+        unsigned int word_index = bit_index / 64;
+        unsigned int shift = bit_index % 64;
 
-        while(w_reg != 0)
+        if (shift == 0)
         {
-            nb_ones += w_reg % 2;
-            w_reg /= 2;
+            return stream[word_index];
         }
+        else
+        {
+            return (stream[word_index] >> shift) | (stream[word_index+1] << (64 - shift));
+        }
+    }
 
-        return (nb_ones % 2) == 1;
+    /**
+     * Spread the 32 bits of a word to the even bit positions of a 64 bit word
+     */
+    static unsigned long long spread_bits(unsigned int w)
+    {
+        unsigned long long x = w;
+        x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+        x = (x | (x << 8))  & 0x00FF00FF00FF00FFULL;
+        x = (x | (x << 4))  & 0x0F0F0F0F0F0F0F0FULL;
+        x = (x | (x << 2))  & 0x3333333333333333ULL;
+        x = (x | (x << 1))  & 0x5555555555555555ULL;
+        return x;
     }
 
+    /**
+     * Initialize the packed generator polynomials and the lookup tables used with packed states
+     */
+    void init_packed_tables()
+    {
+        shift_mask = 0;
+        unshift_mask = 0;
+
+        for (unsigned int ki=0; ki<k; ki++)
+        {
+            unsigned long long register_mask = ((unsigned long long) register_masks[ki]) << register_shifts[ki];
+            shift_mask |= register_mask & ~(1ULL << register_shifts[ki]); // bit 0 of each register receives the input
+            unshift_mask |= register_mask & ~(1ULL << (register_shifts[ki] + constraints[ki] - 1)); // the most significant bit is unknown when shifting back
+        }
+
+        packed_genpolys.assign(n, 0);
+
+        for (unsigned int ni=0; ni<n; ni++)
+        {
+            for (unsigned int ki=0; ki<k; ki++)
+            {
+                packed_genpolys[ni] |= ((unsigned long long) genpoly_representations[ki][ni]) << register_shifts[ki];
+            }
+        }
+
+        if (k <= input_deposits_max_bits)
+        {
+            input_deposits.resize(1<<k);
+
+            for (unsigned int in_symbol=0; in_symbol < (1U<<k); in_symbol++)
+            {
+                input_deposits[in_symbol] = deposit_input((T_IOSymbol) in_symbol);
+            }
+        }
+
+        if (total_register_length <= output_table_max_bits)
+        {
+            output_table.resize(1<<total_register_length);
+
+            for (unsigned int state=0; state < (1U<<total_register_length); state++)
+            {
+                output_table[state] = compute_output_symbol(state);
+            }
+        }
+    }
+
+    /**
+     * Spread the bits of an input symbol to the least significant bit of each register in the packed state
+     */
+    unsigned long long deposit_input(const T_IOSymbol& in_symbol) const
+    {
+        unsigned long long deposit = 0;
+
+        for (unsigned int ki=0; ki<k; ki++)
+        {
+            deposit |= ((unsigned long long) ((in_symbol >> ki) & 1)) << register_shifts[ki];
+        }
+
+        return deposit;
+    }
+
+    /**
+     * Compute the output symbol of a packed state with one parity per output bit
+     */
+    T_IOSymbol compute_output_symbol(unsigned long long state) const
+    {
+        T_IOSymbol out_symbol = 0;
+
+        for (unsigned int ni=0; ni<n; ni++)
+        {
+            out_symbol |= ((T_IOSymbol) (parity64(state & packed_genpolys[ni]) ? 1 : 0)) << ni;
+        }
+
+        return out_symbol;
+    }
+
+    static const unsigned int output_table_max_bits = 16; //!< Maximum total register length for which the output table is built
+    static const unsigned int input_deposits_max_bits = 8; //!< Maximum k for which the input deposits table is built
+
     unsigned int k; //!< Number of input bits or input symbol size in bits
     unsigned int n; //!< Number of output bits or output symbol size in bits
     unsigned int m; //!< Maximum register length
+    unsigned int total_register_length; //!< Sum of all register lengths
+    std::vector<unsigned int> register_shifts; //!< Position of each register in the packed state
+    std::vector<T_Register> register_masks; //!< Mask of the significant bits of each register
+    unsigned long long shift_mask; //!< Bits of the packed state kept when the registers are shifted
+    unsigned long long unshift_mask; //!< Bits of the packed state kept when the registers are shifted back
+    std::vector<unsigned long long> packed_genpolys; //!< Generator polynomials of each output bit in the packed state layout
+    std::vector<unsigned long long> input_deposits; //!< Input symbol bits spread in the packed state layout by input symbol
+    std::vector<T_IOSymbol> output_table; //!< Output symbol by packed state
     std::vector<unsigned int> constraints; //!< As many constraints as there are inputs
     std::vector<std::vector<T_Register> > genpoly_representations; //!< As many generator polynomials vectors (the size of the number of outputs) as there are inputs
 };
@@ -33,6 +33,7 @@
 #include "CCSoft_Exception.h"
 #include "CC_TreeNodeEdge_FA.h"
 #include "CC_ReliabilityMatrix.h"
+#include "CC_TreeNodeEdgeCache.h"
 #include "Debug.h"
 
 #include <cmath>
@@ -45,7 +46,10 @@ namespace ccsoft
 {
 
 /**
- * \brief The Fano like Decoding class. Tag is a boolean used as the traversed back indicator.
+ * \brief The Fano like Decoding class. The node+edge flag is used as the traversed back indicator.
+ * The outgoing node+edge slots of a node are sorted by decreasing path metric when the successors are created so
+ * that slots hold successors by rank rather than by input symbol. Successors traversed back always form a prefix
+ * of the ranks hence the next best successor is the first one not traversed back.
  * This version uses fixed arrays to store registers and forward node+edges pointers.
  * N_k template parameter gives the size of the input symbol (k parameter) and therefore the number of registers.
  * There are (1<<N_k) forward node+edges.
@@ -54,7 +58,7 @@ namespace ccsoft
  * \tparam N_k Size of an input symbol in bits (k parameter)
  */
 template<typename T_Register, typename T_IOSymbol, unsigned int N_k>
-class CC_FanoDecoding_FA : public CC_SequentialDecoding_FA<T_Register, T_IOSymbol, N_k> ,public CC_SequentialDecodingInternal_FA<T_Register, T_IOSymbol, bool, N_k>
+class CC_FanoDecoding_FA : public CC_SequentialDecoding_FA<T_Register, T_IOSymbol, N_k> ,public CC_SequentialDecodingInternal_FA<T_Register, T_IOSymbol, CC_TreeNodeEdgeTag_Empty, N_k>
 {
 public:
     /**
@@ -67,7 +71,8 @@ public:
      * of generators should follow the same convention.
      * \param _init_threshold Initial path metric threshold
      * \param _delta_threshold Delta of path metric that is applied when lowering threshold
-     * \param _tree_cache_size Tree cache maximum size in number of nodes (0 if not used)
+     * \param _tree_cache_size Tree cache maximum size in number of nodes (0 if not used). When used the successors of
+     * the least recently used nodes are released to stay within the size.
      * \param _delta_init_threshold: Delta of path metric that is applied when restarting with a lower initial threshold (0 if not used)
      */
 	CC_FanoDecoding_FA(const std::vector<unsigned int>& constraints,
@@ -77,7 +82,8 @@ public:
             unsigned int _tree_cache_size = 0,
             float _delta_init_threshold = 0.0) :
                 CC_SequentialDecoding_FA<T_Register, T_IOSymbol, N_k>(constraints, genpoly_representations),
-                CC_SequentialDecodingInternal_FA<T_Register, T_IOSymbol, bool, N_k>(),
+                CC_SequentialDecodingInternal_FA<T_Register, T_IOSymbol, CC_TreeNodeEdgeTag_Empty, N_k>(),
+                start_threshold(_init_threshold),
                 init_threshold(_init_threshold),
                 cur_threshold(_init_threshold),
                 root_threshold(_init_threshold),
@@ -85,9 +91,13 @@ public:
                 solution_found(false),
                 effective_node_count(0),
                 nb_moves(0),
-                tree_cache_size(_tree_cache_size),
+                nb_threshold_changes(0),
+                tree_cache(_tree_cache_size),
                 unloop(_delta_init_threshold < 0.0),
-                delta_init_threshold(_delta_init_threshold)
+                delta_init_threshold(_delta_init_threshold),
+                best_partial_depth(-1),
+                best_partial_metric(0.0),
+                best_partial_synced(0)
     {}
 
     /**
@@ -102,7 +112,7 @@ public:
      */
     void set_tree_cache_size(unsigned int _tree_cache_size)
     {
-        tree_cache_size = _tree_cache_size;
+        tree_cache.set_max_nodes(_tree_cache_size);
     }
     
     /**
@@ -112,9 +122,14 @@ public:
     {
         ParentInternal::reset();
         Parent::reset();
+        init_threshold = start_threshold; // undo the lowerings of the previous decode
         cur_threshold = init_threshold;
+        root_threshold = init_threshold;
         solution_found = false;
         effective_node_count = 0;
+        nb_threshold_changes = 0;
+        tree_cache.reset();
+        reset_best_partial_path();
     }
 
     /**
@@ -138,6 +153,9 @@ public:
         }
 
         reset();
+        CC_DecodingBudgetScope budget_scope(Parent::budget);
+        ParentInternal::init_edge_metrics(relmat, Parent::edge_bias);
+        best_partial_path.resize(relmat.get_message_length());
         ParentInternal::init_root(); // initialize root node
         Parent::node_count++;
         effective_node_count++;
@@ -162,33 +180,23 @@ public:
             	Parent::max_depth = node_edge_current->get_depth();
             }
 
+            update_best_partial_path(node_edge_current);
+
             if (node_edge_current == ParentInternal::root_node)
             {
                 root_threshold = cur_threshold;
             }
 
             nb_moves++;
-            const std::array<FanoNodeEdge*, (1<<N_k)>& outgoing_node_edges = node_edge_current->get_outgoing_node_edges();
-            typename std::array<FanoNodeEdge*, (1<<N_k)>::const_iterator ne_it = outgoing_node_edges.begin();
-            std::vector<FanoNodeEdge*> child_node_edges;
-
-            for (; ne_it != outgoing_node_edges.end(); ++ne_it)
-            {
-                if ((*ne_it) && !((*ne_it)->get_tag())) // not traversed back
-                {
-                    child_node_edges.push_back(*ne_it);
-                }
-            }
+            node_edge_successor = get_best_successor(node_edge_current);
 
-            if (child_node_edges.size() == 0) // exhausted forward paths
+            if (!node_edge_successor) // exhausted forward paths
             {
                 DEBUG_OUT(Parent::verbosity > 2, "exhaustion of forward paths at node #" << node_edge_current->get_id() << std::endl);
                 node_edge_current = move_back_from_node_or_loosen_threshold(node_edge_current);
                 continue;
             }
 
-            std::sort(child_node_edges.begin(), child_node_edges.end(), node_edge_pointer_ordering<FanoNodeEdge>);
-            node_edge_successor = *child_node_edges.begin(); // best successor
             DEBUG_OUT(Parent::verbosity > 2, "best successor node #" << node_edge_successor->get_id() << " Ms=" << node_edge_successor->get_path_metric() << std::endl);
 
             if (node_edge_successor->get_path_metric() >= cur_threshold) // Ms >= T
@@ -198,6 +206,11 @@ public:
                 FanoNodeEdge *node_predecessor = node_edge_current;
                 node_edge_current = node_edge_successor;
 
+                if (node_edge_current->get_depth() < best_partial_synced) // the current path leaves the saved best path
+                {
+                    best_partial_synced = node_edge_current->get_depth();
+                }
+
                 // termination with solution
                 if (node_edge_current->get_depth() == relmat.get_message_length() - 1)
                 {
@@ -226,6 +239,7 @@ public:
                     	cur_threshold = (nb_delta * delta_threshold) + init_threshold;
                     }
 
+                    nb_threshold_changes++;
                     DEBUG_OUT(Parent::verbosity > 2, "tightening " << node_edge_current->get_path_metric() << " -> " << cur_threshold << std::endl);
                 }
 
@@ -238,9 +252,23 @@ public:
             }
         }
 
+        decoded_message.assign(best_partial_path.begin(), best_partial_path.begin() + (best_partial_depth + 1)); // give up with the best path reached
         return false;
     }
 
+    /**
+     * Get the effort statistics of the last decode
+     */
+    virtual CC_DecodeStats get_decode_stats() const
+    {
+        CC_DecodeStats stats = Parent::get_decode_stats();
+        stats.nb_effective_nodes = effective_node_count;
+        stats.nb_moves = nb_moves;
+        stats.nb_threshold_changes = nb_threshold_changes;
+        stats.nb_cache_evictions = tree_cache.get_nb_evictions();
+        return stats;
+    }
+
     /**
      * Print stats to an output stream
      * \param os Output stream
@@ -248,12 +276,15 @@ public:
      */
     virtual void print_stats(std::ostream& os, bool success)
     {
-        std::cout << "score = " << Parent::get_score()
+        os << "score = " << Parent::get_score()
                 << " cur.threshold = " << cur_threshold
                 << " nodes = " << Parent::get_nb_nodes()
                 << " eff.nodes = " << effective_node_count
                 << " moves = " << nb_moves
-                << " max depth = " << Parent::get_max_depth();
+                << " max depth = " << Parent::get_max_depth()
+                << " cache hits/misses/evictions = " << tree_cache.get_nb_hits()
+                << "/" << tree_cache.get_nb_misses()
+                << "/" << tree_cache.get_nb_evictions();
     }
 
     /**
@@ -263,7 +294,7 @@ public:
      */
     virtual void print_stats_summary(std::ostream& os, bool success)
     {
-        std::cout << "_RES " << (success ? 1 : 0) << ","
+        os << "_RES " << (success ? 1 : 0) << ","
                 << Parent::get_score() << ","
                 << cur_threshold << ","
                 << Parent::get_nb_nodes() << ","
@@ -283,8 +314,8 @@ public:
 
 protected:
     typedef CC_SequentialDecoding_FA<T_Register, T_IOSymbol, N_k> Parent; //!< Parent class this class inherits from
-    typedef CC_SequentialDecodingInternal_FA<T_Register, T_IOSymbol, bool, N_k> ParentInternal; //!< Parent class this class inherits from
-    typedef CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, bool, N_k> FanoNodeEdge;   //!< Class of code tree nodes in the Fano algorithm
+    typedef CC_SequentialDecodingInternal_FA<T_Register, T_IOSymbol, CC_TreeNodeEdgeTag_Empty, N_k> ParentInternal; //!< Parent class this class inherits from
+    typedef CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, CC_TreeNodeEdgeTag_Empty, N_k> FanoNodeEdge;   //!< Class of code tree nodes in the Fano algorithm
 
     /**
      * Visit a new node
@@ -298,11 +329,7 @@ protected:
         T_IOSymbol out_symbol;
         T_IOSymbol end_symbol;
 
-        // return encoder to appropriate state
-        if (node_edge->get_depth() >= 0) // does not concern the root node_edge
-        {
-            Parent::encoding.set_registers(node_edge->get_registers());
-        }
+        unsigned long long state = node_edge->get_state(); // encoder state at this node
 
         if ((Parent::tail_zeros) && (forward_depth > relmat.get_message_length()-Parent::encoding.get_m()))
         {
@@ -315,24 +342,88 @@ protected:
 
         if (!node_edge->valid_outgoing_node_edges(end_symbol)) // edges are not cached
         {
-            if ((tree_cache_size > 0) && (effective_node_count >= tree_cache_size)) // if tree cache is used and cache limit reached
+            if (tree_cache.get_max_nodes() > 0) // if tree cache is used evict least recently used nodes before allocating new nodes
             {
-                purge_tree_cache(node_edge); // purge before allocating new nodes
+                effective_node_count -= tree_cache.make_room(ParentInternal::node_edge_pool, effective_node_count, end_symbol, node_edge, nb_moves);
             }
 
             // loop through assumption for this symbol place and create child nodes
             for (T_IOSymbol in_symbol = 0; in_symbol < end_symbol; in_symbol++)
             {
-                Parent::encoding.encode(in_symbol, out_symbol, in_symbol > 0); // step only for a new symbol place
-                float edge_metric = ParentInternal::log2(relmat(out_symbol, forward_depth)) - Parent::edge_bias;
+                unsigned long long forward_state = Parent::encoding.get_next_packed_state(state, in_symbol);
+                out_symbol = Parent::encoding.get_output_symbol(forward_state);
+                float edge_metric = ParentInternal::edge_metrics(out_symbol, forward_depth);
                 float forward_path_metric = edge_metric + node_edge->get_path_metric();
-                FanoNodeEdge *next_node_edge = new FanoNodeEdge(Parent::node_count++, node_edge, in_symbol, edge_metric, forward_path_metric, forward_depth);
-                next_node_edge->get_tag() = false; // Init traversed back indicator
-                next_node_edge->set_registers(Parent::encoding.get_registers());
-                node_edge->set_outgoing_node_edge(next_node_edge, in_symbol); // add forward edge
+                ParentInternal::new_node_edge(node_edge, in_symbol, forward_path_metric, forward_depth, forward_state); // add forward edge, traversed back indicator is cleared
+                Parent::node_count++;
                 effective_node_count++;
             }
+
+            sort_successors(node_edge, end_symbol);
+            tree_cache.miss(node_edge, nb_moves);
+        }
+        else // successors are cached: start again from the best one as if they had just been created
+        {
+            for (unsigned int i=0; i<(1<<N_k); i++)
+            {
+                FanoNodeEdge *successor = ParentInternal::get_outgoing_node_edge(node_edge, i);
+
+                if (successor)
+                {
+                    successor->set_flag(false);
+                }
+            }
+
+            tree_cache.hit(node_edge, nb_moves);
+        }
+    }
+
+    /**
+     * Sort the outgoing node+edge slots of a node by decreasing path metric then decreasing input symbol. There are
+     * at most 2^k successors so this is done by insertion.
+     * \param node_edge Node+edge whose successors have just been created
+     * \param nb_successors Number of successors created
+     */
+    void sort_successors(FanoNodeEdge *node_edge, unsigned int nb_successors)
+    {
+        for (unsigned int i=1; i<nb_successors; i++)
+        {
+            unsigned int successor_index = node_edge->get_outgoing_index(i);
+            FanoNodeEdge *successor = ParentInternal::node_edge_pool.get(successor_index);
+            unsigned int j = i;
+
+            for (; (j > 0) && node_edge_pointer_ordering(successor, ParentInternal::get_outgoing_node_edge(node_edge, j-1)); j--)
+            {
+                node_edge->set_outgoing_index(j, node_edge->get_outgoing_index(j-1));
+            }
+
+            node_edge->set_outgoing_index(j, successor_index);
+        }
+    }
+
+    /**
+     * Get the best successor not traversed back. Successors are sorted and the ones traversed back come first.
+     * \param node_edge Node+edge to get the successor from
+     * \return Pointer to the successor or 0 if all forward paths are exhausted
+     */
+    FanoNodeEdge *get_best_successor(FanoNodeEdge *node_edge) const
+    {
+        for (unsigned int i=0; i<(1<<N_k); i++)
+        {
+            FanoNodeEdge *successor = ParentInternal::get_outgoing_node_edge(node_edge, i);
+
+            if (!successor) // successors occupy the first slots
+            {
+                return 0;
+            }
+
+            if (!successor->get_flag()) // not traversed back
+            {
+                return successor;
+            }
         }
+
+        return 0;
     }
 
     /**
@@ -346,36 +437,36 @@ protected:
         if (node_edge_current == ParentInternal::root_node) // at root node there are no other options than loosening threshold
         {
             cur_threshold -= delta_threshold;
+            nb_threshold_changes++;
             DEBUG_OUT(Parent::verbosity > 2, "loosening " << node_edge_current->get_path_metric() << " -> " << cur_threshold << std::endl);
         }
         else
         {
-            FanoNodeEdge *node_edge_predecessor = node_edge_current->get_incoming_node_edge();
+            FanoNodeEdge *node_edge_predecessor = ParentInternal::get_incoming_node_edge(node_edge_current);
 
             if (node_edge_predecessor->get_path_metric() >= cur_threshold) // move backward
             {
                 DEBUG_OUT(Parent::verbosity > 2, std::cout << "backward" << std::endl);
 
-                if (tree_cache_size == 0) // tree cache is not used
+                if (tree_cache.get_max_nodes() == 0) // tree cache is not used
                 {
-                    // delete all successor edges and nodes
-                    std::array<FanoNodeEdge*, (1<<N_k)>& outgoing_node_edges = node_edge_current->get_outgoing_node_edges();
-                    typename std::array<FanoNodeEdge*, (1<<N_k)>::iterator ne_it = outgoing_node_edges.begin();
+                    // release all successor edges and nodes
+                    effective_node_count -= (1<<N_k);
 
-                    for (;ne_it != outgoing_node_edges.end(); ++ne_it)
+                    if (ParentInternal::node_edge_pool.release_successors(node_edge_current) > 0)
                     {
-                        delete *ne_it;
+                        tree_cache.count_eviction();
                     }
-
-                    effective_node_count -= outgoing_node_edges.size();
-                    std::fill(outgoing_node_edges.begin(), outgoing_node_edges.end(), (FanoNodeEdge*) 0);
-                    //outgoing_node_edges.fill(0);
+                }
+                else
+                {
+                    tree_cache.touch(node_edge_predecessor, nb_moves);
                 }
 
                 // mark incoming edge as traversed back
                 if (node_edge_predecessor != ParentInternal::root_node)
                 {
-                    node_edge_current->get_tag() = true;
+                    node_edge_current->set_flag();
                 }
 
                 // move back: change node address to previous node address
@@ -384,6 +475,7 @@ protected:
             else // loosen threshold
             {
                 cur_threshold -= delta_threshold;
+                nb_threshold_changes++;
                 DEBUG_OUT(Parent::verbosity > 2, "loosening " << node_edge_current->get_path_metric() << " -> " << cur_threshold << std::endl);
             }
         }
@@ -391,6 +483,44 @@ protected:
         return node_edge_current;
     }
 
+    /**
+     * Forget the best path reached
+     */
+    void reset_best_partial_path()
+    {
+        best_partial_depth = -1;
+        best_partial_metric = 0.0;
+        best_partial_synced = 0;
+    }
+
+    /**
+     * Save the path to the current node if it is the deepest reached so far or as deep with a better path metric. The
+     * path is kept as symbols because its nodes may be released later. Only the symbols past the common part with the
+     * previously saved path are copied so that the cost is at most one symbol per forward move.
+     * \param node_edge_current Current node
+     */
+    void update_best_partial_path(FanoNodeEdge *node_edge_current)
+    {
+        int depth = node_edge_current->get_depth();
+
+        if ((depth < best_partial_depth) || ((depth == best_partial_depth) && (node_edge_current->get_path_metric() <= best_partial_metric)))
+        {
+            return;
+        }
+
+        FanoNodeEdge *node_edge = node_edge_current;
+
+        for (int d = depth; d >= best_partial_synced; d--)
+        {
+            best_partial_path[d] = node_edge->get_in_symbol();
+            node_edge = ParentInternal::get_incoming_node_edge(node_edge);
+        }
+
+        best_partial_depth = depth;
+        best_partial_metric = node_edge_current->get_path_metric();
+        best_partial_synced = depth + 1;
+    }
+
     /**
      * Check if process can continue
      */
@@ -398,13 +528,13 @@ protected:
     {
         if ((node_edge_current == ParentInternal::root_node) && (nb_moves > 0) && (cur_threshold == root_threshold))
         {
-            const std::array<FanoNodeEdge*, (1<<N_k)>& outgoing_node_edges = node_edge_current->get_outgoing_node_edges();
-            typename std::array<FanoNodeEdge*, (1<<N_k)>::const_iterator ne_it = outgoing_node_edges.begin();
             bool children_open = true;
 
-            for (; ne_it != outgoing_node_edges.end(); ++ne_it)
+            for (unsigned int i=0; i<(1<<N_k); i++)
             {
-                if ((*ne_it)->get_tag()) // traversed back
+                FanoNodeEdge *node_edge_child = ParentInternal::get_outgoing_node_edge(node_edge_current, i);
+
+                if (node_edge_child && node_edge_child->get_flag()) // traversed back
                 {
                     children_open = false;
                     break;
@@ -418,18 +548,21 @@ protected:
                     init_threshold += delta_init_threshold; // lower initial threshold and start all over again (delta if used is negative)
                     Parent::reset();                        // reset but do not delete root node
                     cur_threshold = init_threshold;
+                    nb_threshold_changes++;
                     solution_found = false;
-                    ParentInternal::root_node->delete_outgoing_node_edges(); // effectively resets the root node without destroying it
+                    ParentInternal::node_edge_pool.release_successors(ParentInternal::root_node); // effectively resets the root node without destroying it
+                    tree_cache.reset();
+                    reset_best_partial_path();
                     Parent::node_count = 1;
                     effective_node_count = 1;
                     nb_moves = 0;
                     visit_node_forward(node_edge_current, relmat); // visit root node again
-                    std::cerr << "Loop condition detected, restart with init threshold = " << init_threshold << std::endl;
+                    DEBUG_OUT(Parent::verbosity > 0, "Loop condition detected, restart with init threshold = " << init_threshold << std::endl);
                     return true;
                 }
                 else
                 {
-                    std::cerr << "Loop condition detected, aborting" << std::endl;
+                    Parent::status = CC_Decoding_Loop;
                     return false;
                 }
             }
@@ -437,68 +570,36 @@ protected:
 
         if ((Parent::use_metric_limit) && (cur_threshold < Parent::metric_limit))
         {
-            std::cerr << "Metric limit encountered" << std::endl;
+            Parent::status = CC_Decoding_MetricLimit;
             return false;
         }
 
         if ((Parent::use_node_limit) && (Parent::node_count > Parent::node_limit))
         {
-            std::cerr << "Node limit exhausted" << std::endl;
+            Parent::status = CC_Decoding_NodeLimit;
             return false;
         }
 
-        return true;
-    }
-
-    /**
-     * Purge tree cache from a node. Keep only the current path to the node and path nodes immediate successors
-     * \param node The node to purge from
-     */
-    void purge_tree_cache(FanoNodeEdge *node_edge)
-    {
-        bool node_terminal = true;
-        unsigned int remaining_nodes = 0;
-
-        while (node_edge != ParentInternal::root_node)
-        {
-            FanoNodeEdge *node_edge_predecessor = node_edge->get_incoming_node_edge();
-            std::array<FanoNodeEdge*, (1<<N_k)>& outgoing_node_edges = node_edge_predecessor->get_outgoing_node_edges();
-            typename std::array<FanoNodeEdge*, (1<<N_k)>::iterator ne_it = outgoing_node_edges.begin();
-
-            for (;ne_it != outgoing_node_edges.end(); ++ne_it)
-            {
-                if (*ne_it) // if using trailing zeros the corresponding edges for input symbol not zero are not constructed
-                {
-                    FanoNodeEdge *node_edge_sibling = (*ne_it);
-
-                    if (node_terminal || (node_edge_sibling != node_edge))
-                    {
-                        (*ne_it)->delete_outgoing_node_edges();
-                    }
-
-                    remaining_nodes++;
-                }
-            }
-
-            node_edge = node_edge_predecessor;
-            node_terminal = false;
-        }
-
-        remaining_nodes++; // +1 for root node
-        effective_node_count = remaining_nodes;
-        DEBUG_OUT(Parent::verbosity > 1, "purged tree cache, nb of remaining nodes = " << remaining_nodes << std::endl);
+        Parent::status = Parent::budget.move();
+        return Parent::status == CC_Decoding_Success;
     }
 
-    float init_threshold;              //!< Initial path metric threshold
+    float start_threshold;             //!< Initial path metric threshold at the start of each decode
+    float init_threshold;              //!< Initial path metric threshold. Lowered when restarting on loop.
     float cur_threshold;               //!< Current path metric threshold
     float delta_threshold;             //!< Delta of path metric that is applied when lowering threshold
     bool solution_found;               //!< Set to true when eligible terminal node is found
     unsigned int effective_node_count; //!< Count of nodes effectively present in the system
     unsigned int nb_moves;             //!< Number of moves i.e. number of iterations in the main loop
+    unsigned int nb_threshold_changes; //!< Number of threshold tightenings and loosenings
     float root_threshold;              //!< Latest threshold at root node
-    unsigned int tree_cache_size;      //!< Tree cache size in maximum number of nodes in cache (0 = tree is not cached)
+    CC_TreeNodeEdgeCache<FanoNodeEdge> tree_cache; //!< Bounded cache of expanded nodes (maximum size 0 = tree is not cached)
     bool unloop;                       //!< If true when a loop condition is detected attempt to restart with a lower threshold
     float delta_init_threshold;        //!< Delta of path metric that is applied when restarting with a lower initial threshold 
+    std::vector<T_IOSymbol> best_partial_path; //!< Input symbols of the best path reached, given back when the decode fails
+    int best_partial_depth;            //!< Depth of the end node of the best path reached. -1 if none.
+    float best_partial_metric;         //!< Path metric of the end node of the best path reached
+    int best_partial_synced;           //!< Number of leading symbols of the best path that the current path shares
 };
 
 
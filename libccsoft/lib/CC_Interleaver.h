@@ -23,16 +23,78 @@
 #ifndef __CC_INTERLEAVER_H__
 #define __CC_INTERLEAVER_H__
 
-#include <cmath>
-#include <iostream>
+#include "CC_InterleaverPermutation.h"
+#include "CC_ReliabilityMatrix.h"
+
+#include <map>
+#include <vector>
 
 namespace ccsoft
 {
 
+/**
+ * \brief Interleaver. The permutation of each frame length met is computed on first use and cached so that
+ * interleaving and deinterleaving are in place and allocation free for a frame length that was already seen.
+ * Bit reversal interleaving is used by default.
+ * \tparam T_IOSymbol Type of the input and output symbols
+ */
 template<typename T_IOSymbol>
 class CC_Interleaver
 {
 public:
+    CC_Interleaver() :
+        interleaver_type(CC_Interleaver_BitReversal),
+        interleaver_nb_rows(1),
+        interleaver_delay(1)
+    {}
+
+    virtual ~CC_Interleaver()
+    {}
+
+    /**
+     * Use the bit reversal interleaver
+     */
+    void set_bit_reversal_interleaver()
+    {
+        set_interleaver(CC_Interleaver_BitReversal, 1, 1);
+    }
+
+    /**
+     * Use a block interleaver. Symbols are written row by row and read column by column.
+     * \param nb_rows Number of rows. The frame length must be a multiple of it.
+     */
+    void set_block_interleaver(unsigned int nb_rows)
+    {
+        set_interleaver(CC_Interleaver_Block, nb_rows, 1);
+    }
+
+    /**
+     * Use a convolutional interleaver whose delayed symbols wrap around the end of the frame
+     * \param nb_branches Number of branches. The frame length must be a multiple of it.
+     * \param delay Delay increment between branches in units of the number of branches
+     */
+    void set_convolutional_interleaver(unsigned int nb_branches, unsigned int delay)
+    {
+        set_interleaver(CC_Interleaver_Convolutional, nb_branches, delay);
+    }
+
+    /**
+     * Get the cached permutation for a frame length. It is computed on first use.
+     * \param length Number of symbols in the frame
+     */
+    const CC_InterleaverPermutation& get_permutation(unsigned int length)
+    {
+        std::map<unsigned int, CC_InterleaverPermutation>::iterator it = permutations.find(length);
+
+        if (it == permutations.end())
+        {
+            it = permutations.insert(std::make_pair(length,
+                    CC_InterleaverPermutation(interleaver_type, length, interleaver_nb_rows, interleaver_delay))).first;
+        }
+
+        return it->second;
+    }
+
     /**
      * Interleave/Deinterleave
      * \param symbols Symbols to process
@@ -40,43 +102,46 @@ public:
      */
     void interleave(std::vector<T_IOSymbol>& symbols, bool forward=true)
     {
-        std::vector<T_IOSymbol> tmp_symbols(symbols);
-        unsigned int index_size = (unsigned int) (log(symbols.size())/log(2)) + 1;
-        unsigned int index_max = 1<<index_size;
-        unsigned int new_index, s, iv;
-        unsigned int old_index = 0;
+        if (symbols.size() > 0)
+        {
+            get_permutation(symbols.size()).apply(&symbols[0], forward);
+        }
+    }
 
-        for (unsigned int i=0; (i<index_max) && (old_index<symbols.size()); i++)
+    /**
+     * Deinterleave the columns of a reliability matrix in place. Only one column is used as temporary storage.
+     * \param relmat Reliability matrix
+     * \param forward true to interleave, false (default) to deinterleave
+     */
+    void deinterleave(CC_ReliabilityMatrix& relmat, bool forward=false)
+    {
+        if (relmat.get_message_length() > 0)
+        {
+            tmp_column.resize(relmat.get_nb_symbols());
+            get_permutation(relmat.get_message_length()).apply_blocks(relmat.get_raw_matrix(), relmat.get_nb_symbols(), &tmp_column[0], forward);
+        }
+    }
+
+protected:
+    /**
+     * Change the interleaver and drop the cached permutations if it differs from the current one
+     */
+    void set_interleaver(CC_InterleaverType type, unsigned int nb_rows, unsigned int delay)
+    {
+        if ((type != interleaver_type) || (nb_rows != interleaver_nb_rows) || (delay != interleaver_delay))
         {
-            new_index = 0;
-            s = index_size;
-            iv = i;
-
-            for (; iv; iv >>= 1) // bit reversal
-            {
-                new_index |= iv & 1;
-                new_index <<= 1;
-                s--;
-            }
-
-            new_index >>= 1; // the last shift right was too much
-            new_index <<= s; // account for leading zeroes
-
-            if (new_index < symbols.size())
-            {
-                if (forward)
-                {
-                    symbols[new_index] = tmp_symbols[old_index];
-                }
-                else
-                {
-                	symbols[old_index] = tmp_symbols[new_index];
-                }
-
-                old_index++;
-            }
+            interleaver_type = type;
+            interleaver_nb_rows = nb_rows;
+            interleaver_delay = delay;
+            permutations.clear();
         }
     }
+
+    CC_InterleaverType interleaver_type;   //!< Interleaver type
+    unsigned int interleaver_nb_rows;      //!< Number of rows (block) or branches (convolutional)
+    unsigned int interleaver_delay;        //!< Delay increment between branches (convolutional)
+    std::map<unsigned int, CC_InterleaverPermutation> permutations; //!< Cached permutation by frame length
+    std::vector<float> tmp_column;         //!< Scratch column for reliability matrix deinterleaving
 };
 
 } // namespace ccsoft
@@ -0,0 +1,270 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Interleaver permutation of a given length computed once and applied in place
+
+ */
+#ifndef __CC_INTERLEAVER_PERMUTATION_H__
+#define __CC_INTERLEAVER_PERMUTATION_H__
+
+#include "CCSoft_Exception.h"
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+namespace ccsoft
+{
+
+/**
+ * \brief Interleaver types
+ */
+typedef enum
+{
+    CC_Interleaver_BitReversal,   //!< Bit reversal of the symbol index (default)
+    CC_Interleaver_Block,         //!< Symbols written row by row in a block of given number of rows and read column by column
+    CC_Interleaver_Convolutional  //!< Symbol i goes to branch i mod B delayed by (i mod B)*D*B positions wrapped around the frame
+} CC_InterleaverType;
+
+/**
+ * \brief Permutation of the symbol positions of a frame of given length. Interleaving moves the symbol at position i
+ * to position get_index(i). The permutation is decomposed in cycles once at construction so that it can be applied
+ * in place with a single temporary element by following each cycle.
+ */
+class CC_InterleaverPermutation
+{
+public:
+    /**
+     * Constructor
+     * \param type Interleaver type
+     * \param length Number of symbols in the frame
+     * \param nb_rows Number of rows of the block interleaver or number of branches of the convolutional interleaver.
+     * The length must be a multiple of it. Not used for bit reversal.
+     * \param delay Delay increment between branches in units of the number of branches for the convolutional interleaver.
+     */
+    CC_InterleaverPermutation(CC_InterleaverType type, unsigned int length, unsigned int nb_rows = 1, unsigned int delay = 1) :
+        indexes(length),
+        inverse_indexes(length)
+    {
+        switch (type)
+        {
+        case CC_Interleaver_Block:
+            init_block(nb_rows);
+            break;
+        case CC_Interleaver_Convolutional:
+            init_convolutional(nb_rows, delay);
+            break;
+        default:
+            init_bit_reversal();
+            break;
+        }
+
+        for (unsigned int i=0; i<length; i++)
+        {
+            inverse_indexes[indexes[i]] = i;
+        }
+
+        std::vector<bool> visited(length, false);
+
+        for (unsigned int i=0; i<length; i++)
+        {
+            if (!visited[i])
+            {
+                unsigned int j = i;
+
+                do
+                {
+                    visited[j] = true;
+                    j = indexes[j];
+                } while (j != i);
+
+                if (indexes[i] != i) // fixed points need not be moved
+                {
+                    cycle_leaders.push_back(i);
+                }
+            }
+        }
+    }
+
+    /**
+     * Number of symbols in the frame
+     */
+    unsigned int get_length() const
+    {
+        return indexes.size();
+    }
+
+    /**
+     * Position of the symbol at position i after interleaving
+     */
+    unsigned int get_index(unsigned int i) const
+    {
+        return indexes[i];
+    }
+
+    /**
+     * Position before interleaving of the symbol at position i after interleaving
+     */
+    unsigned int get_inverse_index(unsigned int i) const
+    {
+        return inverse_indexes[i];
+    }
+
+    /**
+     * Interleave or deinterleave symbols in place
+     * \param symbols Pointer to get_length() symbols
+     * \param forward true to interleave, false to deinterleave
+     */
+    template<typename T_Symbol>
+    void apply(T_Symbol *symbols, bool forward = true) const
+    {
+        const std::vector<unsigned int>& sources = (forward ? inverse_indexes : indexes);
+
+        for (std::vector<unsigned int>::const_iterator it = cycle_leaders.begin(); it != cycle_leaders.end(); ++it)
+        {
+            T_Symbol tmp_symbol = symbols[*it];
+            unsigned int j = *it;
+
+            for (unsigned int k = sources[j]; k != *it; j = k, k = sources[k])
+            {
+                symbols[j] = symbols[k];
+            }
+
+            symbols[j] = tmp_symbol;
+        }
+    }
+
+    /**
+     * Interleave or deinterleave blocks of consecutive values in place e.g. the columns of a reliability matrix
+     * \param blocks Pointer to get_length() blocks
+     * \param block_size Number of values in each block
+     * \param tmp_block Scratch storage of block_size values
+     * \param forward true to interleave, false to deinterleave
+     */
+    template<typename T_Value>
+    void apply_blocks(T_Value *blocks, unsigned int block_size, T_Value *tmp_block, bool forward = true) const
+    {
+        const std::vector<unsigned int>& sources = (forward ? inverse_indexes : indexes);
+
+        for (std::vector<unsigned int>::const_iterator it = cycle_leaders.begin(); it != cycle_leaders.end(); ++it)
+        {
+            std::copy(blocks + (*it)*block_size, blocks + (*it+1)*block_size, tmp_block);
+            unsigned int j = *it;
+
+            for (unsigned int k = sources[j]; k != *it; j = k, k = sources[k])
+            {
+                std::copy(blocks + k*block_size, blocks + (k+1)*block_size, blocks + j*block_size);
+            }
+
+            std::copy(tmp_block, tmp_block + block_size, blocks + j*block_size);
+        }
+    }
+
+protected:
+    /**
+     * Bit reversal of the index over one bit more than the length needs. Reversed indexes out of the frame are skipped.
+     */
+    void init_bit_reversal()
+    {
+        unsigned int length = indexes.size();
+
+        if (length == 0)
+        {
+            return;
+        }
+
+        unsigned int index_size = (unsigned int) (log(length)/log(2)) + 1;
+        unsigned int index_max = 1<<index_size;
+        unsigned int new_index, s, iv;
+        unsigned int old_index = 0;
+
+        for (unsigned int i=0; (i<index_max) && (old_index<length); i++)
+        {
+            new_index = 0;
+            s = index_size;
+            iv = i;
+
+            for (; iv; iv >>= 1) // bit reversal
+            {
+                new_index |= iv & 1;
+                new_index <<= 1;
+                s--;
+            }
+
+            new_index >>= 1; // the last shift right was too much
+            new_index <<= s; // account for leading zeroes
+
+            if (new_index < length)
+            {
+                indexes[old_index++] = new_index;
+            }
+        }
+    }
+
+    /**
+     * Write row by row, read column by column
+     */
+    void init_block(unsigned int nb_rows)
+    {
+        unsigned int length = indexes.size();
+
+        if ((nb_rows == 0) || (length % nb_rows != 0))
+        {
+            throw CCSoft_Exception("Block interleaver length must be a multiple of the number of rows");
+        }
+
+        unsigned int nb_cols = length / nb_rows;
+
+        for (unsigned int i=0; i<length; i++)
+        {
+            indexes[i] = (i % nb_cols)*nb_rows + (i / nb_cols);
+        }
+    }
+
+    /**
+     * Branch b = i mod B delays its symbols by b*D*B positions. Delayed symbols wrap around the end of the frame
+     * (tail biting) so that the frame length is kept.
+     */
+    void init_convolutional(unsigned int nb_branches, unsigned int delay)
+    {
+        unsigned int length = indexes.size();
+
+        if ((nb_branches == 0) || (length % nb_branches != 0))
+        {
+            throw CCSoft_Exception("Convolutional interleaver length must be a multiple of the number of branches");
+        }
+
+        unsigned int nb_blocks = length / nb_branches;
+
+        for (unsigned int i=0; i<length; i++)
+        {
+            unsigned int branch = i % nb_branches;
+            unsigned int block = ((unsigned long long) i / nb_branches + (unsigned long long) branch * delay) % nb_blocks;
+            indexes[i] = block*nb_branches + branch;
+        }
+    }
+
+    std::vector<unsigned int> indexes;         //!< Position of each symbol after interleaving
+    std::vector<unsigned int> inverse_indexes; //!< Position of each symbol before interleaving
+    std::vector<unsigned int> cycle_leaders;   //!< First position of each cycle of the permutation except fixed points
+};
+
+} // namespace ccsoft
+
+#endif // __CC_INTERLEAVER_PERMUTATION_H__
@@ -0,0 +1,484 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Soft output convolutional decoder based on the max-log approximation of
+ the BCJR (MAP) algorithm. Gives the a posteriori reliability of each
+ input symbol besides the hard decisions. Explores the whole code trellis
+ hence suits short constraint codes like the Viterbi decoder.
+
+ */
+#ifndef __CC_MAX_LOG_BCJR_DECODING_H__
+#define __CC_MAX_LOG_BCJR_DECODING_H__
+
+#include "CC_SequentialDecoding.h"
+#include "CC_EdgeMetrics.h"
+#include "CC_ReliabilityMatrix.h"
+#include "CCSoft_Exception.h"
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace ccsoft
+{
+
+/**
+ * \brief The max-log BCJR Decoding class. The trellis is the same as the Viterbi decoder one: a state holds the
+ * constraint length - 1 most recent input bits of each register. A forward pass computes the best path metric from
+ * the start to each state at each depth (alpha) and a backward pass the best path metric from each state to the end
+ * (beta). Both are in the log2 domain of the edge metrics. The a posteriori reliability of input symbol u at depth d is
+ * the best alpha + edge metric + beta over the trellis branches of input u at depth d. Reliabilities are kept relative
+ * to the most likely symbol of each depth, which is the hard decision and is also the Viterbi decision.
+ * Soft output is available after decode() with get_symbol_reliabilities(), get_symbol_probabilities() and get_bit_llr().
+ * See CC_SoftOutputAdapter.h to feed them to a Reed-Solomon soft decision decoder.
+ * \tparam T_Register Type of the encoder internal registers
+ * \tparam T_IOSymbol Type of the input and output symbols
+ */
+template<typename T_Register, typename T_IOSymbol>
+class CC_MaxLogBCJRDecoding : public CC_SequentialDecoding<T_Register, T_IOSymbol>
+{
+public:
+    /**
+     * Constructor
+     * \param constraints Vector of register lengths (constraint length + 1). The number of elements determines k.
+     * \param genpoly_representations Generator polynomial numeric representations. There are as many elements as there
+     * are input bits (k). Each element is itself a vector with one polynomial value per output bit. The smallest size of
+     * these vectors is retained as the number of output bits n. The input bits of a symbol are clocked simultaneously into
+     * the right hand side, or least significant position of the internal registers. Therefore the given polynomial representation
+     * of generators should follow the same convention.
+     */
+    CC_MaxLogBCJRDecoding(const std::vector<unsigned int>& constraints,
+            const std::vector<std::vector<T_Register> >& genpoly_representations) :
+                CC_SequentialDecoding<T_Register, T_IOSymbol>(constraints, genpoly_representations),
+                message_length(0),
+                nb_branches(0)
+    {
+        init_trellis(constraints);
+    }
+
+    /**
+     * Destructor
+     */
+    virtual ~CC_MaxLogBCJRDecoding()
+    {}
+
+    /**
+     * Reset the decoding process
+     */
+    void reset()
+    {
+        Parent::reset();
+        message_length = 0;
+        nb_branches = 0;
+    }
+
+    /**
+     * Get the number of trellis states
+     */
+    unsigned int get_nb_states() const
+    {
+        return nb_states;
+    }
+
+    /**
+     * Get the number of symbols of the last decoded message i.e. the number of depths with soft output
+     */
+    unsigned int get_message_length() const
+    {
+        return message_length;
+    }
+
+    /**
+     * Get the number of branches explored by the forward pass of the last decode. The node count of the parent class
+     * gives the same number but saturates at the largest unsigned int for long messages with many states.
+     */
+    unsigned long long get_nb_branches() const
+    {
+        return nb_branches;
+    }
+
+    /**
+     * Get the a posteriori reliabilities of the input symbols at a depth of the last decoded message. They are max-log
+     * approximations of log2 of the a posteriori probabilities relative to the most likely symbol which has 0.
+     * \param depth Symbol position in the message
+     * \return Pointer to 1<<k values indexed by input symbol
+     */
+    const float *get_symbol_reliabilities(unsigned int depth) const
+    {
+        return &reliabilities[depth << k];
+    }
+
+    /**
+     * Get the a posteriori probabilities of the input symbols at a depth of the last decoded message
+     * \param depth Symbol position in the message
+     * \param probabilities Array of 1<<k values receiving the probabilities indexed by input symbol. They sum to 1.
+     */
+    void get_symbol_probabilities(unsigned int depth, float *probabilities) const
+    {
+        const float *symbol_reliabilities = get_symbol_reliabilities(depth);
+        float sum = 0.0;
+
+        for (unsigned int in_symbol=0; in_symbol < (1U<<k); in_symbol++)
+        {
+            probabilities[in_symbol] = exp2f(symbol_reliabilities[in_symbol]);
+            sum += probabilities[in_symbol];
+        }
+
+        for (unsigned int in_symbol=0; in_symbol < (1U<<k); in_symbol++)
+        {
+            probabilities[in_symbol] /= sum;
+        }
+    }
+
+    /**
+     * Get the log likelihood ratio of an input bit at a depth of the last decoded message
+     * \param depth Symbol position in the message
+     * \param bit Index of the bit in the input symbol
+     * \return Max-log approximation of log2(P(bit=1)/P(bit=0))
+     */
+    float get_bit_llr(unsigned int depth, unsigned int bit) const
+    {
+        const float *symbol_reliabilities = get_symbol_reliabilities(depth);
+        float best_one = -std::numeric_limits<float>::infinity();
+        float best_zero = -std::numeric_limits<float>::infinity();
+
+        for (unsigned int in_symbol=0; in_symbol < (1U<<k); in_symbol++)
+        {
+            if ((in_symbol >> bit) & 1)
+            {
+                best_one = std::max(best_one, symbol_reliabilities[in_symbol]);
+            }
+            else
+            {
+                best_zero = std::max(best_zero, symbol_reliabilities[in_symbol]);
+            }
+        }
+
+        return best_one - best_zero;
+    }
+
+    /**
+     * Get the reliability of the hard decision at a depth of the last decoded message i.e. the margin between the most
+     * likely symbol and the second most likely one. It is a positive log2 ratio.
+     * \param depth Symbol position in the message
+     */
+    float get_decision_reliability(unsigned int depth) const
+    {
+        const float *symbol_reliabilities = get_symbol_reliabilities(depth);
+        unsigned int best_symbol = std::max_element(symbol_reliabilities, symbol_reliabilities + (1<<k)) - symbol_reliabilities;
+        float second_best = -std::numeric_limits<float>::infinity();
+
+        for (unsigned int in_symbol=0; in_symbol < (1U<<k); in_symbol++)
+        {
+            if ((in_symbol != best_symbol) && (symbol_reliabilities[in_symbol] > second_best))
+            {
+                second_best = symbol_reliabilities[in_symbol];
+            }
+        }
+
+        return symbol_reliabilities[best_symbol] - second_best;
+    }
+
+    /**
+     * Decodes given the reliability matrix. The decoded message is made of the most likely symbol at each depth.
+     * \param relmat Reference to the reliability matrix
+     * \param decoded_message Vector of symbols of retrieved message
+     */
+    virtual bool decode(const CC_ReliabilityMatrix& relmat, std::vector<T_IOSymbol>& decoded_message)
+    {
+        if (relmat.get_message_length() < Parent::encoding.get_m())
+        {
+            throw CCSoft_Exception("Reliability Matrix should have a number of columns at least equal to the code constraint");
+        }
+
+        if (relmat.get_nb_symbols_log2() != Parent::encoding.get_n())
+        {
+            throw CCSoft_Exception("Reliability Matrix is not compatible with code output symbol size");
+        }
+
+        reset();
+        CC_DecodingBudgetScope budget_scope(Parent::budget);
+        edge_metrics.init(relmat, Parent::edge_bias);
+        message_length = relmat.get_message_length();
+        alphas.resize((message_length + 1) * nb_states);
+        betas.resize(nb_states);
+        new_betas.resize(nb_states);
+        reliabilities.resize(message_length << k);
+        decoded_message.resize(message_length);
+
+        // forward pass: alphas[d*nb_states + s] is the best metric of the paths reaching state s before depth d
+        std::fill(alphas.begin(), alphas.begin() + nb_states, -std::numeric_limits<float>::infinity());
+        alphas[0] = 0.0; // the encoder starts from the zero state
+        float alpha_offset = 0.0; // sum of the normalization offsets
+
+        for (unsigned int depth=0; depth<message_length; depth++)
+        {
+            const float *metrics = edge_metrics.get_column(depth);
+            const float *alpha = &alphas[depth * nb_states];
+            float *next_alpha = &alphas[(depth + 1) * nb_states];
+            std::fill(next_alpha, next_alpha + nb_states, -std::numeric_limits<float>::infinity());
+
+            for (unsigned int state=0; state<nb_states; state++)
+            {
+                for (unsigned int in_symbol=0; in_symbol < (1U<<k); in_symbol++)
+                {
+                    unsigned int branch = (state << k) + in_symbol;
+                    next_alpha[next_states[branch]] = std::max(next_alpha[next_states[branch]], alpha[state] + metrics[outputs[branch]]);
+                }
+            }
+
+            alpha_offset += normalize(next_alpha); // keeps metrics in the range where float precision is good
+            nb_branches += ((unsigned long long) nb_states) << k; // branches explored
+            Parent::node_count = (nb_branches < std::numeric_limits<unsigned int>::max() ? nb_branches : std::numeric_limits<unsigned int>::max());
+        }
+
+        // end of the trellis
+        if (Parent::tail_zeros) // zero tail brings the encoder back to the zero state
+        {
+            std::fill(betas.begin(), betas.end(), -std::numeric_limits<float>::infinity());
+            betas[0] = 0.0;
+        }
+        else
+        {
+            std::fill(betas.begin(), betas.end(), 0.0);
+        }
+
+        float best_end_metric = -std::numeric_limits<float>::infinity();
+
+        for (unsigned int state=0; state<nb_states; state++)
+        {
+            best_end_metric = std::max(best_end_metric, alphas[message_length * nb_states + state] + betas[state]);
+        }
+
+        Parent::codeword_score = best_end_metric + alpha_offset;
+        Parent::cur_depth = message_length - 1;
+        Parent::max_depth = message_length - 1;
+
+        if (best_end_metric == -std::numeric_limits<float>::infinity())
+        {
+            Parent::status = CC_Decoding_NoPath;
+            decoded_message.clear();
+            return false;
+        }
+
+        // backward pass combined with the a posteriori reliabilities
+        for (int depth=message_length-1; depth>=0; depth--)
+        {
+            const float *metrics = edge_metrics.get_column(depth);
+            const float *alpha = &alphas[depth * nb_states];
+            float *symbol_reliabilities = &reliabilities[depth << k];
+            std::fill(symbol_reliabilities, symbol_reliabilities + (1<<k), -std::numeric_limits<float>::infinity());
+
+            for (unsigned int state=0; state<nb_states; state++)
+            {
+                float new_beta = -std::numeric_limits<float>::infinity();
+
+                for (unsigned int in_symbol=0; in_symbol < (1U<<k); in_symbol++)
+                {
+                    unsigned int branch = (state << k) + in_symbol;
+                    float metric = metrics[outputs[branch]] + betas[next_states[branch]];
+                    new_beta = std::max(new_beta, metric);
+                    symbol_reliabilities[in_symbol] = std::max(symbol_reliabilities[in_symbol], alpha[state] + metric);
+                }
+
+                new_betas[state] = new_beta;
+            }
+
+            normalize(&new_betas[0]);
+            betas.swap(new_betas);
+            decoded_message[depth] = normalize_reliabilities(symbol_reliabilities);
+        }
+
+        if ((Parent::use_metric_limit) && (Parent::codeword_score < Parent::metric_limit))
+        {
+            Parent::status = CC_Decoding_MetricLimit;
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Print stats to an output stream
+     * \param os Output stream
+     * \param success True if decoding was successful
+     */
+    virtual void print_stats(std::ostream& os, bool success)
+    {
+        float min_reliability = std::numeric_limits<float>::infinity();
+
+        for (unsigned int depth=0; depth<message_length; depth++)
+        {
+            min_reliability = std::min(min_reliability, get_decision_reliability(depth));
+        }
+
+        os << "score = " << Parent::get_score()
+                << " #states = " << nb_states
+                << " #branches = " << nb_branches
+                << " min reliability = " << min_reliability;
+    }
+
+    /**
+     * Print stats summary to an output stream
+     * \param os Output stream
+     * \param success True if decoding was successful
+     */
+    virtual void print_stats_summary(std::ostream& os, bool success)
+    {
+        os << "_RES " << (success ? 1 : 0) << ","
+                << Parent::get_score() << ","
+                << nb_states << ","
+                << nb_branches;
+    }
+
+    /**
+     * Print the dot (Graphviz) file. There is no code tree in trellis decoding so the graph is empty.
+     * \param os Output stream
+     */
+    virtual void print_dot(std::ostream& os)
+    {
+        os << "digraph G {" << std::endl;
+        os << "}" << std::endl;
+    }
+
+protected:
+    typedef CC_SequentialDecoding<T_Register, T_IOSymbol> Parent; //!< Parent class this class inherits from
+
+    static const unsigned int max_state_bits = 16; //!< Maximum number of bits of a trellis state
+
+    /**
+     * Build the trellis tables from the encoder
+     * \param constraints Vector of register lengths
+     */
+    void init_trellis(const std::vector<unsigned int>& constraints)
+    {
+        k = Parent::encoding.get_k();
+        std::vector<unsigned int> register_shifts; // position of registers in the encoder packed state
+        std::vector<unsigned int> memory_shifts;   // position of registers memory in the trellis state
+        std::vector<unsigned int> memory_lengths;
+        unsigned int register_shift = 0;
+        unsigned int state_bits = 0;
+
+        for (unsigned int ki=0; ki<k; ki++)
+        {
+            if (constraints[ki] < 2)
+            {
+                throw CCSoft_Exception("BCJR decoding needs registers of at least 2 bits");
+            }
+
+            register_shifts.push_back(register_shift);
+            memory_shifts.push_back(state_bits);
+            memory_lengths.push_back(constraints[ki] - 1);
+            register_shift += constraints[ki];
+            state_bits += constraints[ki] - 1;
+        }
+
+        if (state_bits > max_state_bits)
+        {
+            throw CCSoft_Exception("Too many trellis states for BCJR decoding");
+        }
+
+        nb_states = 1<<state_bits;
+        outputs.resize(nb_states << k);
+        next_states.resize(nb_states << k);
+
+        for (unsigned int state=0; state<nb_states; state++)
+        {
+            unsigned long long packed_state = 0;
+
+            for (unsigned int ki=0; ki<k; ki++)
+            {
+                unsigned long long memory = (state >> memory_shifts[ki]) & ((1ULL << memory_lengths[ki]) - 1);
+                packed_state |= memory << register_shifts[ki];
+            }
+
+            for (unsigned int in_symbol=0; in_symbol < (1U<<k); in_symbol++)
+            {
+                unsigned long long next_packed_state = Parent::encoding.get_next_packed_state(packed_state, in_symbol);
+                unsigned int next_state = 0;
+
+                for (unsigned int ki=0; ki<k; ki++)
+                {
+                    next_state |= ((next_packed_state >> register_shifts[ki]) & ((1ULL << memory_lengths[ki]) - 1)) << memory_shifts[ki];
+                }
+
+                outputs[(state << k) + in_symbol] = Parent::encoding.get_output_symbol(next_packed_state);
+                next_states[(state << k) + in_symbol] = next_state;
+            }
+        }
+    }
+
+    /**
+     * Subtract the largest of the state metrics of a depth from all of them
+     * \param metrics State metrics
+     * \return Value subtracted
+     */
+    float normalize(float *metrics) const
+    {
+        float max_metric = *std::max_element(metrics, metrics + nb_states);
+
+        if (max_metric == -std::numeric_limits<float>::infinity())
+        {
+            return 0.0;
+        }
+
+        for (unsigned int state=0; state<nb_states; state++)
+        {
+            metrics[state] -= max_metric;
+        }
+
+        return max_metric;
+    }
+
+    /**
+     * Make the reliabilities of a depth relative to the most likely symbol
+     * \param symbol_reliabilities Reliabilities of each input symbol
+     * \return Most likely symbol
+     */
+    T_IOSymbol normalize_reliabilities(float *symbol_reliabilities) const
+    {
+        T_IOSymbol best_symbol = std::max_element(symbol_reliabilities, symbol_reliabilities + (1<<k)) - symbol_reliabilities;
+        float best_reliability = symbol_reliabilities[best_symbol];
+
+        for (unsigned int in_symbol=0; in_symbol < (1U<<k); in_symbol++)
+        {
+            symbol_reliabilities[in_symbol] -= best_reliability;
+        }
+
+        return best_symbol;
+    }
+
+    unsigned int k;                         //!< Number of input bits
+    unsigned int nb_states;                 //!< Number of trellis states
+    unsigned int message_length;            //!< Number of symbols of the last decoded message
+    unsigned long long nb_branches;         //!< Number of branches explored during the last decode
+    std::vector<T_IOSymbol> outputs;        //!< Output symbol by (state << k) + input symbol
+    std::vector<unsigned int> next_states;  //!< Next state by (state << k) + input symbol
+    std::vector<float> alphas;              //!< Forward state metrics of all depths
+    std::vector<float> betas;               //!< Backward state metrics of the current depth
+    std::vector<float> new_betas;           //!< Backward state metrics of the previous depth
+    std::vector<float> reliabilities;       //!< A posteriori reliabilities by (depth << k) + input symbol
+    CC_EdgeMetrics edge_metrics;            //!< Biased log2 reliabilities computed once per decode
+};
+
+} // namespace ccsoft
+
+#endif // __CC_MAX_LOG_BCJR_DECODING_H__
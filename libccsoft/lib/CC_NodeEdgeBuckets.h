@@ -0,0 +1,276 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Bucketed open list of the stack-bucket (Jelinek) algorithm. Path metrics
+ are quantized into buckets of fixed width. Nodes are pushed in the bucket
+ of their path metric and popped from the highest non empty bucket.
+
+ */
+#ifndef __CC_NODE_EDGE_BUCKETS_H__
+#define __CC_NODE_EDGE_BUCKETS_H__
+
+#include "CCSoft_Exception.h"
+
+#include <vector>
+#include <cmath>
+
+namespace ccsoft
+{
+
+/**
+ * \brief Bucketed stack of node+edge combos. Path metrics are quantized by the bucket width. Within a bucket
+ * nodes are kept in LIFO order. Push is O(1) and pop is O(1) amortized: after a pop the top bucket index only
+ * moves down to the next non empty bucket. Buckets are allocated on both sides of the first quantized metric
+ * pushed so that the list can grow towards positive or negative metrics without moving existing buckets.
+ * \tparam T_NodeEdge Type of the node+edge combo
+ */
+template<typename T_NodeEdge>
+class CC_NodeEdgeBuckets
+{
+public:
+    /**
+     * Constructor
+     * \param _bucket_width Width of a bucket in path metric units
+     */
+    CC_NodeEdgeBuckets(float _bucket_width) :
+        bucket_width(_bucket_width),
+        pivot(0),
+        top_index(0),
+        bottom_index(0),
+        count(0)
+    {
+        if (bucket_width <= 0.0)
+        {
+            throw CCSoft_Exception("Bucket width must be positive");
+        }
+    }
+
+    ~CC_NodeEdgeBuckets()
+    {}
+
+    /**
+     * Push a node+edge
+     * \param path_metric Path metric of the node
+     * \param node_edge Pointer to the node+edge
+     */
+    void push(float path_metric, T_NodeEdge *node_edge)
+    {
+        int index = quantize(path_metric);
+
+        if ((upper_buckets.size() == 0) && (lower_buckets.size() == 0))
+        {
+            pivot = index;
+        }
+        else if (index < pivot - max_span) // very unlikely metrics (i.e. zero reliability) go to the lowest bucket
+        {
+            index = pivot - max_span;
+        }
+        else if (index > pivot + max_span)
+        {
+            index = pivot + max_span;
+        }
+
+        if (count == 0)
+        {
+
+            top_index = index;
+            bottom_index = index;
+        }
+        else if (index > top_index)
+        {
+            top_index = index;
+        }
+        else if (index < bottom_index)
+        {
+            bottom_index = index;
+        }
+
+        get_bucket(index).push_back(node_edge);
+        count++;
+    }
+
+    /**
+     * Top node+edge i.e. the latest node pushed in the highest bucket. Buckets must not be empty.
+     */
+    T_NodeEdge *top_node_edge()
+    {
+        return get_bucket(top_index).back();
+    }
+
+    /**
+     * Remove the top node+edge
+     */
+    void pop()
+    {
+        get_bucket(top_index).pop_back();
+        count--;
+        adjust_top();
+    }
+
+    /**
+     * Remove one node+edge from the lowest non empty bucket. Used to cap the stack size.
+     * \return Pointer to the node+edge removed
+     */
+    T_NodeEdge *drop_bottom()
+    {
+        while (get_bucket(bottom_index).empty()) // bottom index may lag behind after pops
+        {
+            bottom_index++;
+        }
+
+        std::vector<T_NodeEdge*>& bucket = get_bucket(bottom_index);
+        T_NodeEdge *node_edge = bucket.back();
+        bucket.pop_back();
+        count--;
+        adjust_top();
+
+        return node_edge;
+    }
+
+    /**
+     * Number of node+edges in all buckets
+     */
+    unsigned int size() const
+    {
+        return count;
+    }
+
+    /**
+     * True if there are no node+edges
+     */
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    /**
+     * Number of buckets allocated so far
+     */
+    unsigned int get_nb_buckets() const
+    {
+        return upper_buckets.size() + lower_buckets.size();
+    }
+
+    /**
+     * Lower bound of the path metric in the top bucket
+     */
+    float get_top_bucket_metric() const
+    {
+        return top_index * bucket_width;
+    }
+
+    /**
+     * Remove all node+edges. Buckets storage is kept for the next decode.
+     */
+    void clear()
+    {
+        typename std::vector<std::vector<T_NodeEdge*> >::iterator b_it = upper_buckets.begin();
+
+        for (; b_it != upper_buckets.end(); ++b_it)
+        {
+            b_it->clear();
+        }
+
+        for (b_it = lower_buckets.begin(); b_it != lower_buckets.end(); ++b_it)
+        {
+            b_it->clear();
+        }
+
+        count = 0;
+    }
+
+protected:
+    /**
+     * Move the top index down to the highest non empty bucket after a removal
+     */
+    void adjust_top()
+    {
+        if (count > 0)
+        {
+            while (get_bucket(top_index).empty())
+            {
+                top_index--;
+            }
+        }
+    }
+
+    /**
+     * Quantize a path metric into a bucket index
+     */
+    int quantize(float path_metric) const
+    {
+        float q = floor(path_metric / bucket_width);
+
+        if (!(q > -max_span)) // also catches -inf from a zero reliability
+        {
+            return -max_span;
+        }
+        else if (q > max_span)
+        {
+            return max_span;
+        }
+        else
+        {
+            return (int) q;
+        }
+    }
+
+    /**
+     * Get bucket for a given bucket index. Allocates buckets as necessary.
+     */
+    std::vector<T_NodeEdge*>& get_bucket(int index)
+    {
+        if (index >= pivot)
+        {
+            unsigned int i = index - pivot;
+
+            if (i >= upper_buckets.size())
+            {
+                upper_buckets.resize(i+1);
+            }
+
+            return upper_buckets[i];
+        }
+        else
+        {
+            unsigned int i = pivot - index - 1;
+
+            if (i >= lower_buckets.size())
+            {
+                lower_buckets.resize(i+1);
+            }
+
+            return lower_buckets[i];
+        }
+    }
+
+    static const int max_span = 65536; //!< Maximum distance in buckets from the pivot bucket
+
+    float bucket_width;  //!< Width of a bucket in path metric units
+    int pivot;           //!< Bucket index of the first element in upper buckets
+    int top_index;       //!< Index of the highest non empty bucket
+    int bottom_index;    //!< Index at or below the lowest non empty bucket
+    unsigned int count;  //!< Number of node+edges in all buckets
+    std::vector<std::vector<T_NodeEdge*> > upper_buckets; //!< Buckets with index >= pivot
+    std::vector<std::vector<T_NodeEdge*> > lower_buckets; //!< Buckets with index < pivot in reverse order
+};
+
+} // namespace ccsoft
+
+#endif // __CC_NODE_EDGE_BUCKETS_H__
@@ -0,0 +1,204 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Ordering of node+edge combos in the code tree and the priority queue
+ (heap) used as the open list of the stack algorithm.
+
+ */
+#ifndef __CC_NODE_EDGE_ORDERING_H__
+#define __CC_NODE_EDGE_ORDERING_H__
+
+#include <vector>
+#include <algorithm>
+
+namespace ccsoft
+{
+
+/**
+ * \brief class used for node ordering
+ */
+class NodeEdgeOrdering
+{
+public:
+	NodeEdgeOrdering(float _path_metric, unsigned int _node_id) :
+        path_metric(_path_metric),
+        node_id(_node_id)
+    {}
+
+    ~NodeEdgeOrdering()
+    {}
+
+    bool operator>(const NodeEdgeOrdering& other) const
+    {
+        if (path_metric == other.path_metric)
+        {
+            return node_id > other.node_id;
+        }
+        else
+        {
+            return path_metric > other.path_metric;
+        }
+    }
+
+    float path_metric;
+    unsigned int node_id;
+};
+
+/**
+ * \brief Ordering of sibling node+edges by decreasing path metric then decreasing input symbol (i.e. latest created first)
+ */
+template<typename T_NodeEdge>
+bool node_edge_pointer_ordering(T_NodeEdge* n1, T_NodeEdge* n2)
+{
+    if (n1->get_path_metric() == n2->get_path_metric())
+    {
+        return n1->get_in_symbol() > n2->get_in_symbol();
+    }
+    else
+    {
+        return n1->get_path_metric() > n2->get_path_metric();
+    }
+}
+
+/**
+ * \brief Binary heap of node+edge combos ordered by decreasing path metric then decreasing node id. The top
+ * of the heap is the node+edge with the best path metric. Push and pop are O(log N), top is O(1).
+ * The storage is kept when the heap is cleared so that it is reused by the next decode.
+ * \tparam T_NodeEdge Type of the node+edge combo
+ */
+template<typename T_NodeEdge>
+class CC_NodeEdgeHeap
+{
+public:
+    /**
+     * Heap element. The ordering key is copied alongside the pointer so that comparisons do not dereference nodes.
+     */
+    class Entry
+    {
+    public:
+        Entry(float _path_metric, unsigned int _node_id, T_NodeEdge *_node_edge) :
+            ordering(_path_metric, _node_id),
+            node_edge(_node_edge)
+        {}
+
+        /**
+         * Heap order: an entry is "less" than another if it comes after it in the stack
+         */
+        bool operator<(const Entry& other) const
+        {
+            return other.ordering > ordering;
+        }
+
+        NodeEdgeOrdering ordering;
+        T_NodeEdge *node_edge;
+    };
+
+    CC_NodeEdgeHeap()
+    {}
+
+    ~CC_NodeEdgeHeap()
+    {}
+
+    /**
+     * Push a node+edge
+     * \param path_metric Path metric of the node
+     * \param node_id Unique id of the node (tie breaker, latest first)
+     * \param node_edge Pointer to the node+edge
+     */
+    void push(float path_metric, unsigned int node_id, T_NodeEdge *node_edge)
+    {
+        heap.push_back(Entry(path_metric, node_id, node_edge));
+        std::push_heap(heap.begin(), heap.end());
+    }
+
+    /**
+     * Append a node+edge without restoring the heap order. Call make_heap() once all elements are appended.
+     * \param path_metric Path metric of the node
+     * \param node_id Unique id of the node (tie breaker, latest first)
+     * \param node_edge Pointer to the node+edge
+     */
+    void push_unordered(float path_metric, unsigned int node_id, T_NodeEdge *node_edge)
+    {
+        heap.push_back(Entry(path_metric, node_id, node_edge));
+    }
+
+    /**
+     * Restore the heap order in O(N) after a series of push_unordered()
+     */
+    void make_heap()
+    {
+        std::make_heap(heap.begin(), heap.end());
+    }
+
+    /**
+     * Remove the top node+edge
+     */
+    void pop()
+    {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.pop_back();
+    }
+
+    /**
+     * Top entry. Heap must not be empty.
+     */
+    const Entry& top() const
+    {
+        return heap.front();
+    }
+
+    /**
+     * Top node+edge. Heap must not be empty.
+     */
+    T_NodeEdge *top_node_edge() const
+    {
+        return heap.front().node_edge;
+    }
+
+    /**
+     * Number of elements
+     */
+    unsigned int size() const
+    {
+        return heap.size();
+    }
+
+    /**
+     * True if the heap has no element
+     */
+    bool empty() const
+    {
+        return heap.empty();
+    }
+
+    /**
+     * Remove all elements
+     */
+    void clear()
+    {
+        heap.clear();
+    }
+
+protected:
+    std::vector<Entry> heap; //!< Heap storage
+};
+
+} // namespace ccsoft
+
+#endif // __CC_NODE_EDGE_ORDERING_H__
@@ -22,9 +22,12 @@
  */
 
 #include "CC_ReliabilityMatrix.h"
+#include "CC_InterleaverPermutation.h"
+#include "CCSoft_Exception.h"
 #include <iomanip>
 #include <cstring>
 #include <cmath>
+#include <vector>
 
 namespace ccsoft
 {
@@ -34,7 +37,11 @@ CC_ReliabilityMatrix::CC_ReliabilityMatrix(unsigned int nb_symbols_log2, unsigne
         _nb_symbols_log2(nb_symbols_log2),
         _nb_symbols(1<<nb_symbols_log2),
         _message_length(message_length),
-        _message_symbol_count(0)
+        _message_symbol_count(0),
+        _deinterleaving(0),
+        _column_entered(message_length, false),
+        _nb_ready_columns(0),
+        _bitreversal_permutation(0)
 {
     _matrix = new float[_nb_symbols*_message_length];
 
@@ -49,7 +56,11 @@ CC_ReliabilityMatrix::CC_ReliabilityMatrix(const CC_ReliabilityMatrix& relmat) :
         _nb_symbols_log2(relmat.get_nb_symbols_log2()),
         _nb_symbols(relmat.get_nb_symbols()),
         _message_length(relmat.get_message_length()),
-        _message_symbol_count(0)
+        _message_symbol_count(0),
+        _deinterleaving(0),
+        _column_entered(relmat._column_entered),
+        _nb_ready_columns(relmat._nb_ready_columns),
+        _bitreversal_permutation(0)
 {
     _matrix = new float[_nb_symbols*_message_length];
     memcpy((void *) _matrix, (void *) relmat.get_raw_matrix(), _nb_symbols*_message_length*sizeof(float));
@@ -59,6 +70,37 @@ CC_ReliabilityMatrix::CC_ReliabilityMatrix(const CC_ReliabilityMatrix& relmat) :
 CC_ReliabilityMatrix::~CC_ReliabilityMatrix()
 {
     delete[] _matrix;
+
+    if (_bitreversal_permutation)
+    {
+        delete _bitreversal_permutation;
+    }
+}
+
+// ================================================================================================
+void CC_ReliabilityMatrix::set_deinterleaving(const CC_InterleaverPermutation *permutation)
+{
+    if (permutation && (permutation->get_length() != _message_length))
+    {
+        throw CCSoft_Exception("Deinterleaving permutation length must be the message length");
+    }
+
+    _deinterleaving = permutation;
+    reset_message_symbol_count();
+}
+
+// ================================================================================================
+unsigned int CC_ReliabilityMatrix::ingest_column(unsigned int message_symbol_index)
+{
+    unsigned int column = (_deinterleaving ? _deinterleaving->get_inverse_index(message_symbol_index) : message_symbol_index);
+    _column_entered[column] = true;
+
+    while ((_nb_ready_columns < _message_length) && _column_entered[_nb_ready_columns])
+    {
+        _nb_ready_columns++;
+    }
+
+    return column;
 }
 
 // ================================================================================================
@@ -66,7 +108,8 @@ void CC_ReliabilityMatrix::enter_symbol_data(float *symbol_data)
 {
     if (_message_symbol_count < _message_length)
     {
-        memcpy((void *) &_matrix[_message_symbol_count*_nb_symbols], (void *) symbol_data, _nb_symbols*sizeof(float));
+        unsigned int column = ingest_column(_message_symbol_count);
+        memcpy((void *) &_matrix[column*_nb_symbols], (void *) symbol_data, _nb_symbols*sizeof(float));
         _message_symbol_count++;
     }
 }
@@ -76,7 +119,8 @@ void CC_ReliabilityMatrix::enter_symbol_data(unsigned int message_symbol_index,
 {
     if (message_symbol_index < _message_length)
     {
-        memcpy((void *) &_matrix[message_symbol_index*_nb_symbols], (void *) symbol_data, _nb_symbols*sizeof(float));
+        unsigned int column = ingest_column(message_symbol_index);
+        memcpy((void *) &_matrix[column*_nb_symbols], (void *) symbol_data, _nb_symbols*sizeof(float));
     }
 }
 
@@ -85,9 +129,11 @@ void CC_ReliabilityMatrix::enter_erasure()
 {
     if (_message_symbol_count < _message_length)
     {
+        unsigned int column = ingest_column(_message_symbol_count);
+
         for (unsigned int i=0; i<_nb_symbols; i++)
         {
-            _matrix[_message_symbol_count*_nb_symbols + i] = 0.0;
+            _matrix[column*_nb_symbols + i] = 0.0;
         }
         
         _message_symbol_count++;
@@ -99,9 +145,11 @@ void CC_ReliabilityMatrix::enter_erasure(unsigned int message_symbol_index)
 {
     if (message_symbol_index < _message_length)
     {
+        unsigned int column = ingest_column(message_symbol_index);
+
         for (unsigned int i=0; i<_nb_symbols; i++)
         {
-            _matrix[message_symbol_index*_nb_symbols + i] = 0.0;
+            _matrix[column*_nb_symbols + i] = 0.0;
         }
     }
 }
@@ -202,36 +250,13 @@ std::ostream& operator <<(std::ostream& os, const CC_ReliabilityMatrix& matrix)
 // ================================================================================================
 void CC_ReliabilityMatrix::deinterleave()
 {
-	 float *tmp_matrix = new float[_nb_symbols*_message_length];
-     memcpy((void *) tmp_matrix, (void *) _matrix, _nb_symbols*_message_length*sizeof(float));
-
-     unsigned int index_size = (unsigned int) (log(_message_length)/log(2)) + 1;
-     unsigned int index_max = 1<<index_size;
-     unsigned int new_index, s, iv;
-     unsigned int old_index = 0;
-
-     for (unsigned int i=0; (i<index_max) && (old_index<_message_length); i++)
-     {
-         new_index = 0;
-         s = index_size;
-         iv = i;
-
-         for (; iv; iv >>= 1) // bit reversal
-         {
-             new_index |= iv & 1;
-             new_index <<= 1;
-             s--;
-         }
-
-         new_index >>= 1; // the last shift right was too much
-         new_index <<= s; // account for leading zeroes
-
-         if (new_index < _message_length)
-         {
-        	 memcpy((void *) &(_matrix[old_index*_nb_symbols]), (void *) &(tmp_matrix[new_index*_nb_symbols]), _nb_symbols*sizeof(float));
-             old_index++;
-         }
-     }
+    if (!_bitreversal_permutation)
+    {
+        _bitreversal_permutation = new CC_InterleaverPermutation(CC_Interleaver_BitReversal, _message_length);
+        _tmp_column.resize(_nb_symbols);
+    }
+
+    _bitreversal_permutation->apply_blocks(_matrix, _nb_symbols, &_tmp_column[0], false);
 }
 
 } // namespace ccsoft
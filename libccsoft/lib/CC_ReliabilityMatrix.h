@@ -26,10 +26,13 @@
 #define __CC_RELIABILITY_MATRIX_H__
 
 #include <iostream>
+#include <vector>
 
 namespace ccsoft
 {
 
+class CC_InterleaverPermutation;
+
 /**
  * \brief Reliability Matrix class. Analog data is entered first then the normalization method is called to get the actual reliability data (probabilities).
  */
@@ -53,6 +56,15 @@ public:
      */
     ~CC_ReliabilityMatrix();
 
+    /**
+     * Deinterleave on ingest: symbol data is then entered in channel (interleaved) order and each column is written
+     * directly at its deinterleaved position so that deinterleave() need not be called afterwards. The columns entered
+     * so far are forgotten.
+     * \param permutation Interleaver permutation of message_length symbols e.g. from CC_Interleaver::get_permutation.
+     * It is not copied and must outlive its use by the matrix. 0 to enter symbol data in message order again.
+     */
+    void set_deinterleaving(const CC_InterleaverPermutation *permutation);
+
     /**
      * Enter one more symbol position data
      * \param symbol_data Pointer to symbol data array. There must be nb_symbol values corresponding to the relative reliability of each symbol for the current symbol position in the message
@@ -61,7 +73,7 @@ public:
 
     /**
      * Enter symbol position data at given message symbol position
-     * \param message_symbol_index Position of the symbol in the message
+     * \param message_symbol_index Position of the symbol in the message or in the channel when deinterleaving on ingest
      * \param symbol_data Pointer to symbol data array. There must be nb_symbol values corresponding to the relative reliability of each symbol for the current symbol position in the message
      */
     void enter_symbol_data(unsigned int message_symbol_index, float *symbol_data);
@@ -72,7 +84,7 @@ public:
     void enter_erasure();
 
     /**
-     * Enter an erasure at a given symbol position. This is done by zeroing out the corresponding column in the matrix thus neutralizing it for further multiplicity calculation.
+     * Enter an erasure at a given symbol position (in the channel when deinterleaving on ingest). This is done by zeroing out the corresponding column in the matrix thus neutralizing it for further multiplicity calculation.
      */
     void enter_erasure(unsigned int message_symbol_index);
 
@@ -87,6 +99,18 @@ public:
     void reset_message_symbol_count()
     {
         _message_symbol_count = 0;
+        _nb_ready_columns = 0;
+        _column_entered.assign(_column_entered.size(), false);
+    }
+
+    /**
+     * Number of consecutive columns from the start of the message that have been entered. When deinterleaving on
+     * ingest a decoder that consumes columns one at a time (e.g. CC_StackStreamDecoding) can be fed this prefix
+     * before the whole frame has arrived.
+     */
+    unsigned int get_nb_ready_columns() const
+    {
+        return _nb_ready_columns;
     }
 
     /**
@@ -159,7 +183,8 @@ public:
     float find_max_in_col(unsigned int& i_row, unsigned int i_col, float prev_max = 1.0) const;
 
     /**
-     * Deinterleave matrix columns
+     * Deinterleave matrix columns in place with the bit reversal interleaver. The permutation and the temporary column
+     * are built on the first call and kept with the matrix. Use CC_Interleaver::deinterleave to use another interleaver.
      */
     void deinterleave();
 
@@ -175,6 +200,17 @@ protected:
     unsigned int _message_length;
     unsigned int _message_symbol_count; //!< incremented each time a new message symbol data is entered
     float *_matrix; //!< The reliability matrix stored column first
+    const CC_InterleaverPermutation *_deinterleaving; //!< Permutation applied on ingest or 0
+    std::vector<bool> _column_entered; //!< Tells which columns were entered when deinterleaving on ingest
+    unsigned int _nb_ready_columns; //!< Number of consecutive columns entered from the start of the message
+    CC_InterleaverPermutation *_bitreversal_permutation; //!< Permutation of deinterleave() built on first use or 0
+    std::vector<float> _tmp_column; //!< Temporary column of deinterleave()
+
+    /**
+     * Get the column of a symbol position entered and update the ready columns count
+     * \param message_symbol_index Position of the symbol in the message or in the channel when deinterleaving on ingest
+     */
+    unsigned int ingest_column(unsigned int message_symbol_index);
 };
 
 
@@ -27,6 +27,11 @@
 #include "CC_Encoding.h"
 #include "CC_ReliabilityMatrix.h"
 #include "CC_Interleaver.h"
+#include "CC_NodeEdgeOrdering.h"
+#include "CC_TreeNodeEdge_base.h"
+#include "CCSoft_Exception.h"
+#include "CC_DecodingBudget.h"
+#include "CC_DecodeStats.h"
 
 #include <cmath>
 #include <algorithm>
@@ -37,49 +42,6 @@
 namespace ccsoft
 {
 
-/**
- * \brief class used for node ordering
- */
-class NodeEdgeOrdering
-{
-public:
-	NodeEdgeOrdering(float _path_metric, unsigned int _node_id) :
-        path_metric(_path_metric),
-        node_id(_node_id)
-    {}
-
-    ~NodeEdgeOrdering()
-    {}
-
-    bool operator>(const NodeEdgeOrdering& other) const
-    {
-        if (path_metric == other.path_metric)
-        {
-            return node_id > other.node_id;
-        }
-        else
-        {
-            return path_metric > other.path_metric;
-        }
-    }
-
-    float path_metric;
-    unsigned int node_id;
-};
-
-template<typename T_NodeEdge>
-bool node_edge_pointer_ordering(T_NodeEdge* n1, T_NodeEdge* n2)
-{
-    if (n1->get_path_metric() == n2->get_path_metric())
-    {
-        return n1->get_id() > n2->get_id();
-    }
-    else
-    {
-        return n1->get_path_metric() > n2->get_path_metric();
-    }
-}
-
 /**
  * \brief Convolutional soft-decision sequential decoder generic (virtual) class. This is the public interface.
  * \tparam T_Register Type of the encoder internal registers
@@ -111,8 +73,19 @@ public:
                 node_count(0),
                 tail_zeros(true),
                 edge_bias(0.0),
-                verbosity(0)
-	{}
+                verbosity(0),
+                status(CC_Decoding_Success)
+	{
+        if (encoding.get_total_register_length() > 8*sizeof(unsigned long long))
+        {
+            throw CCSoft_Exception("Sum of register lengths too large to pack the encoder state in a code tree node");
+        }
+
+        if (encoding.get_k() > CC_TreeNodeEdge_base<T_IOSymbol, CC_TreeNodeEdgeTag_Empty>::in_symbol_bits)
+        {
+            throw CCSoft_Exception("Input symbol too large to be stored in a code tree node");
+        }
+	}
 
 	/**
 	 * Destructor
@@ -155,6 +128,40 @@ public:
         use_metric_limit = false;
     }
 
+    /**
+     * Set the wall clock time limit of a decode. When it is reached the decode returns the best partial path.
+     * \param time_limit Time limit in seconds
+     */
+    void set_time_limit(double time_limit)
+    {
+        budget.set_time_limit(time_limit);
+    }
+
+    /**
+     * Reset the wall clock time limit
+     */
+    void reset_time_limit()
+    {
+        budget.reset_time_limit();
+    }
+
+    /**
+     * Set the move limit of a decode. When it is reached the decode returns the best partial path.
+     * \param move_limit Maximum number of iterations of the decoding algorithm main loop
+     */
+    void set_move_limit(unsigned int move_limit)
+    {
+        budget.set_move_limit(move_limit);
+    }
+
+    /**
+     * Reset the move limit
+     */
+    void reset_move_limit()
+    {
+        budget.reset_move_limit();
+    }
+
     /**
      * Set the tail zeros option
      */
@@ -172,6 +179,7 @@ public:
         codeword_score = 0.0;
         cur_depth = -1;
         max_depth = 0;
+        status = CC_Decoding_Success;
         encoding.clear(); // clear encoder's registers
     }
 
@@ -191,6 +199,31 @@ public:
         return codeword_score;
     }
 
+    /**
+     * Get the status of the last decode
+     */
+    CC_DecodingStatus get_status() const
+    {
+        return status;
+    }
+
+    /**
+     * Get the status of the last decode as a human readable string
+     */
+    const char *get_status_string() const
+    {
+        return get_decoding_status_string(status);
+    }
+
+    /**
+     * Tells if the decoded message of the last decode is a full codeword. When false it is the best partial path
+     * found before a limit was reached (possibly empty).
+     */
+    bool is_reliable() const
+    {
+        return status == CC_Decoding_Success;
+    }
+
     /**
      * Get the codeword score in dB/Symbol units. Valid only if decode returned successfully.
      */
@@ -246,6 +279,22 @@ public:
         verbosity = _verbosity;
     }
 
+    /**
+     * Get the effort statistics of the last decode. Derived classes add the counters specific to their algorithm.
+     */
+    virtual CC_DecodeStats get_decode_stats() const
+    {
+        CC_DecodeStats stats;
+        stats.status = status;
+        stats.score = codeword_score;
+        stats.nb_nodes = node_count;
+        stats.nb_effective_nodes = node_count;
+        stats.nb_moves = budget.get_nb_moves();
+        stats.max_depth = max_depth;
+        stats.elapsed_ns = budget.get_elapsed_ns();
+        return stats;
+    }
+
     /**
      * Print the dot (Graphviz) file of the current decode tree to an output stream
      * \param os Output stream
@@ -286,6 +335,8 @@ protected:
     bool tail_zeros;          //!< True if tail of m-1 zeros in the message are assumed. This is the default option.
     float edge_bias;          //!< Edge metric bias subtracted from log2 of reliability of the edge
     unsigned int verbosity;   //!< Verbosity level
+    CC_DecodingBudget budget; //!< Work and time budgets of a decode
+    CC_DecodingStatus status; //!< Status of the last decode
 };
 
 } // namespace ccsoft
@@ -25,11 +25,15 @@
 #define __CC_SEQUENTIAL_DECODING_INERNAL_FA_H__
 
 #include "CC_TreeNodeEdge_FA.h"
+#include "CC_TreeNodeEdgePool.h"
 #include "CC_ReliabilityMatrix.h"
+#include "CC_EdgeMetrics.h"
+#include "CCSoft_Exception.h"
 #include "CC_TreeGraphviz_FA.h"
 
 #include <algorithm>
 #include <iostream>
+#include <new>
 
 
 
@@ -62,40 +66,39 @@ public:
      * of generators should follow the same convention.
      */
 	CC_SequentialDecodingInternal_FA() :
-        root_node(0)
+        root_node(0),
+        node_edge_pool(CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>::get_record_size(), 1<<N_k)
 	{}
 
 	/**
 	 * Destructor
 	 */
 	virtual ~CC_SequentialDecodingInternal_FA()
-	{
-        if (root_node)
-        {
-            delete root_node;
-            root_node = 0;
-        }
-	}
+	{}
 
     /**
      * Reset the decoding process
      */
     void reset()
     {
-        if (root_node)
-        {
-            delete root_node;
-            root_node = 0;
-        }
+        node_edge_pool.clear(); // releases the whole tree at once
+        root_node = 0;
     }
 
 protected:
     /**
-     * Base 2 logarithm
+     * Compute the edge metrics for the whole reliability matrix. Done once at the start of each decode.
+     * \param relmat Reliability matrix reference
+     * \param edge_bias Edge metric bias subtracted from log2 of reliability of the edge
      */
-    float log2(float x)
+    void init_edge_metrics(const CC_ReliabilityMatrix& relmat, float edge_bias)
     {
-        return log(x)/log(2.0);
+        if (relmat.get_message_length() > (unsigned int) CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>::max_depth)
+        {
+            throw CCSoft_Exception("Message is too long for the code tree node depth range");
+        }
+
+        edge_metrics.init(relmat, edge_bias);
     }
 
     /**
@@ -103,7 +106,57 @@ protected:
      */
     void init_root()
     {
-        root_node = new CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>(0, 0, 0, 0.0, 0.0, -1);
+        root_node = new_node_edge(0, 0, 0.0, -1, 0);
+    }
+
+    /**
+     * Allocate a new node+edge from the pool and link it to its incoming node+edge
+     * \param p_incoming_node_edge Pointer to the incoming node+edge or 0 for the root node
+     * \param in_symbol Input symbol corresponding to the edge
+     * \param path_metric Path metric at the node
+     * \param depth Node depth
+     * \param state Packed encoder registers at the node
+     */
+    CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k> *new_node_edge(CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k> *p_incoming_node_edge,
+            const T_IOSymbol& in_symbol,
+            float path_metric,
+            int depth,
+            unsigned long long state)
+    {
+        unsigned int index;
+        void *record = node_edge_pool.allocate(index);
+        unsigned int incoming_index = (p_incoming_node_edge ? p_incoming_node_edge->get_id() : CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>::null_index);
+        CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k> *node_edge = new (record) CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>(index, incoming_index, in_symbol, path_metric, depth, state);
+
+        if (p_incoming_node_edge)
+        {
+            p_incoming_node_edge->set_outgoing_index(in_symbol, index);
+        }
+
+        return node_edge;
+    }
+
+    /**
+     * Get the incoming node+edge of a node+edge
+     * \param node_edge Node+edge
+     * \return Pointer to the incoming node+edge or 0 for the root node
+     */
+    CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k> *get_incoming_node_edge(const CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k> *node_edge) const
+    {
+        unsigned int incoming_index = node_edge->get_incoming_index();
+        return (incoming_index == CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>::null_index ? 0 : node_edge_pool.get(incoming_index));
+    }
+
+    /**
+     * Get an outgoing node+edge of a node+edge
+     * \param node_edge Node+edge
+     * \param in_symbol Input symbol of the outgoing edge
+     * \return Pointer to the outgoing node+edge or 0 if it has not been created
+     */
+    CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k> *get_outgoing_node_edge(const CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k> *node_edge, unsigned int in_symbol) const
+    {
+        unsigned int outgoing_index = node_edge->get_outgoing_index(in_symbol);
+        return (outgoing_index == CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>::null_index ? 0 : node_edge_pool.get(outgoing_index));
     }
 
     /**
@@ -127,7 +180,7 @@ protected:
 
         reversed_message.push_back(cur_node_edge->get_in_symbol());
 
-        while (incoming_node_edge = (cur_node_edge->get_incoming_node_edge()))
+        while ((incoming_node_edge = get_incoming_node_edge(cur_node_edge)))
         {
             cur_node_edge->set_on_final_path(mark_nodes);
 
@@ -143,16 +196,54 @@ protected:
         std::reverse_copy(reversed_message.begin(), reversed_message.end(), decoded_message.begin());
     }
 
+    /**
+     * Back track from a terminal node writing the message in place. Does not allocate.
+     * \param node_edge Node to track back from
+     * \param message Storage of at least depth+1 symbols receiving the symbols from the root node to the given node
+     * \param mark_nodes Mark the nodes along the path. Marks of other paths are left untouched.
+     */
+    void back_track_into(CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>* node_edge, T_IOSymbol *message, bool mark_nodes = false)
+    {
+        for (CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k> *cur_node_edge = node_edge; cur_node_edge->get_depth() >= 0; cur_node_edge = get_incoming_node_edge(cur_node_edge))
+        {
+            message[cur_node_edge->get_depth()] = cur_node_edge->get_in_symbol();
+
+            if (mark_nodes)
+            {
+                cur_node_edge->set_on_final_path(true);
+            }
+        }
+    }
+
+    /**
+     * Retrieve the best effort partial message when the decode stops before reaching a terminal node
+     * \param node_edge Last node of the best partial path or 0 if there is none
+     * \param decoded_message Symbols corresponding to the edges from the root node to the given node
+     */
+    void back_track_partial(CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>* node_edge, std::vector<T_IOSymbol>& decoded_message)
+    {
+        if (node_edge && (node_edge->get_depth() >= 0))
+        {
+            back_track(node_edge, decoded_message);
+        }
+        else
+        {
+            decoded_message.clear();
+        }
+    }
+
     /**
      * Print the code tree in Graphviz dot format
      * \param os Output stream
      */
     void print_dot_internal(std::ostream& os)
     {
-        CC_TreeGraphviz_FA<T_IOSymbol, T_Register, T_Tag, N_k>::create_dot(root_node, os);
+        CC_TreeGraphviz_FA<T_IOSymbol, T_Register, T_Tag, N_k>::create_dot(root_node, node_edge_pool, os);
     }
     
     CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k> *root_node; //!< Root node
+    CC_TreeNodeEdgePool<CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k> > node_edge_pool; //!< Storage of the code tree node+edges
+    CC_EdgeMetrics edge_metrics; //!< Biased log2 reliabilities computed once per decode
 };
 
 
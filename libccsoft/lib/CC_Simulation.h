@@ -0,0 +1,443 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Monte-Carlo simulation of the bit and frame error rates over an AWGN or
+ Rayleigh channel running frames on a set of worker threads. Needs C++11
+ (-std=c++0x -pthread).
+
+ */
+#ifndef __CC_SIMULATION_H__
+#define __CC_SIMULATION_H__
+
+#include "CC_ReliabilityMatrix.h"
+#include "CC_Channel.h"
+#include "CC_DecodeStatsAggregator.h"
+
+#include <time.h>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+
+namespace ccsoft
+{
+
+/**
+ * \brief Error counts of the frames simulated at one SNR
+ */
+struct CC_SimulationPoint
+{
+    CC_SimulationPoint(float _snr_dB = 0.0) :
+        snr_dB(_snr_dB),
+        nb_frames(0),
+        nb_frame_errors(0),
+        nb_decode_failures(0),
+        nb_bits(0),
+        nb_bit_errors(0),
+        nb_nodes(0),
+        elapsed(0.0)
+    {}
+
+    /**
+     * Frame error rate
+     */
+    double get_fer() const
+    {
+        return (nb_frames ? ((double) nb_frame_errors) / nb_frames : 0.0);
+    }
+
+    /**
+     * Bit error rate of the information bits
+     */
+    double get_ber() const
+    {
+        return (nb_bits ? ((double) nb_bit_errors) / nb_bits : 0.0);
+    }
+
+    float snr_dB;                          //!< SNR in dB
+    unsigned long long nb_frames;          //!< Number of frames simulated
+    unsigned long long nb_frame_errors;    //!< Number of frames not decoded to the sent message including decode failures
+    unsigned long long nb_decode_failures; //!< Number of frames the decoder gave up on
+    unsigned long long nb_bits;            //!< Number of information bits sent (tail excluded)
+    unsigned long long nb_bit_errors;      //!< Number of information bits in error
+    unsigned long long nb_nodes;           //!< Number of nodes created by the decoders
+    double elapsed;                        //!< Wall clock time in seconds
+};
+
+/**
+ * \brief Simulates frames of random messages sent over a channel (see CC_Channel) and decoded on a set of worker
+ * threads each owning a decoder instance.
+ *
+ * Each frame draws its message and noise from its own random stream seeded from the simulation seed and the frame
+ * index. Frames are run in batches and counted in frame order up to the frame where the target number of frame errors
+ * is reached so that the results depend only on the seed and not on the number of threads or their scheduling. The
+ * same seeds are used at each SNR (common random numbers) which smooths the error rate curves.
+ *
+ * \tparam T_Decoding Decoder class. It must implement decode(relmat, decoded_message), get_nb_nodes(),
+ * get_decode_stats() and get_encoding() like the CC_SequentialDecoding and CC_SequentialDecoding_FA classes.
+ * \tparam T_IOSymbol Type of the input and output symbols
+ */
+template<typename T_Decoding, typename T_IOSymbol>
+class CC_Simulation
+{
+public:
+    typedef std::function<T_Decoding*()> DecoderFactory; //!< Creates a new configured decoder instance
+
+    /**
+     * Constructor
+     * \param decoder_factory Creates one decoder per worker thread. Decoders are deleted by the simulation.
+     * \param _nb_symbols Number of random message symbols of a frame. The m-1 zero symbols of the tail are added.
+     * \param _nb_threads Number of worker threads. 0 to use the number of hardware threads.
+     */
+    CC_Simulation(const DecoderFactory& decoder_factory, unsigned int _nb_symbols, unsigned int _nb_threads = 0) :
+        nb_symbols(_nb_symbols),
+        nb_threads(_nb_threads > 0 ? _nb_threads : std::max(std::thread::hardware_concurrency(), 1U)),
+        seed(0),
+        channel_model(CC_Channel_AWGN),
+        max_frames(1000),
+        target_frame_errors(0),
+        batch_size(0),
+        stats_aggregator(0)
+    {
+        for (unsigned int i=0; i<nb_threads; i++)
+        {
+            decoders.push_back(decoder_factory());
+        }
+    }
+
+    /**
+     * Destructor. Deletes the decoders.
+     */
+    ~CC_Simulation()
+    {
+        for (unsigned int i=0; i<decoders.size(); i++)
+        {
+            delete decoders[i];
+        }
+    }
+
+    /**
+     * Number of worker threads
+     */
+    unsigned int get_nb_threads() const
+    {
+        return nb_threads;
+    }
+
+    /**
+     * Set the seed the random stream of each frame is derived from
+     */
+    void set_seed(unsigned int _seed)
+    {
+        seed = _seed;
+    }
+
+    /**
+     * Set the channel model (default AWGN)
+     */
+    void set_channel_model(CC_ChannelModel _channel_model)
+    {
+        channel_model = _channel_model;
+    }
+
+    /**
+     * Set the maximum number of frames simulated at each SNR
+     */
+    void set_max_frames(unsigned long long _max_frames)
+    {
+        max_frames = _max_frames;
+    }
+
+    /**
+     * Set the number of frame errors after which the simulation of an SNR stops early
+     * \param _target_frame_errors Number of frame errors or 0 to always run the maximum number of frames (default)
+     */
+    void set_target_frame_errors(unsigned long long _target_frame_errors)
+    {
+        target_frame_errors = _target_frame_errors;
+    }
+
+    /**
+     * Set the number of frames shared by the workers between two checks of the target number of frame errors
+     * \param _batch_size Number of frames or 0 for 16 frames per worker thread (default)
+     */
+    void set_batch_size(unsigned int _batch_size)
+    {
+        batch_size = _batch_size;
+    }
+
+    /**
+     * Set the aggregator the statistics of the decode of each counted frame are added to
+     * \param _stats_aggregator Pointer to the aggregator or 0 for none (default)
+     */
+    void set_stats_aggregator(CC_DecodeStatsAggregator *_stats_aggregator)
+    {
+        stats_aggregator = _stats_aggregator;
+    }
+
+    /**
+     * Seed of the random stream of a frame. The seed and frame index are mixed with the SplitMix64 finalizer so that
+     * consecutive frames get unrelated seeds.
+     */
+    static unsigned long long get_frame_seed(unsigned int seed, unsigned long long frame_index)
+    {
+        unsigned long long z = (((unsigned long long) seed) << 32) + frame_index + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * Simulate frames at one SNR until the maximum number of frames or the target number of frame errors is reached
+     * \param snr_dB SNR in dB
+     * \param point Error counts
+     */
+    void run(float snr_dB, CC_SimulationPoint& point)
+    {
+        timespec time1, time2;
+        clock_gettime(CLOCK_MONOTONIC, &time1);
+        unsigned int nb_batch_frames = (batch_size > 0 ? batch_size : 16*nb_threads);
+        std::vector<FrameResult> results;
+        point = CC_SimulationPoint(snr_dB);
+        bool target_reached = false;
+
+        while ((point.nb_frames < max_frames) && !target_reached)
+        {
+            unsigned long long first_frame = point.nb_frames;
+            unsigned int nb_frames = (unsigned int) std::min((unsigned long long) nb_batch_frames, max_frames - first_frame);
+            run_batch(snr_dB, first_frame, nb_frames, results);
+
+            for (unsigned int i=0; (i<nb_frames) && !target_reached; i++) // count in frame order
+            {
+                point.nb_frames++;
+                point.nb_bits += results[i].nb_bits;
+                point.nb_bit_errors += results[i].nb_bit_errors;
+                point.nb_nodes += results[i].nb_nodes;
+
+                if (stats_aggregator)
+                {
+                    stats_aggregator->add(results[i].stats);
+                }
+
+                if (!results[i].success)
+                {
+                    point.nb_decode_failures++;
+                }
+
+                if (!results[i].success || (results[i].nb_bit_errors > 0))
+                {
+                    point.nb_frame_errors++;
+                    target_reached = (target_frame_errors > 0) && (point.nb_frame_errors >= target_frame_errors);
+                }
+            }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &time2);
+        point.elapsed = (time2.tv_sec - time1.tv_sec) + (time2.tv_nsec - time1.tv_nsec) / 1e9;
+    }
+
+    /**
+     * Simulate frames at each SNR of a list
+     * \param snrs_dB SNRs in dB
+     * \param points Error counts in the order of the SNRs
+     */
+    void run(const std::vector<float>& snrs_dB, std::vector<CC_SimulationPoint>& points)
+    {
+        points.clear();
+        points.resize(snrs_dB.size());
+
+        for (unsigned int i=0; i<snrs_dB.size(); i++)
+        {
+            run(snrs_dB[i], points[i]);
+        }
+    }
+
+    /**
+     * Print the error rates as a table with one line per SNR
+     * \param os Output stream
+     * \param points Error counts
+     * \param prefix Prefix of each line e.g. to grep the table out of other output
+     */
+    static void print_table(std::ostream& os, const std::vector<CC_SimulationPoint>& points, const char *prefix = "")
+    {
+        os << prefix << std::setw(8) << "snr_dB" << std::setw(10) << "frames" << std::setw(10) << "f_errors"
+                << std::setw(10) << "failures" << std::setw(14) << "FER" << std::setw(12) << "b_errors"
+                << std::setw(14) << "BER" << std::setw(12) << "nodes/f" << std::setw(10) << "time_s" << std::endl;
+
+        for (std::vector<CC_SimulationPoint>::const_iterator it = points.begin(); it != points.end(); ++it)
+        {
+            os << prefix << std::setw(8) << it->snr_dB << std::setw(10) << it->nb_frames << std::setw(10) << it->nb_frame_errors
+                    << std::setw(10) << it->nb_decode_failures << std::setw(14) << it->get_fer() << std::setw(12) << it->nb_bit_errors
+                    << std::setw(14) << it->get_ber() << std::setw(12) << (it->nb_frames ? ((double) it->nb_nodes) / it->nb_frames : 0.0)
+                    << std::setw(10) << it->elapsed << std::endl;
+        }
+    }
+
+protected:
+    /**
+     * \brief Outcome of one frame
+     */
+    struct FrameResult
+    {
+        bool success;               //!< Value returned by the decoder
+        unsigned int nb_bits;       //!< Number of information bits
+        unsigned int nb_bit_errors; //!< Number of information bits in error
+        unsigned int nb_nodes;      //!< Number of nodes created by the decoder
+        CC_DecodeStats stats;       //!< Statistics of the decode
+    };
+
+    /**
+     * Run a batch of consecutive frames on the worker threads. Workers take the next frame from a shared counter.
+     */
+    void run_batch(float snr_dB, unsigned long long first_frame, unsigned int nb_frames, std::vector<FrameResult>& results)
+    {
+        results.resize(nb_frames);
+        next_frame.store(0);
+        worker_exception = std::exception_ptr();
+        std::vector<std::thread> threads;
+
+        for (unsigned int i=1; i<nb_threads; i++)
+        {
+            threads.push_back(std::thread(&CC_Simulation::work, this, i, snr_dB, first_frame, nb_frames, &results));
+        }
+
+        work(0, snr_dB, first_frame, nb_frames, &results); // calling thread is worker #0
+
+        for (unsigned int i=0; i<threads.size(); i++)
+        {
+            threads[i].join();
+        }
+
+        if (worker_exception)
+        {
+            std::rethrow_exception(worker_exception);
+        }
+    }
+
+    /**
+     * Worker thread loop: generate, encode, add noise and decode frames until the batch is exhausted
+     */
+    void work(unsigned int worker_index, float snr_dB, unsigned long long first_frame, unsigned int nb_frames, std::vector<FrameResult> *results)
+    {
+        try
+        {
+            T_Decoding& decoder = *decoders[worker_index];
+            CC_Channel channel(channel_model);
+            channel.set_snr(snr_dB);
+            unsigned int k = decoder.get_encoding().get_k();
+            unsigned int message_length = nb_symbols + decoder.get_encoding().get_m() - 1;
+            CC_ReliabilityMatrix relmat(decoder.get_encoding().get_n(), message_length);
+            std::vector<T_IOSymbol> message(message_length, 0); // tail symbols stay zero
+            std::vector<T_IOSymbol> out_symbols(message_length);
+            std::vector<T_IOSymbol> decoded_message;
+            unsigned int frame_offset;
+
+            while ((frame_offset = next_frame.fetch_add(1)) < nb_frames)
+            {
+                FrameResult& result = (*results)[frame_offset];
+                channel.get_random().set_seed(get_frame_seed(seed, first_frame + frame_offset));
+                decoder.get_encoding().clear();
+                relmat.reset_message_symbol_count();
+
+                for (unsigned int i=0; i<nb_symbols; i++)
+                {
+                    message[i] = channel.get_random().rand_int(1<<k);
+                }
+
+                for (unsigned int i=0; i<message_length; i++)
+                {
+                    decoder.get_encoding().encode(message[i], out_symbols[i]);
+                }
+
+                channel.fill(relmat, out_symbols);
+                relmat.normalize();
+                result.success = decoder.decode(relmat, decoded_message);
+                result.nb_bits = nb_symbols * k;
+                result.nb_bit_errors = count_bit_errors(message, decoded_message, k);
+                result.nb_nodes = decoder.get_nb_nodes();
+
+                if (stats_aggregator)
+                {
+                    result.stats = decoder.get_decode_stats();
+                }
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(exception_mutex);
+
+            if (!worker_exception)
+            {
+                worker_exception = std::current_exception();
+            }
+
+            next_frame.store(nb_frames); // let the other workers finish early
+        }
+    }
+
+    /**
+     * Number of information bits in error. Symbols missing from the decoded message (the best partial path of a
+     * failed decode) count as k errors each.
+     */
+    unsigned int count_bit_errors(const std::vector<T_IOSymbol>& message, const std::vector<T_IOSymbol>& decoded_message, unsigned int k) const
+    {
+        unsigned int nb_bit_errors = 0;
+
+        for (unsigned int i=0; i<nb_symbols; i++)
+        {
+            if (i < decoded_message.size())
+            {
+                T_IOSymbol diff = message[i] ^ decoded_message[i];
+
+                for (; diff; diff &= diff - 1) // clear the lowest set bit
+                {
+                    nb_bit_errors++;
+                }
+            }
+            else
+            {
+                nb_bit_errors += k;
+            }
+        }
+
+        return nb_bit_errors;
+    }
+
+    unsigned int nb_symbols;                 //!< Number of random message symbols of a frame
+    unsigned int nb_threads;                 //!< Number of worker threads
+    unsigned int seed;                       //!< Seed the frame seeds are derived from
+    CC_ChannelModel channel_model;           //!< Channel model
+    unsigned long long max_frames;           //!< Maximum number of frames at each SNR
+    unsigned long long target_frame_errors;  //!< Number of frame errors to stop at. 0 for none.
+    unsigned int batch_size;                 //!< Number of frames of a batch. 0 for 16 frames per thread.
+    std::vector<T_Decoding*> decoders;       //!< Decoder instance of each worker thread
+    std::atomic<unsigned int> next_frame;    //!< Offset in the batch of the next frame to simulate
+    std::mutex exception_mutex;              //!< Guards the worker exception
+    std::exception_ptr worker_exception;     //!< First exception thrown by a worker during the last batch
+    CC_DecodeStatsAggregator *stats_aggregator; //!< Aggregator of the decode statistics, 0 for none
+};
+
+} // namespace ccsoft
+
+#endif // __CC_SIMULATION_H__
@@ -0,0 +1,93 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Feeds the soft output of a convolutional decoder to an outer
+ Reed-Solomon soft decision decoder (RSSoft) reliability matrix
+
+ */
+#ifndef __CC_SOFT_OUTPUT_ADAPTER_H__
+#define __CC_SOFT_OUTPUT_ADAPTER_H__
+
+#include "CCSoft_Exception.h"
+
+#include <vector>
+
+namespace ccsoft
+{
+
+/**
+ * Fill a Reed-Solomon reliability matrix with the a posteriori probabilities of the input symbols of the last message
+ * decoded by a soft output decoder. Each Reed-Solomon symbol of q bits is made of q/k consecutive input symbols of the
+ * convolutional code, the first one in the least significant bits. The probability of a Reed-Solomon symbol is the
+ * product of the probabilities of its input symbols (the interleaving between the codes is assumed to make them
+ * independent). Columns are computed in place in the matrix storage and sum to 1 so the matrix must not be normalized
+ * again. The matrix type is a template parameter so that this library does not depend on RSSoft.
+ * \tparam T_SoftDecoding Soft output decoder e.g. CC_MaxLogBCJRDecoding. It must implement get_message_length(),
+ * get_encoding().get_k() and get_symbol_probabilities(depth, probabilities).
+ * \tparam T_RSReliabilityMatrix Reed-Solomon reliability matrix e.g. rssoft::RS_ReliabilityMatrix. It must implement
+ * get_nb_symbols_log2(), get_message_length() and get_raw_matrix() giving column first storage.
+ * \param soft_decoding Soft output decoder after a successful decode
+ * \param rs_relmat Reed-Solomon reliability matrix. All its columns are filled.
+ * \param first_depth Depth of the convolutional code message where the Reed-Solomon codeword starts
+ */
+template<typename T_SoftDecoding, typename T_RSReliabilityMatrix>
+void fill_rs_reliability_matrix(T_SoftDecoding& soft_decoding, T_RSReliabilityMatrix& rs_relmat, unsigned int first_depth = 0)
+{
+    unsigned int k = soft_decoding.get_encoding().get_k();
+    unsigned int q = rs_relmat.get_nb_symbols_log2();
+
+    if (q % k != 0)
+    {
+        throw CCSoft_Exception("Reed-Solomon symbol size must be a multiple of the convolutional code input symbol size");
+    }
+
+    unsigned int symbols_per_column = q / k;
+
+    if (first_depth + rs_relmat.get_message_length()*symbols_per_column > soft_decoding.get_message_length())
+    {
+        throw CCSoft_Exception("Decoded message is too short for the Reed-Solomon reliability matrix");
+    }
+
+    std::vector<float> probabilities(1<<k);
+    float *column = rs_relmat.get_raw_matrix();
+
+    for (unsigned int ci=0; ci<rs_relmat.get_message_length(); ci++, column += (1<<q))
+    {
+        column[0] = 1.0;
+        unsigned int size = 1; // number of Reed-Solomon symbol values spanned by the input symbols done so far
+
+        // expand the product one input symbol at a time: value v gets the probability of its low bits times the
+        // probability of the new input symbol in the next k bits. Descending order keeps the low part intact until read.
+        for (unsigned int si=0; si<symbols_per_column; si++)
+        {
+            soft_decoding.get_symbol_probabilities(first_depth + ci*symbols_per_column + si, &probabilities[0]);
+
+            for (int value = (size << k) - 1; value >= 0; value--)
+            {
+                column[value] = column[value & (size - 1)] * probabilities[value / size];
+            }
+
+            size <<= k;
+        }
+    }
+}
+
+} // namespace ccsoft
+
+#endif // __CC_SOFT_OUTPUT_ADAPTER_H__
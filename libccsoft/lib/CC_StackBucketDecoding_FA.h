@@ -0,0 +1,328 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Convolutional soft-decision decoder based on the stack-bucket variant of the
+ Zigangirov-Jelinek (ZJ) algorithm. Path metrics are quantized into buckets
+ and the node to expand is taken from the highest non empty bucket.
+ Uses the node+edge combination in the code tree.
+
+ Uses fixed arrays
+
+ */
+#ifndef __CC_STACK_BUCKET_DECODING_FA_H__
+#define __CC_STACK_BUCKET_DECODING_FA_H__
+
+#include "CC_SequentialDecoding_FA.h"
+#include "CC_SequentialDecodingInternal_FA.h"
+#include "CC_Encoding_FA.h"
+#include "CCSoft_Exception.h"
+#include "CC_TreeNodeEdge_FA.h"
+#include "CC_ReliabilityMatrix.h"
+#include "CC_NodeEdgeBuckets.h"
+
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+
+namespace ccsoft
+{
+
+/**
+ * \brief The Stack-Bucket Decoding class with node+edge combination. Ordering within the stack is only approximate:
+ * nodes are sorted by bucket of path metric and taken last in first out inside a bucket.
+ * This version uses fixed arrays to store registers and forward node+edges pointers.
+ * N_k template parameter gives the size of the input symbol (k parameter) and therefore the number of registers.
+ * There are (1<<N_k) forward node+edges.
+ * \tparam T_Register Type of the encoder internal registers
+ * \tparam T_IOSymbol Type of the input and output symbols
+ * \tparam N_k Input symbol size in bits (k parameter)
+ * \tparam N_k Size of an input symbol in bits (k parameter)
+ */
+template<typename T_Register, typename T_IOSymbol, unsigned int N_k>
+class CC_StackBucketDecoding_FA : public CC_SequentialDecoding_FA<T_Register, T_IOSymbol, N_k>, public CC_SequentialDecodingInternal_FA<T_Register, T_IOSymbol, CC_TreeNodeEdgeTag_Empty, N_k>
+{
+public:
+    /**
+     * Constructor
+     * \param constraints Vector of register lengths (constraint length + 1). The number of elements determines k.
+     * \param genpoly_representations Generator polynomial numeric representations. There are as many elements as there
+     * are input bits (k). Each element is itself a vector with one polynomial value per output bit. The smallest size of
+     * these vectors is retained as the number of output bits n. The input bits of a symbol are clocked simultaneously into
+     * the right hand side, or least significant position of the internal registers. Therefore the given polynomial representation
+     * of generators should follow the same convention.
+     * \param _bucket_width Width of a bucket in path metric units
+     * \param _stack_size_limit Maximum number of nodes in the stack. Nodes in the lowest bucket are dropped above this limit (0 if not used)
+     */
+	CC_StackBucketDecoding_FA(const std::vector<unsigned int>& constraints,
+            const std::vector<std::vector<T_Register> >& genpoly_representations,
+            float _bucket_width = 1.0,
+            unsigned int _stack_size_limit = 0) :
+                CC_SequentialDecoding_FA<T_Register, T_IOSymbol, N_k>(constraints, genpoly_representations),
+                CC_SequentialDecodingInternal_FA<T_Register, T_IOSymbol, CC_TreeNodeEdgeTag_Empty, N_k>(),
+                node_edge_stack(_bucket_width),
+                stack_size_limit(_stack_size_limit),
+                nb_dropped(0)
+    {}
+
+    /**
+     * Destructor. Does a final garbage collection
+     */
+    virtual ~CC_StackBucketDecoding_FA()
+    {}
+
+    /**
+     * Reset the decoding process
+     */
+    void reset()
+    {
+        ParentInternal::reset();
+        Parent::reset();
+        node_edge_stack.clear();
+        nb_dropped = 0;
+    }
+
+    /**
+     * Set the stack size limit
+     * \param _stack_size_limit Maximum number of nodes in the stack (0 if not used)
+     */
+    void set_stack_size_limit(unsigned int _stack_size_limit)
+    {
+        stack_size_limit = _stack_size_limit;
+    }
+
+    /**
+     * Get the score at the top of the stack. Valid anytime the process has started (stack not empty).
+     */
+    float get_stack_score()
+    {
+        if (node_edge_stack.empty())
+        {
+            return 0.0;
+        }
+
+        return node_edge_stack.top_node_edge()->get_path_metric();
+    }
+
+    /**
+     * Get the stack size
+     */
+    unsigned int get_stack_size() const
+    {
+        return node_edge_stack.size();
+    }
+
+    /**
+     * Get the number of buckets used
+     */
+    unsigned int get_nb_buckets() const
+    {
+        return node_edge_stack.get_nb_buckets();
+    }
+
+    /**
+     * Get the number of nodes dropped from the stack because of the stack size limit
+     */
+    unsigned int get_nb_dropped() const
+    {
+        return nb_dropped;
+    }
+
+    /**
+     * Decodes given the reliability matrix
+     * \param relmat Reference to the reliability matrix
+     * \param decoded_message Vector of symbols of retrieved message
+     */
+    virtual bool decode(const CC_ReliabilityMatrix& relmat, std::vector<T_IOSymbol>& decoded_message)
+    {
+        if (relmat.get_message_length() < Parent::encoding.get_m())
+        {
+            throw CCSoft_Exception("Reliability Matrix should have a number of columns at least equal to the code constraint");
+        }
+
+        if (relmat.get_nb_symbols_log2() != Parent::encoding.get_n())
+        {
+            throw CCSoft_Exception("Reliability Matrix is not compatible with code output symbol size");
+        }
+
+        reset();
+        CC_DecodingBudgetScope budget_scope(Parent::budget);
+        ParentInternal::init_edge_metrics(relmat, Parent::edge_bias);
+        ParentInternal::init_root(); // initialize the root node
+        Parent::node_count++;
+        visit_node_forward(ParentInternal::root_node, relmat); // visit the root node
+        int last_depth = relmat.get_message_length() - 1;
+
+        // loop until we get to a terminal node or the metric limit is encountered hence the stack is empty
+        while ((node_edge_stack.size() > 0)
+            && (node_edge_stack.top_node_edge()->get_depth() < last_depth))
+        {
+            StackNodeEdge* node = node_edge_stack.top_node_edge();
+            node_edge_stack.pop(); // the node being expanded is the top node of the highest bucket
+            //std::cout << std::dec << node->get_id() << ":" << node->get_depth() << ":" << node->get_path_metric() << std::endl;
+            visit_node_forward(node, relmat);
+
+            Parent::status = Parent::budget.move();
+
+            if ((Parent::use_node_limit) && (Parent::node_count > Parent::node_limit))
+            {
+                Parent::status = CC_Decoding_NodeLimit;
+            }
+
+            if (Parent::status != CC_Decoding_Success) // give up with the best partial path i.e. the top of the stack
+            {
+                ParentInternal::back_track_partial((node_edge_stack.size() > 0 ? node_edge_stack.top_node_edge() : 0), decoded_message);
+                return false;
+            }
+        }
+
+        // Top node has the solution if we have not given up
+        if (!Parent::use_metric_limit || node_edge_stack.size() != 0)
+        {
+            ParentInternal::back_track(node_edge_stack.top_node_edge(), decoded_message, true); // back track from terminal node to retrieve decoded message
+            Parent::codeword_score = node_edge_stack.top_node_edge()->get_path_metric(); // the codeword score is the path metric
+            return true;
+        }
+        else
+        {
+            Parent::status = CC_Decoding_MetricLimit;
+            decoded_message.clear();
+            return false; // no solution
+        }
+    }
+
+    /**
+     * Get the effort statistics of the last decode
+     */
+    virtual CC_DecodeStats get_decode_stats() const
+    {
+        CC_DecodeStats stats = Parent::get_decode_stats();
+        stats.stack_size = get_stack_size();
+        return stats;
+    }
+
+    /**
+     * Print stats to an output stream
+     * \param os Output stream
+     * \param success True if decoding was successful
+     */
+    virtual void print_stats(std::ostream& os, bool success)
+    {
+        os << "score = " << Parent::get_score()
+                << " stack_score = " << get_stack_score()
+                << " #nodes = " << Parent::get_nb_nodes()
+                << " stack_size = " << get_stack_size()
+                << " max depth = " << Parent::get_max_depth()
+                << " buckets = " << get_nb_buckets()
+                << " dropped = " << get_nb_dropped();
+    }
+
+    /**
+     * Print stats summary to an output stream
+     * \param os Output stream
+     * \param success True if decoding was successful
+     */
+    virtual void print_stats_summary(std::ostream& os, bool success)
+    {
+        os << "_RES " << (success ? 1 : 0) << ","
+                << Parent::get_score() << ","
+                << get_stack_score() << ","
+                << Parent::get_nb_nodes() << ","
+                << get_stack_size() << ","
+                << Parent::get_max_depth() << ","
+                << get_nb_dropped();
+    }
+
+    /**
+     * Print the dot (Graphviz) file of the current decode tree to an output stream
+     * \param os Output stream
+     */
+    virtual void print_dot(std::ostream& os)
+    {
+        ParentInternal::print_dot_internal(os);
+    }
+
+protected:
+    typedef CC_SequentialDecoding_FA<T_Register, T_IOSymbol, N_k> Parent;                                       //!< Parent class this class inherits from
+    typedef CC_SequentialDecodingInternal_FA<T_Register, T_IOSymbol, CC_TreeNodeEdgeTag_Empty, N_k> ParentInternal; //!< Parent class this class inherits from
+    typedef CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, CC_TreeNodeEdgeTag_Empty, N_k> StackNodeEdge; //!< Class of code tree nodes in the stack algorithm
+
+    /**
+     * Visit a new node
+     * \node Node+edge combo to visit
+     * \relmat Reliability matrix being used
+     */
+    virtual void visit_node_forward(CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, CC_TreeNodeEdgeTag_Empty, N_k>* node_edge, const CC_ReliabilityMatrix& relmat)
+    {
+        int forward_depth = node_edge->get_depth() + 1;
+        T_IOSymbol out_symbol;
+        T_IOSymbol end_symbol;
+
+        unsigned long long state = node_edge->get_state(); // encoder state at this node
+
+        if ((Parent::tail_zeros) && (forward_depth > (int) (relmat.get_message_length()-Parent::encoding.get_m())))
+        {
+            end_symbol = 1; // if zero tail option assume tail symbols are all zeros
+        }
+        else
+        {
+            end_symbol = (1<<Parent::encoding.get_k()); // full scan all possible input symbols
+        }
+
+        // loop through assumption for this symbol place
+        for (T_IOSymbol in_symbol = 0; in_symbol < end_symbol; in_symbol++)
+        {
+            unsigned long long forward_state = Parent::encoding.get_next_packed_state(state, in_symbol);
+            out_symbol = Parent::encoding.get_output_symbol(forward_state);
+            float edge_metric = ParentInternal::edge_metrics(out_symbol, forward_depth);
+
+            float forward_path_metric = edge_metric + node_edge->get_path_metric();
+            if ((!Parent::use_metric_limit) || (forward_path_metric > Parent::metric_limit))
+            {
+                StackNodeEdge *next_node_edge = ParentInternal::new_node_edge(node_edge, in_symbol, forward_path_metric, forward_depth, forward_state); // add forward edge+node combo
+                node_edge_stack.push(forward_path_metric, next_node_edge);
+
+                if ((stack_size_limit > 0) && (node_edge_stack.size() > stack_size_limit))
+                {
+                    node_edge_stack.drop_bottom(); // node stays in the tree but will not be expanded
+                    nb_dropped++;
+                }
+
+                //std::cout << "->" << std::dec << node_count << ":" << forward_depth << " (" << (unsigned int) in_symbol << "," << (unsigned int) out_symbol << "): " << forward_path_metric << std::endl;
+                Parent::node_count++;
+            }
+        }
+
+        Parent::cur_depth = forward_depth; // new encoder position
+
+        if (Parent::cur_depth > Parent::max_depth)
+        {
+            Parent::max_depth = Parent::cur_depth;
+        }
+
+    }
+
+    CC_NodeEdgeBuckets<StackNodeEdge> node_edge_stack; //!< Stack of node+edge combos as buckets of path metric
+    unsigned int stack_size_limit; //!< Maximum number of nodes in the stack (0 if not used)
+    unsigned int nb_dropped;       //!< Number of nodes dropped from the stack because of the stack size limit
+};
+
+} // namespace ccsoft
+
+#endif
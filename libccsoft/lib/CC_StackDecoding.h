@@ -30,9 +30,11 @@
 #include "CCSoft_Exception.h"
 #include "CC_TreeNodeEdge.h"
 #include "CC_ReliabilityMatrix.h"
+#include "CC_NodeEdgeOrdering.h"
+#include "CC_DecodedList.h"
+#include "CC_TrellisStateIndex.h"
 
 #include <cmath>
-#include <map>
 #include <algorithm>
 #include <iostream>
 
@@ -61,7 +63,10 @@ public:
 	CC_StackDecoding(const std::vector<unsigned int>& constraints,
             const std::vector<std::vector<T_Register> >& genpoly_representations) :
                 CC_SequentialDecoding<T_Register, T_IOSymbol>(constraints, genpoly_representations),
-                CC_SequentialDecodingInternal<T_Register, T_IOSymbol, CC_TreeNodeEdgeTag_Empty>()
+                CC_SequentialDecodingInternal<T_Register, T_IOSymbol, CC_TreeNodeEdgeTag_Empty>(constraints.size()),
+                use_merge_detection(false),
+                merge_detection(false),
+                nb_merged(0)
     {}
 
     /**
@@ -78,6 +83,27 @@ public:
         ParentInternal::reset();
         Parent::reset();
         node_edge_stack.clear();
+        trellis_state_index.clear();
+        nb_merged = 0;
+    }
+
+    /**
+     * Set merge detection. When set, a path reaching an encoder state at a depth where a better path already went is
+     * not pushed on the stack and a path superseded after it was pushed is dropped when it comes to the top. The
+     * dropped paths can never beat the path they merge with so the decoded message is the same. It is not applied by
+     * decode_list since the next best messages may go through dominated paths.
+     */
+    void set_merge_detection(bool _use_merge_detection)
+    {
+        use_merge_detection = _use_merge_detection;
+    }
+
+    /**
+     * Get the number of paths dropped by merge detection during the last decode
+     */
+    unsigned int get_nb_merged() const
+    {
+        return nb_merged;
     }
 
     /**
@@ -85,7 +111,12 @@ public:
      */
     float get_stack_score() const
     {
-        return node_edge_stack.begin()->first.path_metric;
+        if (node_edge_stack.empty())
+        {
+            return 0.0;
+        }
+
+        return node_edge_stack.top().ordering.path_metric;
     }
 
     /**
@@ -114,21 +145,39 @@ public:
         }
 
         reset();
+        merge_detection = use_merge_detection;
+        CC_DecodingBudgetScope budget_scope(Parent::budget);
+        ParentInternal::init_edge_metrics(relmat, Parent::edge_bias);
         ParentInternal::init_root(); // initialize the root node
         Parent::node_count++;
         visit_node_forward(ParentInternal::root_node, relmat); // visit the root node
 
         // loop until we get to a terminal node or the metric limit is encountered hence the stack is empty
         while ((node_edge_stack.size() > 0)
-            && (node_edge_stack.begin()->second->get_depth() < relmat.get_message_length() - 1))
+            && (node_edge_stack.top_node_edge()->get_depth() < relmat.get_message_length() - 1))
         {
-            StackNodeEdge* node = node_edge_stack.begin()->second;
-            //std::cout << std::dec << node->get_id() << ":" << node->get_depth() << ":" << node_stack.begin()->first.path_metric << std::endl;
+            StackNodeEdge* node = node_edge_stack.top_node_edge();
+            node_edge_stack.pop(); // the node being expanded is always the top node
+
+            if (merge_detection && trellis_state_index.is_dominated(node->get_depth(), node->get_state(), node->get_path_metric()))
+            {
+                nb_merged++; // a better path went through the same state after this one was pushed
+                continue;
+            }
+
+            //std::cout << std::dec << node->get_id() << ":" << node->get_depth() << ":" << node->get_path_metric() << std::endl;
             visit_node_forward(node, relmat);
 
+            Parent::status = Parent::budget.move();
+
             if ((Parent::use_node_limit) && (Parent::node_count > Parent::node_limit))
             {
-                std::cerr << "Node limit exhausted" << std::endl;
+                Parent::status = CC_Decoding_NodeLimit;
+            }
+
+            if (Parent::status != CC_Decoding_Success) // give up with the best partial path i.e. the top of the stack
+            {
+                ParentInternal::back_track_partial((node_edge_stack.size() > 0 ? node_edge_stack.top_node_edge() : 0), decoded_message);
                 return false;
             }
         }
@@ -136,18 +185,101 @@ public:
         // Top node has the solution if we have not given up
         if (!Parent::use_metric_limit || node_edge_stack.size() != 0)
         {
-            //std::cout << "final: " << std::dec << node_stack.begin()->second->get_id() << ":" << node_stack.begin()->second->get_depth() << ":" << node_stack.begin()->first.path_metric << std::endl;
-            ParentInternal::back_track(node_edge_stack.begin()->second, decoded_message, true); // back track from terminal node to retrieve decoded message
-            Parent::codeword_score = node_edge_stack.begin()->first.path_metric; // the codeword score is the path metric
+            //std::cout << "final: " << std::dec << node_edge_stack.top_node_edge()->get_id() << ":" << node_edge_stack.top_node_edge()->get_depth() << ":" << node_edge_stack.top().ordering.path_metric << std::endl;
+            ParentInternal::back_track(node_edge_stack.top_node_edge(), decoded_message, true); // back track from terminal node to retrieve decoded message
+            Parent::codeword_score = node_edge_stack.top().ordering.path_metric; // the codeword score is the path metric
             return true;
         }
         else
         {
-            std::cerr << "Metric limit encountered" << std::endl;
+            Parent::status = CC_Decoding_MetricLimit;
+            decoded_message.clear();
             return false; // no solution
         }
     }
 
+    /**
+     * Decodes given the reliability matrix and returns the best terminal paths. Works like decode() but terminal
+     * nodes are taken off the stack as they come to the top until the list is full, the stack is exhausted or a limit
+     * is reached. Messages come out by decreasing path metric and the first one is the message decode() would return.
+     * \param relmat Reference to the reliability matrix
+     * \param decoded_list List receiving the decoded messages and their path metrics. Reuse it across decodes to avoid allocations.
+     * \param list_size Maximum number of messages
+     * \return true if at least one message was found. The status tells why the list is shorter than list_size if it is.
+     */
+    bool decode_list(const CC_ReliabilityMatrix& relmat, CC_DecodedList<T_IOSymbol>& decoded_list, unsigned int list_size)
+    {
+        if (relmat.get_message_length() < Parent::encoding.get_m())
+        {
+            throw CCSoft_Exception("Reliability Matrix should have a number of columns at least equal to the code constraint");
+        }
+
+        if (relmat.get_nb_symbols_log2() != Parent::encoding.get_n())
+        {
+            throw CCSoft_Exception("Reliability Matrix is not compatible with code output symbol size");
+        }
+
+        reset();
+        merge_detection = false;
+        decoded_list.clear(relmat.get_message_length(), list_size);
+        CC_DecodingBudgetScope budget_scope(Parent::budget);
+        ParentInternal::init_edge_metrics(relmat, Parent::edge_bias);
+        ParentInternal::init_root(); // initialize the root node
+        Parent::node_count++;
+        visit_node_forward(ParentInternal::root_node, relmat); // visit the root node
+        int last_depth = relmat.get_message_length() - 1;
+
+        while ((node_edge_stack.size() > 0) && (decoded_list.size() < list_size))
+        {
+            StackNodeEdge* node = node_edge_stack.top_node_edge();
+            node_edge_stack.pop();
+
+            if (node->get_depth() == last_depth) // terminal node: next best message
+            {
+                bool best = decoded_list.empty(); // mark the best path only
+                ParentInternal::back_track_into(node, decoded_list.add_message(node->get_path_metric()), best);
+                continue;
+            }
+
+            visit_node_forward(node, relmat);
+
+            Parent::status = Parent::budget.move();
+
+            if ((Parent::use_node_limit) && (Parent::node_count > Parent::node_limit))
+            {
+                Parent::status = CC_Decoding_NodeLimit;
+            }
+
+            if (Parent::status != CC_Decoding_Success) // give up with the messages found so far
+            {
+                break;
+            }
+        }
+
+        if (decoded_list.empty())
+        {
+            if (Parent::status == CC_Decoding_Success) // stack exhausted
+            {
+                Parent::status = (Parent::use_metric_limit ? CC_Decoding_MetricLimit : CC_Decoding_NoPath);
+            }
+
+            return false;
+        }
+
+        Parent::codeword_score = decoded_list.get_score(0);
+        return true;
+    }
+
+    /**
+     * Get the effort statistics of the last decode
+     */
+    virtual CC_DecodeStats get_decode_stats() const
+    {
+        CC_DecodeStats stats = Parent::get_decode_stats();
+        stats.stack_size = get_stack_size();
+        return stats;
+    }
+
     /**
      * Print stats to an output stream
      * \param os Output stream
@@ -155,11 +287,16 @@ public:
      */
     virtual void print_stats(std::ostream& os, bool success)
     {
-        std::cout << "score = " << Parent::get_score()
+        os << "score = " << Parent::get_score()
                 << " stack_score = " << get_stack_score()
                 << " #nodes = " << Parent::get_nb_nodes()
                 << " stack_size = " << get_stack_size()
                 << " max depth = " << Parent::get_max_depth();
+
+        if (use_merge_detection)
+        {
+            os << " merged = " << nb_merged;
+        }
     }
 
     /**
@@ -169,7 +306,7 @@ public:
      */
     virtual void print_stats_summary(std::ostream& os, bool success)
     {
-        std::cout << "_RES " << (success ? 1 : 0) << ","
+        os << "_RES " << (success ? 1 : 0) << ","
                 << Parent::get_score() << ","
                 << get_stack_score() << ","
                 << Parent::get_nb_nodes() << ","
@@ -202,11 +339,7 @@ protected:
         T_IOSymbol out_symbol;
         T_IOSymbol end_symbol;
 
-        // return encoder to appropriate state
-        if (node_edge->get_depth() >= 0) // does not concern the root node
-        {
-            Parent::encoding.set_registers(node_edge->get_registers());
-        }
+        unsigned long long state = node_edge->get_state(); // encoder state at this node
 
         if ((Parent::tail_zeros) && (forward_depth > relmat.get_message_length()-Parent::encoding.get_m()))
         {
@@ -220,16 +353,22 @@ protected:
         // loop through assumption for this symbol place
         for (T_IOSymbol in_symbol = 0; in_symbol < end_symbol; in_symbol++)
         {
-            Parent::encoding.encode(in_symbol, out_symbol, in_symbol > 0); // step only for a new symbol place
-            float edge_metric = ParentInternal::log2(relmat(out_symbol, forward_depth)) - Parent::edge_bias;
+            unsigned long long forward_state = Parent::encoding.get_next_packed_state(state, in_symbol);
+            out_symbol = Parent::encoding.get_output_symbol(forward_state);
+            float edge_metric = ParentInternal::edge_metrics(out_symbol, forward_depth);
 
             float forward_path_metric = edge_metric + node_edge->get_path_metric();
             if ((!Parent::use_metric_limit) || (forward_path_metric > Parent::metric_limit))
             {
-                StackNodeEdge *next_node_edge = new StackNodeEdge(Parent::node_count, node_edge, in_symbol, edge_metric, forward_path_metric, forward_depth);
-                next_node_edge->set_registers(Parent::encoding.get_registers());
-                node_edge->add_outgoing_node_edge(next_node_edge); // add forward edge+node combo
-                node_edge_stack[NodeEdgeOrdering(forward_path_metric, Parent::node_count)] = next_node_edge;
+                if (merge_detection && !trellis_state_index.improve(forward_depth, forward_state, forward_path_metric))
+                {
+                    nb_merged++; // a path at least as good already reached this state at this depth
+                    continue;
+                }
+
+
+                StackNodeEdge *next_node_edge = ParentInternal::new_node_edge(node_edge, in_symbol, forward_path_metric, forward_depth, forward_state); // add forward edge+node combo
+                node_edge_stack.push(forward_path_metric, Parent::node_count, next_node_edge);
                 //std::cout << "->" << std::dec << node_count << ":" << forward_depth << " (" << (unsigned int) in_symbol << "," << (unsigned int) out_symbol << "): " << forward_path_metric << std::endl;
                 Parent::node_count++;
             }
@@ -242,30 +381,13 @@ protected:
             Parent::max_depth = Parent::cur_depth;
         }
 
-        if (node_edge->get_depth() >= 0)
-        {
-            remove_node_from_stack(node_edge); // remove current node from the stack unless it is the root node which is not in the stack
-        }
-    }
-
-    /**
-     * Removes a node from the stack map. Does a full scan but usually the nodes to be removed are on the top of the stack (i.e. beginning of the map).
-     */
-    void remove_node_from_stack(StackNodeEdge* node_edge)
-    {
-        typename std::map<NodeEdgeOrdering, StackNodeEdge*, std::greater<NodeEdgeOrdering> >::iterator stack_it = node_edge_stack.begin();
-
-        for (; stack_it != node_edge_stack.end(); ++stack_it)
-        {
-            if (node_edge == stack_it->second)
-            {
-                node_edge_stack.erase(stack_it);
-                break;
-            }
-        }
     }
 
-    std::map<NodeEdgeOrdering, StackNodeEdge*, std::greater<NodeEdgeOrdering> > node_edge_stack; //!< Ordered stack of node+edge combos by decreasing path metric
+    CC_NodeEdgeHeap<StackNodeEdge> node_edge_stack; //!< Stack of node+edge combos as a heap ordered by decreasing path metric
+    bool use_merge_detection;                  //!< Merge detection option
+    bool merge_detection;                      //!< Merge detection applies to the current decode
+    CC_TrellisStateIndex trellis_state_index;  //!< Best path metric by depth and encoder state for merge detection
+    unsigned int nb_merged;                    //!< Number of paths dropped by merge detection
 };
 
 } // namespace ccsoft
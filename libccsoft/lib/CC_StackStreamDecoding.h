@@ -0,0 +1,622 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Streaming convolutional soft-decision decoder based on the stack algorithm.
+ Reliability columns are entered one at a time and decoded symbols are
+ committed as soon as all surviving paths agree or when the best path has
+ gone past the decision delay. The code tree is re-rooted at the commit
+ point and everything behind it is given back to the pool.
+
+ */
+#ifndef __CC_STACK_STREAM_DECODING_H__
+#define __CC_STACK_STREAM_DECODING_H__
+
+#include "CC_SequentialDecoding.h"
+#include "CC_SequentialDecodingInternal.h"
+#include "CC_Encoding.h"
+#include "CCSoft_Exception.h"
+#include "CC_TreeNodeEdge.h"
+#include "CC_ReliabilityMatrix.h"
+#include "CC_EdgeMetrics.h"
+#include "CC_NodeEdgeOrdering.h"
+
+#include <deque>
+#include <vector>
+#include <iostream>
+
+
+namespace ccsoft
+{
+
+/**
+ * \brief Streaming stack decoder. The stack algorithm runs over the columns received so far and stops when the top
+ * of the stack has consumed the last column. Symbols are committed when:
+ * - all open paths go through the same node (the surviving paths agree up to that node), or
+ * - the best path is decision_delay symbols ahead of the commit point. Then half of the window is committed along
+ *   the best path and the paths that do not go through the commit point are dropped, or
+ * - the number of live nodes exceeds the node limit if any.
+ * After each commit the tree is re-rooted at the commit point so depths and path metrics stay relative to the commit
+ * point and memory is bounded by the decision delay. When a metric limit is set it applies to path metrics relative to
+ * the commit point. Branches that cannot be extended above the metric limit are released immediately. Time and move
+ * limits apply to the whole stream from the last reset: a move is one node expansion.
+ * \tparam T_Register Type of the encoder internal registers
+ * \tparam T_IOSymbol Type of the input and output symbols
+ */
+template<typename T_Register, typename T_IOSymbol>
+class CC_StackStreamDecoding : public CC_SequentialDecoding<T_Register, T_IOSymbol>, public CC_SequentialDecodingInternal<T_Register, T_IOSymbol, CC_TreeNodeEdgeTag_Empty>
+{
+public:
+    /**
+     * Constructor
+     * \param constraints Vector of register lengths (constraint length + 1). The number of elements determines k.
+     * \param genpoly_representations Generator polynomial numeric representations. There are as many elements as there
+     * are input bits (k). Each element is itself a vector with one polynomial value per output bit. The smallest size of
+     * these vectors is retained as the number of output bits n. The input bits of a symbol are clocked simultaneously into
+     * the right hand side, or least significant position of the internal registers. Therefore the given polynomial representation
+     * of generators should follow the same convention.
+     * \param _decision_delay Maximum number of symbols held in the tree before a decision is forced. 0 gives 8 times the
+     * largest register length.
+     */
+    CC_StackStreamDecoding(const std::vector<unsigned int>& constraints,
+            const std::vector<std::vector<T_Register> >& genpoly_representations,
+            unsigned int _decision_delay = 0) :
+                CC_SequentialDecoding<T_Register, T_IOSymbol>(constraints, genpoly_representations),
+                CC_SequentialDecodingInternal<T_Register, T_IOSymbol, CC_TreeNodeEdgeTag_Empty>(constraints.size()),
+                decision_delay(_decision_delay == 0 ? 8*Parent::encoding.get_m() : _decision_delay),
+                nb_committed(0),
+                tail_start(no_tail),
+                nb_agreement_commits(0),
+                nb_forced_commits(0)
+    {
+        if (decision_delay < 2)
+        {
+            throw CCSoft_Exception("Decision delay must be at least 2 symbols");
+        }
+
+        if (decision_delay >= (unsigned int) StreamNodeEdge::max_depth)
+        {
+            throw CCSoft_Exception("Decision delay is too large for the code tree node depth range");
+        }
+
+        reset();
+    }
+
+    /**
+     * Destructor
+     */
+    virtual ~CC_StackStreamDecoding()
+    {}
+
+    /**
+     * Reset the decoding process and start a new stream. The time and move budgets start here.
+     */
+    void reset()
+    {
+        ParentInternal::reset();
+        Parent::reset();
+        Parent::budget.start();
+        node_edge_stack.clear();
+        column_metrics.clear();
+        nb_committed = 0;
+        tail_start = no_tail;
+        nb_agreement_commits = 0;
+        nb_forced_commits = 0;
+        ParentInternal::init_root();
+        Parent::node_count++;
+        node_edge_stack.push(0.0, ParentInternal::root_node->get_id(), ParentInternal::root_node);
+    }
+
+    /**
+     * Enter the reliability data of the next symbol of the stream and decode as far as possible
+     * \param symbol_data Reliability of each output symbol value (1<<n values). Normalized internally.
+     * \param decoded_symbols Symbols committed by this call are appended to this vector
+     * \return false if all paths fell below the metric limit or if the time or move limit was reached. The status tells
+     * which. The decoder must then be reset.
+     */
+    bool enter_symbol_data(const float *symbol_data, std::vector<T_IOSymbol>& decoded_symbols)
+    {
+        if (node_edge_stack.empty() || (Parent::status != CC_Decoding_Success))
+        {
+            return false;
+        }
+
+        append_column(symbol_data);
+
+        // expand until the top of the stack needs a column that has not arrived yet
+        while (!node_edge_stack.empty())
+        {
+            StreamNodeEdge *node_edge = node_edge_stack.top_node_edge();
+
+            if (node_edge->get_depth() + 1 >= get_stream_depth())
+            {
+                break;
+            }
+
+            node_edge_stack.pop();
+            expand_node(node_edge);
+
+            Parent::status = Parent::budget.move();
+
+            if (Parent::status != CC_Decoding_Success) // give up, the best partial path is still on top of the stack
+            {
+                return false;
+            }
+
+            if ((Parent::use_node_limit)
+                && (ParentInternal::node_edge_pool.get_nb_allocated() > Parent::node_limit)
+                && (!node_edge_stack.empty()))
+            {
+                StreamNodeEdge *top_node_edge = node_edge_stack.top_node_edge();
+
+                if (top_node_edge->get_depth() >= 0)
+                {
+                    commit(get_ancestor(top_node_edge, top_node_edge->get_depth() / 2), decoded_symbols);
+                    nb_forced_commits++;
+                }
+            }
+        }
+
+        if (node_edge_stack.empty())
+        {
+            Parent::status = CC_Decoding_MetricLimit;
+            return false;
+        }
+
+        StreamNodeEdge *commit_node_edge = get_agreement_node_edge();
+        int top_depth = node_edge_stack.top_node_edge()->get_depth();
+
+        if ((top_depth + 1 >= (int) decision_delay) && (top_depth - (int) decision_delay/2 > commit_node_edge->get_depth()))
+        {
+            commit(get_ancestor(node_edge_stack.top_node_edge(), top_depth - decision_delay/2), decoded_symbols);
+            nb_forced_commits++;
+        }
+        else if (commit_node_edge != ParentInternal::root_node)
+        {
+            commit(commit_node_edge, decoded_symbols);
+            nb_agreement_commits++;
+        }
+
+        return true;
+    }
+
+    /**
+     * Commit the best path up to the last symbol entered. The stream can be continued afterwards.
+     * \param decoded_symbols Committed symbols are appended to this vector
+     * \return false if all paths fell below the metric limit
+     */
+    bool flush(std::vector<T_IOSymbol>& decoded_symbols)
+    {
+        if (node_edge_stack.empty())
+        {
+            return false;
+        }
+
+        commit(node_edge_stack.top_node_edge(), decoded_symbols);
+        return true;
+    }
+
+    /**
+     * Decodes given the reliability matrix by streaming its columns then flushing
+     * \param relmat Reference to the reliability matrix
+     * \param decoded_message Vector of symbols of retrieved message
+     */
+    virtual bool decode(const CC_ReliabilityMatrix& relmat, std::vector<T_IOSymbol>& decoded_message)
+    {
+        if (relmat.get_message_length() < Parent::encoding.get_m())
+        {
+            throw CCSoft_Exception("Reliability Matrix should have a number of columns at least equal to the code constraint");
+        }
+
+        if (relmat.get_nb_symbols_log2() != Parent::encoding.get_n())
+        {
+            throw CCSoft_Exception("Reliability Matrix is not compatible with code output symbol size");
+        }
+
+        reset();
+        CC_DecodingBudgetScope budget_scope(Parent::budget);
+        decoded_message.clear();
+
+        if (Parent::tail_zeros)
+        {
+            tail_start = relmat.get_message_length() - Parent::encoding.get_m() + 1;
+        }
+
+        const float *symbol_data = relmat.get_raw_matrix();
+
+        for (unsigned int i=0; i<relmat.get_message_length(); i++, symbol_data += relmat.get_nb_symbols())
+        {
+            if (!enter_symbol_data(symbol_data, decoded_message)) // decoded message holds the symbols committed so far
+            {
+                if (!node_edge_stack.empty()) // time or move limit: complete with the best partial path
+                {
+                    commit(node_edge_stack.top_node_edge(), decoded_message);
+                }
+
+                return false;
+            }
+        }
+
+        return flush(decoded_message);
+    }
+
+    /**
+     * Get the decision delay
+     */
+    unsigned int get_decision_delay() const
+    {
+        return decision_delay;
+    }
+
+    /**
+     * Get the number of symbols committed since the start of the stream
+     */
+    unsigned long long get_nb_committed() const
+    {
+        return nb_committed;
+    }
+
+    /**
+     * Get the number of nodes currently held in the code tree
+     */
+    unsigned int get_nb_live_nodes() const
+    {
+        return ParentInternal::node_edge_pool.get_nb_allocated();
+    }
+
+    /**
+     * Get the stack size
+     */
+    unsigned int get_stack_size() const
+    {
+        return node_edge_stack.size();
+    }
+
+    /**
+     * Get the effort statistics of the last decode
+     */
+    virtual CC_DecodeStats get_decode_stats() const
+    {
+        CC_DecodeStats stats = Parent::get_decode_stats();
+        stats.stack_size = get_stack_size();
+        return stats;
+    }
+
+    /**
+     * Print stats to an output stream
+     * \param os Output stream
+     * \param success True if decoding was successful
+     */
+    virtual void print_stats(std::ostream& os, bool success)
+    {
+        os << "score = " << Parent::get_score()
+                << " #nodes = " << Parent::get_nb_nodes()
+                << " live nodes = " << get_nb_live_nodes()
+                << " stack_size = " << get_stack_size()
+                << " max depth = " << Parent::get_max_depth()
+                << " commits = " << nb_agreement_commits << "/" << nb_forced_commits;
+    }
+
+    /**
+     * Print stats summary to an output stream
+     * \param os Output stream
+     * \param success True if decoding was successful
+     */
+    virtual void print_stats_summary(std::ostream& os, bool success)
+    {
+        os << "_RES " << (success ? 1 : 0) << ","
+                << Parent::get_score() << ","
+                << Parent::get_nb_nodes() << ","
+                << get_nb_live_nodes() << ","
+                << get_stack_size() << ","
+                << Parent::get_max_depth() << ","
+                << nb_agreement_commits << ","
+                << nb_forced_commits;
+    }
+
+    /**
+     * Print the dot (Graphviz) file of the uncommitted part of the code tree to an output stream
+     * \param os Output stream
+     */
+    virtual void print_dot(std::ostream& os)
+    {
+        ParentInternal::print_dot_internal(os);
+    }
+
+protected:
+    typedef CC_SequentialDecoding<T_Register, T_IOSymbol> Parent;                                       //!< Parent class this class inherits from
+    typedef CC_SequentialDecodingInternal<T_Register, T_IOSymbol, CC_TreeNodeEdgeTag_Empty> ParentInternal; //!< Parent class this class inherits from
+    typedef CC_TreeNodeEdge<T_IOSymbol, T_Register, CC_TreeNodeEdgeTag_Empty> StreamNodeEdge;       //!< Class of code tree nodes in the streaming stack algorithm
+
+    static const unsigned long long no_tail = ~0ULL; //!< Tail start value when no zero tail is assumed
+
+    /**
+     * Visit a new node. The reliability data is taken from the columns entered in the stream.
+     * \node Node+edge combo to visit
+     * \relmat Reliability matrix being used (unused)
+     */
+    virtual void visit_node_forward(StreamNodeEdge* node_edge, const CC_ReliabilityMatrix& relmat)
+    {
+        expand_node(node_edge);
+    }
+
+    /**
+     * Number of columns held after the root node i.e. depth of the first column not received yet
+     */
+    int get_stream_depth() const
+    {
+        return column_metrics.size() >> Parent::encoding.get_n();
+    }
+
+    /**
+     * Normalize a reliability column and append its biased log2 values to the uncommitted columns
+     * \param symbol_data Reliability of each output symbol value
+     */
+    void append_column(const float *symbol_data)
+    {
+        unsigned int nb_symbols = 1<<Parent::encoding.get_n();
+        float col_sum = 0.0;
+
+        for (unsigned int i=0; i<nb_symbols; i++)
+        {
+            col_sum += symbol_data[i];
+        }
+
+        for (unsigned int i=0; i<nb_symbols; i++)
+        {
+            column_metrics.push_back(CC_EdgeMetrics::log2_reliability(col_sum != 0.0 ? symbol_data[i] / col_sum : symbol_data[i]) - Parent::edge_bias);
+        }
+    }
+
+    /**
+     * Expand a node of the stack. The node is flagged as expanded. If no successor is above the metric limit the
+     * dead branch is released up to the closest node with other successors.
+     * \param node_edge Node+edge to expand
+     */
+    void expand_node(StreamNodeEdge *node_edge)
+    {
+        int forward_depth = node_edge->get_depth() + 1;
+        unsigned long long state = node_edge->get_state(); // encoder state at this node
+        std::deque<float>::const_iterator column = column_metrics.begin() + (forward_depth << Parent::encoding.get_n());
+        T_IOSymbol end_symbol;
+        unsigned int nb_successors = 0;
+
+        if (nb_committed + forward_depth >= tail_start)
+        {
+            end_symbol = 1; // if zero tail option assume tail symbols are all zeros
+        }
+        else
+        {
+            end_symbol = (1<<Parent::encoding.get_k()); // full scan all possible input symbols
+        }
+
+        node_edge->set_flag(); // expanded
+
+        for (T_IOSymbol in_symbol = 0; in_symbol < end_symbol; in_symbol++)
+        {
+            unsigned long long forward_state = Parent::encoding.get_next_packed_state(state, in_symbol);
+            T_IOSymbol out_symbol = Parent::encoding.get_output_symbol(forward_state);
+            float forward_path_metric = column[out_symbol] + node_edge->get_path_metric();
+
+            if ((!Parent::use_metric_limit) || (forward_path_metric > Parent::metric_limit))
+            {
+                StreamNodeEdge *next_node_edge = ParentInternal::new_node_edge(node_edge, in_symbol, forward_path_metric, forward_depth, forward_state);
+                node_edge_stack.push(forward_path_metric, next_node_edge->get_id(), next_node_edge);
+                Parent::node_count++;
+                nb_successors++;
+            }
+        }
+
+        Parent::cur_depth = (int) (nb_committed + forward_depth);
+
+        if (Parent::cur_depth > Parent::max_depth)
+        {
+            Parent::max_depth = Parent::cur_depth;
+        }
+
+        if (nb_successors == 0)
+        {
+            release_dead_branch(node_edge);
+        }
+    }
+
+    /**
+     * Release a node without successors and its ancestors left without successors. The root node is kept.
+     * \param node_edge Node+edge without successors
+     */
+    void release_dead_branch(StreamNodeEdge *node_edge)
+    {
+        while ((node_edge != ParentInternal::root_node) && (!has_successors(node_edge)))
+        {
+            StreamNodeEdge *incoming_node_edge = ParentInternal::get_incoming_node_edge(node_edge);
+            incoming_node_edge->set_outgoing_index(node_edge->get_in_symbol(), StreamNodeEdge::null_index);
+            ParentInternal::node_edge_pool.release(node_edge);
+            node_edge = incoming_node_edge;
+        }
+    }
+
+    /**
+     * Tells if a node has at least one successor in the tree
+     */
+    bool has_successors(const StreamNodeEdge *node_edge) const
+    {
+        for (unsigned int i=0; i<(1U<<Parent::encoding.get_k()); i++)
+        {
+            if (node_edge->get_outgoing_index(i) != StreamNodeEdge::null_index)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Get the deepest node that all open paths go through. As dead branches are released this is found by going down
+     * from the root node as long as expanded nodes have a single successor.
+     */
+    StreamNodeEdge *get_agreement_node_edge() const
+    {
+        StreamNodeEdge *node_edge = ParentInternal::root_node;
+
+        while (node_edge->get_flag())
+        {
+            StreamNodeEdge *successor = 0;
+
+            for (unsigned int i=0; i<(1U<<Parent::encoding.get_k()); i++)
+            {
+                StreamNodeEdge *outgoing_node_edge = ParentInternal::get_outgoing_node_edge(node_edge, i);
+
+                if (outgoing_node_edge)
+                {
+                    if (successor)
+                    {
+                        return node_edge; // paths diverge here
+                    }
+
+                    successor = outgoing_node_edge;
+                }
+            }
+
+            if (!successor)
+            {
+                break;
+            }
+
+            node_edge = successor;
+        }
+
+        return node_edge;
+    }
+
+    /**
+     * Get the ancestor of a node at a given depth
+     * \param node_edge Node+edge to start from
+     * \param depth Depth of the ancestor not larger than the node depth
+     */
+    StreamNodeEdge *get_ancestor(StreamNodeEdge *node_edge, int depth) const
+    {
+        while (node_edge->get_depth() > depth)
+        {
+            node_edge = ParentInternal::get_incoming_node_edge(node_edge);
+        }
+
+        return node_edge;
+    }
+
+    /**
+     * Commit the path from the root node to the given node. The given node becomes the new root and all nodes that are
+     * not its successors are released. Depths and path metrics are made relative to the new root and the stack is
+     * rebuilt from the open nodes left.
+     * \param commit_node_edge Last node+edge of the committed path
+     * \param decoded_symbols Committed symbols are appended to this vector
+     */
+    void commit(StreamNodeEdge *commit_node_edge, std::vector<T_IOSymbol>& decoded_symbols)
+    {
+        int nb_symbols = commit_node_edge->get_depth() + 1;
+
+        if (nb_symbols == 0)
+        {
+            return;
+        }
+
+        float path_metric = commit_node_edge->get_path_metric();
+        unsigned int start = decoded_symbols.size();
+        decoded_symbols.resize(start + nb_symbols);
+
+        // walk back to the root: collect the committed symbols and release whatever hangs off the committed path
+        unsigned int child_index = commit_node_edge->get_id();
+        StreamNodeEdge *node_edge = ParentInternal::get_incoming_node_edge(commit_node_edge);
+        int i = nb_symbols - 1;
+
+        decoded_symbols[start + i] = commit_node_edge->get_in_symbol();
+
+        while (node_edge)
+        {
+            StreamNodeEdge *incoming_node_edge = ParentInternal::get_incoming_node_edge(node_edge);
+
+            if (--i >= 0)
+            {
+                decoded_symbols[start + i] = node_edge->get_in_symbol();
+            }
+
+            for (unsigned int i=0; i<(1U<<Parent::encoding.get_k()); i++)
+            {
+                unsigned int outgoing_index = node_edge->get_outgoing_index(i);
+
+                if ((outgoing_index != StreamNodeEdge::null_index) && (outgoing_index != child_index))
+                {
+                    ParentInternal::node_edge_pool.release_subtree(ParentInternal::node_edge_pool.get(outgoing_index));
+                }
+            }
+
+            child_index = node_edge->get_id();
+            ParentInternal::node_edge_pool.release(node_edge);
+            node_edge = incoming_node_edge;
+        }
+
+        commit_node_edge->set_incoming_index(StreamNodeEdge::null_index);
+        ParentInternal::root_node = commit_node_edge;
+        column_metrics.erase(column_metrics.begin(), column_metrics.begin() + (nb_symbols << Parent::encoding.get_n()));
+        nb_committed += nb_symbols;
+        Parent::codeword_score += path_metric;
+
+        // re-root the remaining tree and rebuild the stack from its open nodes
+        node_edge_stack.clear();
+        walk_nodes.push_back(commit_node_edge);
+
+        while (!walk_nodes.empty())
+        {
+            node_edge = walk_nodes.back();
+            walk_nodes.pop_back();
+            node_edge->rebase(nb_symbols, path_metric);
+
+            if (node_edge->get_flag())
+            {
+                for (unsigned int i=0; i<(1U<<Parent::encoding.get_k()); i++)
+                {
+                    StreamNodeEdge *outgoing_node_edge = ParentInternal::get_outgoing_node_edge(node_edge, i);
+
+                    if (outgoing_node_edge)
+                    {
+                        walk_nodes.push_back(outgoing_node_edge);
+                    }
+                }
+            }
+            else
+            {
+                node_edge_stack.push_unordered(node_edge->get_path_metric(), node_edge->get_id(), node_edge);
+            }
+        }
+
+        node_edge_stack.make_heap();
+    }
+
+    unsigned int decision_delay;                   //!< Maximum number of uncommitted symbols on the best path
+    std::deque<float> column_metrics;              //!< Biased log2 reliabilities of the columns after the root node
+    unsigned long long nb_committed;               //!< Number of symbols committed since the start of the stream
+    unsigned long long tail_start;                 //!< Stream position from which zero input symbols are assumed
+    unsigned int nb_agreement_commits;             //!< Number of commits made because all open paths agreed
+    unsigned int nb_forced_commits;                //!< Number of commits forced by the decision delay or node limit
+    CC_NodeEdgeHeap<StreamNodeEdge> node_edge_stack; //!< Open node+edges as a heap ordered by decreasing path metric
+    std::vector<StreamNodeEdge*> walk_nodes;       //!< Work list used when re-rooting the tree
+};
+
+} // namespace ccsoft
+
+#endif // __CC_STACK_STREAM_DECODING_H__
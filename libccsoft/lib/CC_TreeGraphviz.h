@@ -26,6 +26,7 @@
 #define _CC_TREE_GRAPHVIZ_H__
 
 #include "CC_TreeNodeEdge.h"
+#include "CC_TreeNodeEdgePool.h"
 #include "CC_Encoding.h" // for print symbols
 #include <vector>
 #include <iostream>
@@ -39,44 +40,53 @@ namespace ccsoft
         /**
          * Create a dot command sequence into an output stream
          * \param root_node Root node of the coding tree
+         * \param pool Pool the node+edges are allocated from
          * \param os Output stream
          */
-        static void create_dot(CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag> *root_node, std::ostream& os)
+        static void create_dot(CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag> *root_node, const CC_TreeNodeEdgePool<CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag> >& pool, std::ostream& os)
         {
             std::vector<CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag>*> node_edges;
             
-            explore_node_edge(root_node, node_edges);
-            print_dot(node_edges, os);
+            if (root_node)
+            {
+                explore_node_edge(root_node, pool, node_edges);
+            }
+
+            print_dot(node_edges, pool, os);
         }
         
     protected:
         /**
          * Explore a node+edge in the tree to accumulate node+edges information
          * \param node Node to explore
-         * \param nodes Vector of all nodes
-         * \param edges Vector of all edges
+         * \param pool Pool the node+edges are allocated from
+         * \param node_edges Vector of all node+edges
          */
         static void explore_node_edge(CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag> *node_edge,
+            const CC_TreeNodeEdgePool<CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag> >& pool,
             std::vector<CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag>*>& node_edges)
         {
             node_edges.push_back(node_edge);
-            const std::vector<CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag>*>& outgoing_node_edges = node_edge->get_outgoing_node_edges();
-            typename std::vector<CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag>*>::const_iterator ne_it = outgoing_node_edges.begin();
-            
-            for (; ne_it != outgoing_node_edges.end(); ++ne_it)
+
+            for (unsigned int i=0; i<pool.get_nb_outgoing(); i++)
             {
-                node_edges.push_back(*ne_it);
-                explore_node_edge(*ne_it, node_edges);
+                unsigned int successor_index = node_edge->get_outgoing_index(i);
+
+                if (successor_index != CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag>::null_index) // successors may not all be created
+                {
+                    explore_node_edge(pool.get(successor_index), pool, node_edges);
+                }
             }
         }
         
         /**
          * Print the dot output
-         * \param nodes Vector of all nodes
-         * \param edges Vector of all edges
+         * \param node_edges Vector of all node+edges
+         * \param pool Pool the node+edges are allocated from
          * \param os Output stream
          */
         static void print_dot(std::vector<CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag>*>& node_edges,
+            const CC_TreeNodeEdgePool<CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag> >& pool,
             std::ostream& os)
         {
             os << "digraph G {" << std::endl;
@@ -100,9 +110,15 @@ namespace ccsoft
 
             for (; ne_it != node_edges.end(); ++ne_it)
             {
-                os << "    n_" << (*ne_it)->get_incoming_node_edge()->get_id() << " -> n_" << (*ne_it)->get_id() << " [label=\"";
+                if ((*ne_it)->get_incoming_index() == CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag>::null_index) // root node has no incoming edge
+                {
+                    continue;
+                }
+
+                CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag> *incoming_node_edge = pool.get((*ne_it)->get_incoming_index());
+                os << "    n_" << incoming_node_edge->get_id() << " -> n_" << (*ne_it)->get_id() << " [label=\"";
                 print_symbol((*ne_it)->get_in_symbol(), os);
-                os << " " << (*ne_it)->get_incoming_metric() << "\"]" << std::endl;
+                os << " " << (*ne_it)->get_path_metric() - incoming_node_edge->get_path_metric() << "\"]" << std::endl; // edge metric
             }
 
             os << "}" << std::endl;
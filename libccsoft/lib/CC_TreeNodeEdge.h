@@ -22,18 +22,23 @@
  edges as nodes have a single incoming edge. So a node can incorporate
  its incoming edge.
 
+ The pool indexes of the outgoing node+edges are stored inline right after
+ the node object so nodes have to be allocated from a CC_TreeNodeEdgePool
+ with the record size given by get_record_size().
+
  */
 #ifndef __CC_TREE_NODE_EDGE_H__
 #define __CC_TREE_NODE_EDGE_H__
 
 #include "CC_TreeNodeEdge_base.h"
-#include <vector>
+#include <cstddef>
 
 namespace ccsoft
 {
 
 /**
- * \brief Represents a node and its incoming edge in the code tree
+ * \brief Represents a node and its incoming edge in the code tree.
+ * The (1<<k) outgoing node+edge pool indexes are stored in trailing storage after the object.
  * \tparam T_IOSymbol Type of the input and output symbols
  * \tparam T_Register Type of the encoder internal registers
  * \tparam T_Tag Type of the node-edge tag
@@ -44,105 +49,69 @@ class CC_TreeNodeEdge : public CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>
 
 public:
     /**
-     * Constructor
-     * \param _id Unique ID of the edge
-     * \param _p_incoming_edge Pointer to the incoming edge to the node
+     * Constructor. Must be constructed in a record of at least get_record_size(k) bytes.
+     * \param _id Unique ID of the node+edge. This is its index in the pool.
+     * \param _incoming_index Pool index of the incoming node+edge (null_index for the root node)
      * \param _in_symbol Input symbol corresponding to the edge
-     * \param _metric Metric of the edge
      * \param _path_metric Path metric at the node
      * \param _depth This node depth
+     * \param _state Packed encoder registers at the node
+     * \param _nb_outgoing Number of outgoing node+edge slots i.e. 1<<k
      */
 	CC_TreeNodeEdge(unsigned int _id,
-			CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag> *_p_incoming_node_edge,
+            unsigned int _incoming_index,
 			const T_IOSymbol& _in_symbol,
-            float _incoming_edge_metric,
             float _path_metric,
-            int _depth) :
-                CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>(_id, _in_symbol, _incoming_edge_metric, _path_metric, _depth),
-                p_incoming_node_edge(_p_incoming_node_edge)
-    {}
-
-	/**
-	 * Destructor
-	 */
-	~CC_TreeNodeEdge()
-	{
-		// deletes all outgoing edge+nodes
-		delete_outgoing_node_edges();
-	}
-
-    /**
-     * Add an outgoing edge
-     * \param p_outgoing_node_edge Outgoing edge+node
-     */
-    void add_outgoing_node_edge(CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag> *p_outgoing_node_edge)
-    {
-    	p_outgoing_node_edges.push_back(p_outgoing_node_edge);
-    }
-
-    /**
-     * Delete outgoing edges
-     */
-    void delete_outgoing_node_edges()
+            int _depth,
+            unsigned long long _state,
+            unsigned int _nb_outgoing) :
+                CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>(_id, _incoming_index, _in_symbol, _path_metric, _depth, _state)
     {
-        typename std::vector<CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag>*>::iterator ne_it = p_outgoing_node_edges.begin();
+        unsigned int *outgoing_indexes = get_outgoing_indexes();
 
-        for (; ne_it != p_outgoing_node_edges.end(); ++ne_it)
+        for (unsigned int i=0; i<_nb_outgoing; i++)
         {
-            if (*ne_it)
-            {
-                delete *ne_it;
-                *ne_it = 0;
-            }
+            outgoing_indexes[i] = CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>::null_index;
         }
-
-        p_outgoing_node_edges.clear();
     }
 
     /**
-     * Return a R/O reference to the outgoing node+edges
+     * Size in bytes of a node record including trailing storage
+     * \param k Number of input bits
      */
-    const std::vector<CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag>*>& get_outgoing_node_edges() const
+    static size_t get_record_size(unsigned int k)
     {
-        return p_outgoing_node_edges;
+        return sizeof(CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag>) + (1<<k)*sizeof(unsigned int);
     }
 
     /**
-     * Return a R/W reference to the outgoing edges
+     * Set the pool index of an outgoing node+edge
+     * \param index Slot of the outgoing node+edge i.e. its input symbol
+     * \param node_edge_index Pool index of the outgoing node+edge or null_index
      */
-    std::vector<CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag>*>& get_outgoing_node_edges()
+    void set_outgoing_index(unsigned int index, unsigned int node_edge_index)
     {
-        return p_outgoing_node_edges;
+    	get_outgoing_indexes()[index] = node_edge_index;
     }
 
     /**
-     * Get pointer to the incoming edge
+     * Get the pool index of an outgoing node+edge
+     * \param index Slot of the outgoing node+edge i.e. its input symbol
+     * \return Pool index of the outgoing node+edge or null_index if not created
      */
-    CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag> *get_incoming_node_edge()
+    unsigned int get_outgoing_index(unsigned int index) const
     {
-        return p_incoming_node_edge;
-    }
-
-    /**
-     * Get saved encoder registers reference
-     */
-    const std::vector<T_Register>& get_registers() const
-    {
-        return registers;
+        return get_outgoing_indexes()[index];
     }
 
+protected:
     /**
-     * Save encoder registers
+     * Pointer to the outgoing node+edge indexes array that follows the node
      */
-    void set_registers(const std::vector<T_Register>& _registers)
+    unsigned int *get_outgoing_indexes() const
     {
-        registers = _registers;
+        return reinterpret_cast<unsigned int*>(const_cast<CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag>*>(this) + 1);
     }
-
-protected:
-    std::vector<CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag>*> p_outgoing_node_edges; //!< Outgoing edges+node pointers
-    CC_TreeNodeEdge<T_IOSymbol, T_Register, T_Tag> *p_incoming_node_edge; //!< Pointer to the incoming edge+node
-    std::vector<T_Register> registers; //!< state of encoder registers at node
 };
 
 } // namespace ccsoft
@@ -0,0 +1,308 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Bounded cache of expanded code tree nodes. Keeps the successors of the
+ most recently used nodes and evicts the least recently used ones when
+ the node budget is reached.
+
+ */
+#ifndef __CC_TREE_NODE_EDGE_CACHE_H__
+#define __CC_TREE_NODE_EDGE_CACHE_H__
+
+#include "CC_TreeNodeEdgePool.h"
+
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+namespace ccsoft
+{
+
+/**
+ * \brief LRU cache of expanded node+edges i.e. nodes whose successors are kept in the code tree. The unit of caching
+ * is the set of successors of a node. Every expansion is queued with a serial number and every use of the node
+ * records a time stamp (e.g. the move number). Eviction pops the queue: entries whose node has been released or
+ * re-expanded since are dropped, entries whose node was used after being queued are queued again with their last
+ * use stamp and the first node left that is not on the current path has its successors released.
+ * Bookkeeping is held in side tables indexed by pool index so that the node layout is not affected.
+ * \tparam T_NodeEdge Type of the node+edge combo
+ */
+template<typename T_NodeEdge>
+class CC_TreeNodeEdgeCache
+{
+public:
+    /**
+     * Constructor
+     * \param _max_nodes Maximum number of nodes in the code tree (0 if the cache is not used)
+     */
+    CC_TreeNodeEdgeCache(unsigned int _max_nodes = 0) :
+        max_nodes(_max_nodes),
+        serial_count(0),
+        nb_hits(0),
+        nb_misses(0),
+        nb_evictions(0)
+    {}
+
+    ~CC_TreeNodeEdgeCache()
+    {}
+
+    /**
+     * Set the maximum number of nodes in the code tree (0 if the cache is not used)
+     */
+    void set_max_nodes(unsigned int _max_nodes)
+    {
+        max_nodes = _max_nodes;
+    }
+
+    /**
+     * Get the maximum number of nodes in the code tree
+     */
+    unsigned int get_max_nodes() const
+    {
+        return max_nodes;
+    }
+
+    /**
+     * Forget all cached nodes and clear the counters. To be called whenever the tree is released.
+     */
+    void reset()
+    {
+        expansions.clear();
+        serials.assign(serials.size(), 0);
+        serial_count = 0;
+        nb_hits = 0;
+        nb_misses = 0;
+        nb_evictions = 0;
+    }
+
+    /**
+     * Record that the successors of a node were found in the tree
+     * \param node_edge Node+edge being expanded
+     * \param stamp Time stamp of the use
+     */
+    void hit(const T_NodeEdge *node_edge, unsigned int stamp)
+    {
+        nb_hits++;
+        touch(node_edge, stamp);
+    }
+
+    /**
+     * Record that the successors of a node have been created
+     * \param node_edge Node+edge being expanded
+     * \param stamp Time stamp of the expansion
+     */
+    void miss(const T_NodeEdge *node_edge, unsigned int stamp)
+    {
+        unsigned int index = node_edge->get_id();
+        nb_misses++;
+        reserve(index);
+        serials[index] = ++serial_count;
+        last_uses[index] = stamp;
+
+        if (max_nodes > 0)
+        {
+            expansions.push_back(Expansion(index, serial_count, stamp));
+        }
+    }
+
+    /**
+     * Record a use of a node whose successors are in the tree
+     * \param node_edge Node+edge used
+     * \param stamp Time stamp of the use
+     */
+    void touch(const T_NodeEdge *node_edge, unsigned int stamp)
+    {
+        unsigned int index = node_edge->get_id();
+        reserve(index);
+        last_uses[index] = stamp;
+    }
+
+    /**
+     * Count a release of successors done outside of the cache (i.e. when the cache is not used)
+     */
+    void count_eviction()
+    {
+        nb_evictions++;
+    }
+
+    /**
+     * Evict least recently used successor sets until there is room for new nodes. Nodes on the path from the root
+     * to the current node are never evicted so the budget may be exceeded when the current path is long.
+     * \param pool Pool the node+edges are allocated from
+     * \param nb_nodes Number of nodes presently in the tree
+     * \param nb_new_nodes Number of nodes about to be created
+     * \param current_node_edge Current node+edge
+     * \param stamp Current time stamp
+     * \return Number of nodes released
+     */
+    unsigned int make_room(CC_TreeNodeEdgePool<T_NodeEdge>& pool,
+            unsigned int nb_nodes,
+            unsigned int nb_new_nodes,
+            const T_NodeEdge *current_node_edge,
+            unsigned int stamp)
+    {
+        unsigned int nb_released = 0;
+        unsigned int nb_requeued = 0;
+
+        while ((nb_nodes - nb_released + nb_new_nodes > max_nodes) && (!expansions.empty()) && (nb_requeued <= expansions.size()))
+        {
+            Expansion expansion = expansions.front();
+            expansions.pop_front();
+
+            if (serials[expansion.index] != expansion.serial) // released or expanded again since
+            {
+                continue;
+            }
+
+            T_NodeEdge *node_edge = pool.get(expansion.index);
+
+            if (last_uses[expansion.index] != expansion.stamp) // used since it was queued
+            {
+                expansion.stamp = last_uses[expansion.index];
+                expansions.push_back(expansion);
+            }
+            else if (is_on_path(pool, node_edge, current_node_edge))
+            {
+                last_uses[expansion.index] = stamp;
+                expansion.stamp = stamp;
+                expansions.push_back(expansion);
+                nb_requeued++;
+            }
+            else
+            {
+                nb_released += release_successors(pool, node_edge);
+                serials[expansion.index] = 0;
+                nb_evictions++;
+            }
+        }
+
+        return nb_released;
+    }
+
+    /**
+     * Release all successors of a node recursively and forget their cache entries
+     * \param pool Pool the node+edges are allocated from
+     * \param node_edge Node+edge to release successors from
+     * \return Number of nodes released
+     */
+    unsigned int release_successors(CC_TreeNodeEdgePool<T_NodeEdge>& pool, T_NodeEdge *node_edge)
+    {
+        unsigned int nb_released = 0;
+
+        for (unsigned int i=0; i<pool.get_nb_outgoing(); i++)
+        {
+            unsigned int successor_index = node_edge->get_outgoing_index(i);
+
+            if (successor_index != T_NodeEdge::null_index)
+            {
+                nb_released += release_successors(pool, pool.get(successor_index)) + 1;
+
+                if (successor_index < serials.size())
+                {
+                    serials[successor_index] = 0;
+                }
+
+                pool.release(pool.get(successor_index));
+                node_edge->set_outgoing_index(i, T_NodeEdge::null_index);
+            }
+        }
+
+        return nb_released;
+    }
+
+    /**
+     * Number of expansions that found the successors in the tree
+     */
+    unsigned int get_nb_hits() const
+    {
+        return nb_hits;
+    }
+
+    /**
+     * Number of expansions that had to create the successors
+     */
+    unsigned int get_nb_misses() const
+    {
+        return nb_misses;
+    }
+
+    /**
+     * Number of successor sets released
+     */
+    unsigned int get_nb_evictions() const
+    {
+        return nb_evictions;
+    }
+
+protected:
+    /**
+     * \brief Queued expansion of a node
+     */
+    struct Expansion
+    {
+        Expansion(unsigned int _index, unsigned int _serial, unsigned int _stamp) :
+            index(_index),
+            serial(_serial),
+            stamp(_stamp)
+        {}
+
+        unsigned int index;  //!< Pool index of the node
+        unsigned int serial; //!< Serial number of the expansion
+        unsigned int stamp;  //!< Last use time stamp when queued
+    };
+
+    /**
+     * Make room in the side tables for a pool index
+     */
+    void reserve(unsigned int index)
+    {
+        if (index >= serials.size())
+        {
+            unsigned int size = std::max(index + 1, 2*(unsigned int) serials.size());
+            serials.resize(size, 0);
+            last_uses.resize(size, 0);
+        }
+    }
+
+    /**
+     * Tells if a node is on the path from the root to the current node
+     */
+    bool is_on_path(const CC_TreeNodeEdgePool<T_NodeEdge>& pool, const T_NodeEdge *node_edge, const T_NodeEdge *current_node_edge) const
+    {
+        while (current_node_edge->get_depth() > node_edge->get_depth())
+        {
+            current_node_edge = pool.get(current_node_edge->get_incoming_index());
+        }
+
+        return current_node_edge == node_edge;
+    }
+
+    unsigned int max_nodes;              //!< Maximum number of nodes in the code tree (0 if the cache is not used)
+    std::deque<Expansion> expansions;    //!< Expansions queued by increasing last use
+    std::vector<unsigned int> serials;   //!< Serial number of the live expansion of each pool index (0 if none)
+    std::vector<unsigned int> last_uses; //!< Last use time stamp of each pool index
+    unsigned int serial_count;           //!< Serial number of the latest expansion
+    unsigned int nb_hits;                //!< Number of expansions finding the successors in the tree
+    unsigned int nb_misses;              //!< Number of expansions creating the successors
+    unsigned int nb_evictions;           //!< Number of successor sets released
+};
+
+} // namespace ccsoft
+
+#endif // __CC_TREE_NODE_EDGE_CACHE_H__
@@ -0,0 +1,255 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Slab allocator for the node+edge combos of the code tree. Nodes are carved
+ out of large slabs, addressed by a 32 bit index and released all at once
+ between codewords.
+
+ */
+#ifndef __CC_TREE_NODE_EDGE_POOL_H__
+#define __CC_TREE_NODE_EDGE_POOL_H__
+
+#include "CCSoft_Exception.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace ccsoft
+{
+
+/**
+ * \brief Slab allocator of code tree node+edge combos. Memory is obtained in slabs of many node records and is never
+ * given back to the system until the pool is destroyed. Records are numbered contiguously across slabs so that nodes
+ * can refer to each other with 32 bit indexes. Individual nodes released during a decode (i.e. Fano backtracking or
+ * tree cache purge) go to a free list and are reused first. The whole tree is released in O(1) with clear().
+ * Nodes are constructed in place by the caller and are never destroyed so they must not own any resource.
+ * \tparam T_NodeEdge Type of the node+edge combo
+ */
+template<typename T_NodeEdge>
+class CC_TreeNodeEdgePool
+{
+public:
+    /**
+     * Constructor
+     * \param _record_size Size in bytes of a node record including any trailing storage. Rounded up for alignment.
+     * \param _nb_outgoing Number of outgoing node+edge slots in a node i.e. 1<<k
+     * \param _slab_size_log2 Log2 of the number of node records in one slab
+     */
+    CC_TreeNodeEdgePool(size_t _record_size, unsigned int _nb_outgoing, unsigned int _slab_size_log2 = 12) :
+        record_size(((_record_size + record_alignment - 1) / record_alignment) * record_alignment),
+        nb_outgoing(_nb_outgoing),
+        slab_size_log2(_slab_size_log2),
+        slab_index(0),
+        slab_nb_used(0),
+        free_index(T_NodeEdge::null_index),
+        nb_allocated(0)
+    {
+        if (slab_size_log2 > 24)
+        {
+            throw CCSoft_Exception("Node+edge pool slabs are too large");
+        }
+    }
+
+    /**
+     * Destructor. Gives slabs back to the system.
+     */
+    ~CC_TreeNodeEdgePool()
+    {
+        std::vector<char*>::iterator s_it = slabs.begin();
+
+        for (; s_it != slabs.end(); ++s_it)
+        {
+            delete[] *s_it;
+        }
+    }
+
+    /**
+     * Get storage for one node record. The node must be constructed in place by the caller.
+     * \param index Returns the index of the record. It must be used as the node id.
+     */
+    void *allocate(unsigned int& index)
+    {
+        nb_allocated++;
+
+        if (free_index != T_NodeEdge::null_index)
+        {
+            index = free_index;
+            FreeRecord *record = reinterpret_cast<FreeRecord*>(get_record(index));
+            free_index = record->next_index;
+            return record;
+        }
+
+        if ((slabs.size() == 0) || (slab_nb_used == (1U<<slab_size_log2)))
+        {
+            if (slabs.size() > 0)
+            {
+                slab_index++;
+            }
+
+            if (slab_index == slabs.size())
+            {
+                if (((unsigned long long) (slab_index + 1) << slab_size_log2) > T_NodeEdge::null_index)
+                {
+                    throw CCSoft_Exception("Node+edge pool exhausted");
+                }
+
+                slabs.push_back(new char[record_size << slab_size_log2]);
+            }
+
+            slab_nb_used = 0;
+        }
+
+        index = (slab_index << slab_size_log2) + slab_nb_used;
+        slab_nb_used++;
+        return get_record(index);
+    }
+
+    /**
+     * Get a node from its index
+     * \param index Index of the node
+     */
+    T_NodeEdge *get(unsigned int index) const
+    {
+        return reinterpret_cast<T_NodeEdge*>(get_record(index));
+    }
+
+    /**
+     * Give one node record back to the pool. Its successors are not released.
+     * \param node_edge Node+edge to release
+     */
+    void release(T_NodeEdge *node_edge)
+    {
+        unsigned int index = node_edge->get_id();
+        FreeRecord *record = reinterpret_cast<FreeRecord*>(node_edge);
+        record->next_index = free_index;
+        free_index = index;
+        nb_allocated--;
+    }
+
+    /**
+     * Release all successors of a node recursively and clear its outgoing node+edges
+     * \param node_edge Node+edge to release successors from
+     * \return Number of immediate successors released
+     */
+    unsigned int release_successors(T_NodeEdge *node_edge)
+    {
+        unsigned int nb_released = 0;
+
+        for (unsigned int i=0; i<nb_outgoing; i++)
+        {
+            unsigned int successor_index = node_edge->get_outgoing_index(i);
+
+            if (successor_index != T_NodeEdge::null_index)
+            {
+                T_NodeEdge *successor = get(successor_index);
+                release_successors(successor);
+                release(successor);
+                node_edge->set_outgoing_index(i, T_NodeEdge::null_index);
+                nb_released++;
+            }
+        }
+
+        return nb_released;
+    }
+
+    /**
+     * Release a node and all its successors
+     * \param node_edge Node+edge to release
+     */
+    void release_subtree(T_NodeEdge *node_edge)
+    {
+        release_successors(node_edge);
+        release(node_edge);
+    }
+
+    /**
+     * Release all nodes at once. Slabs are kept for the next decode.
+     */
+    void clear()
+    {
+        slab_index = 0;
+        slab_nb_used = 0;
+        free_index = T_NodeEdge::null_index;
+        nb_allocated = 0;
+    }
+
+    /**
+     * Number of nodes currently allocated
+     */
+    unsigned int get_nb_allocated() const
+    {
+        return nb_allocated;
+    }
+
+    /**
+     * Number of slabs obtained from the system
+     */
+    unsigned int get_nb_slabs() const
+    {
+        return slabs.size();
+    }
+
+    /**
+     * Number of outgoing node+edge slots in a node
+     */
+    unsigned int get_nb_outgoing() const
+    {
+        return nb_outgoing;
+    }
+
+    /**
+     * Size in bytes of a node record
+     */
+    size_t get_record_size() const
+    {
+        return record_size;
+    }
+
+protected:
+    /**
+     * \brief Overlay of a released record linking to the next released record
+     */
+    struct FreeRecord
+    {
+        unsigned int next_index;
+    };
+
+    /**
+     * Address of a record given its index
+     */
+    char *get_record(unsigned int index) const
+    {
+        return slabs[index >> slab_size_log2] + (index & ((1U<<slab_size_log2) - 1)) * record_size;
+    }
+
+    static const size_t record_alignment = 8; //!< Alignment of node records. Suits the 64 bit packed state.
+
+    size_t record_size;          //!< Size of a node record in bytes
+    unsigned int nb_outgoing;    //!< Number of outgoing node+edge slots in a node
+    unsigned int slab_size_log2; //!< Log2 of the number of records in a slab
+    unsigned int slab_index;     //!< Index of the slab being carved
+    unsigned int slab_nb_used;   //!< Number of records carved in the current slab
+    unsigned int free_index;     //!< Index of the first released record available for reuse
+    unsigned int nb_allocated;   //!< Number of nodes currently allocated
+    std::vector<char*> slabs;    //!< Slabs obtained from the system
+};
+
+} // namespace ccsoft
+
+#endif // __CC_TREE_NODE_EDGE_POOL_H__
@@ -22,25 +22,24 @@
  edges as nodes have a single incoming edge. So a node can incorporate
  its incoming edge.
 
- This version uses fixed arrays for registers and forward node-edges
+ This version uses a fixed array for forward node-edges
 
  */
 #ifndef __CC_TREE_NODE_EDGE_FA_H__
 #define __CC_TREE_NODE_EDGE_FA_H__
 
 #include "CC_TreeNodeEdge_base.h"
-#include "CC_EncodingRegisters_FA.h"
 
-#include <vector>
 #include <array>
 #include <algorithm>
+#include <cstddef>
 
 namespace ccsoft
 {
 
 /**
  * \brief Represents a node and its incoming edge in the code tree
- * This version uses a fixed array to store forward node+edges pointers.
+ * This version uses a fixed array to store forward node+edges pool indexes.
  * N_k template parameter gives the size of the input symbol (k parameter).
  * There are (1<<N_k) forward node+edges.
  * \tparam T_IOSymbol Type of the input and output symbols
@@ -49,72 +48,62 @@ namespace ccsoft
  * \tparam N_k Input symbol size in bits (k parameter)
  */
 template<typename T_IOSymbol, typename T_Register, typename T_Tag, unsigned int N_k>
-class CC_TreeNodeEdge_FA : public CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>, public CC_EncodingRegisters_FA<T_Register, N_k>
+class CC_TreeNodeEdge_FA : public CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>
 {
 
 public:
     /**
      * Constructor
-     * \param _id Unique ID of the edge
-     * \param _p_incoming_edge Pointer to the incoming edge to the node
+     * \param _id Unique ID of the node+edge. This is its index in the pool.
+     * \param _incoming_index Pool index of the incoming node+edge (null_index for the root node)
      * \param _in_symbol Input symbol corresponding to the edge
-     * \param _metric Metric of the edge
      * \param _path_metric Path metric at the node
      * \param _depth This node depth
+     * \param _state Packed encoder registers at the node
      */
 	CC_TreeNodeEdge_FA(unsigned int _id,
-			CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k> *_p_incoming_node_edge,
+            unsigned int _incoming_index,
 			const T_IOSymbol& _in_symbol,
-            float _incoming_edge_metric,
             float _path_metric,
-            int _depth) :
-                CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>(_id, _in_symbol, _incoming_edge_metric, _path_metric, _depth),
-                p_incoming_node_edge(_p_incoming_node_edge)
+            int _depth,
+            unsigned long long _state) :
+                CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>(_id, _incoming_index, _in_symbol, _path_metric, _depth, _state)
     {
-        clear_outgoing_edges();
+        std::fill(outgoing_indexes.begin(), outgoing_indexes.end(), (unsigned int) CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>::null_index);
     }
 
-	/**
-	 * Destructor
-	 */
-	~CC_TreeNodeEdge_FA()
-	{
-		// deletes all outgoing edge+nodes
-		delete_outgoing_node_edges();
-	}
-
     /**
-     * Add an outgoing edge
-     * \param p_outgoing_node_edge Outgoing edge+node
+     * Size in bytes of a node record
      */
-    void set_outgoing_node_edge(CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k> *p_outgoing_node_edge, unsigned int index)
+    static size_t get_record_size()
     {
-    	p_outgoing_node_edges[index] = p_outgoing_node_edge;
+        return sizeof(CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>);
     }
 
     /**
-     * Delete outgoing edges
+     * Set the pool index of an outgoing node+edge
+     * \param index Slot of the outgoing node+edge i.e. its input symbol
+     * \param node_edge_index Pool index of the outgoing node+edge or null_index
      */
-    void delete_outgoing_node_edges()
+    void set_outgoing_index(unsigned int index, unsigned int node_edge_index)
     {
-        typename std::array<CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>*, (1<<N_k)>::iterator ne_it = p_outgoing_node_edges.begin();
-
-        for (; ne_it != p_outgoing_node_edges.end(); ++ne_it)
-        {
-            if (*ne_it)
-            {
-                delete *ne_it;
-                *ne_it = 0;
-            }
-        }
+    	outgoing_indexes[index] = node_edge_index;
+    }
 
-        clear_outgoing_edges();
+    /**
+     * Get the pool index of an outgoing node+edge
+     * \param index Slot of the outgoing node+edge i.e. its input symbol
+     * \return Pool index of the outgoing node+edge or null_index if not created
+     */
+    unsigned int get_outgoing_index(unsigned int index) const
+    {
+        return outgoing_indexes[index];
     }
 
     /**
-     * Verifies validity of outgoing node+edges i.e. pointers are all non null
+     * Verifies validity of outgoing node+edges i.e. indexes are all set
      */
-    bool valid_outgoing_node_edges(unsigned int index_limit = (1<<N_k))
+    bool valid_outgoing_node_edges(unsigned int index_limit = (1<<N_k)) const
     {
         for (unsigned int i=0; i<(1<<N_k); i++)
         {
@@ -123,7 +112,7 @@ public:
                 break;
             }
 
-            if (p_outgoing_node_edges[i] == 0)
+            if (outgoing_indexes[i] == CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>::null_index)
             {
                 return false;
             }
@@ -132,39 +121,8 @@ public:
         return true;
     }
 
-    /**
-     * Return a R/O reference to the outgoing node+edges
-     */
-    const std::array<CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>*, (1<<N_k)>& get_outgoing_node_edges() const
-    {
-        return p_outgoing_node_edges;
-    }
-
-    /**
-     * Return a R/W reference to the outgoing edges
-     */
-    std::array<CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>*, (1<<N_k)>& get_outgoing_node_edges()
-    {
-        return p_outgoing_node_edges;
-    }
-
-    /**
-     * Get pointer to the incoming edge
-     */
-    CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k> *get_incoming_node_edge()
-    {
-        return p_incoming_node_edge;
-    }
-    
 protected:
-    void clear_outgoing_edges()
-    {
-        std::fill(p_outgoing_node_edges.begin(), p_outgoing_node_edges.end(), (CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>*) 0);
-        //p_outgoing_node_edges.fill(0);
-    }
-
-    std::array<CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k>*, (1<<N_k)> p_outgoing_node_edges; //!< Outgoing edges+node pointers
-    CC_TreeNodeEdge_FA<T_IOSymbol, T_Register, T_Tag, N_k> *p_incoming_node_edge; //!< Pointer to the incoming edge+node
+    std::array<unsigned int, (1<<N_k)> outgoing_indexes; //!< Outgoing edges+node pool indexes
 };
 
 } // namespace ccsoft
@@ -34,34 +34,94 @@ class CC_TreeNodeEdgeTag_Empty
 };
 
 /**
- * \brief Represents a node and its incoming edge in the code tree
+ * \brief Holds the node+edge tag. The empty tag is inherited so that it takes no room in the node (empty base optimization).
+ * \tparam T_Tag Type of the node-edge tag
+ */
+template<typename T_Tag>
+class CC_TreeNodeEdgeTagHolder
+{
+public:
+    /**
+     * R/O reference to tag
+     */
+    const T_Tag& get_tag() const
+    {
+        return tag;
+    }
+
+    /**
+     * R/W reference to tag
+     */
+    T_Tag& get_tag()
+    {
+        return tag;
+    }
+
+protected:
+    T_Tag tag; //!< Optional and versatile object to tag the node+edge
+};
+
+/**
+ * \brief Holds the empty node+edge tag
+ */
+template<>
+class CC_TreeNodeEdgeTagHolder<CC_TreeNodeEdgeTag_Empty> : public CC_TreeNodeEdgeTag_Empty
+{
+public:
+    /**
+     * R/O reference to tag
+     */
+    const CC_TreeNodeEdgeTag_Empty& get_tag() const
+    {
+        return *this;
+    }
+
+    /**
+     * R/W reference to tag
+     */
+    CC_TreeNodeEdgeTag_Empty& get_tag()
+    {
+        return *this;
+    }
+};
+
+/**
+ * \brief Represents a node and its incoming edge in the code tree. The layout is compact: nodes live in the slabs of a
+ * CC_TreeNodeEdgePool and refer to each other by 32 bit pool indexes, depth, input symbol and flags are packed in a
+ * single 32 bit word and the encoder registers are packed in a single 64 bit state.
  * \tparam T_IOSymbol Type of the input and output symbols
  * \tparam T_Tag Type of the node-edge tag
  */
 template<typename T_IOSymbol, typename T_Tag>
-class CC_TreeNodeEdge_base
+class CC_TreeNodeEdge_base : public CC_TreeNodeEdgeTagHolder<T_Tag>
 {
 
 public:
+    static const unsigned int null_index = 0xFFFFFFFF;      //!< Index value of a missing node+edge
+    static const unsigned int depth_bits = 22;              //!< Number of bits used to store the depth
+    static const unsigned int in_symbol_bits = 8;           //!< Number of bits used to store the input symbol hence maximum k
+    static const int max_depth = (1<<depth_bits) - 2;       //!< Maximum depth of a node
+
     /**
      * Constructor
-     * \param _id Unique ID of the edge
+     * \param _id Unique ID of the node+edge. This is its index in the pool.
+     * \param _incoming_index Pool index of the incoming node+edge (null_index for the root node)
      * \param _in_symbol Input symbol corresponding to the edge
-     * \param _metric Metric of the edge
      * \param _path_metric Path metric at the node
      * \param _depth This node depth
+     * \param _state Packed encoder registers at the node
      */
 	CC_TreeNodeEdge_base(unsigned int _id,
+            unsigned int _incoming_index,
 			const T_IOSymbol& _in_symbol,
-            float _incoming_edge_metric,
             float _path_metric,
-            int _depth) :
+            int _depth,
+            unsigned long long _state) :
+                state(_state),
                 id(_id),
-                in_symbol(_in_symbol),
-                incoming_edge_metric(_incoming_edge_metric),
-                path_metric(_path_metric),
-                depth(_depth),
-                on_final_path(false)
+                incoming_index(_incoming_index),
+                packed(((unsigned int) (_depth + 1) & depth_mask) | (((unsigned int) _in_symbol & in_symbol_mask) << depth_bits)),
+                path_metric(_path_metric)
     {}
 
 	/**
@@ -84,7 +144,7 @@ public:
      */
     int get_depth() const
     {
-        return depth;
+        return (int) (packed & depth_mask) - 1;
     }
 
     /**
@@ -96,108 +156,119 @@ public:
     }
 
     /**
-     * For ordering by increasing path metric
+     * Get the pool index of the incoming node+edge
      */
-    bool operator<(const CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>& other) const
+    unsigned int get_incoming_index() const
     {
-        return path_metric < other.path_metric;
+        return incoming_index;
     }
 
     /**
-     * For ordering by decreasing path metric
+     * Set the pool index of the incoming node+edge. Used to re-root a pruned tree (null_index).
      */
-    bool operator>(const CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>& other) const
+    void set_incoming_index(unsigned int _incoming_index)
     {
-        return path_metric > other.path_metric;
+        incoming_index = _incoming_index;
     }
 
     /**
-     * Set the "on final path" marker
+     * Move the node along the depth axis and path metric scale. Used when the tree is re-rooted.
+     * \param depth_delta Depth difference to subtract
+     * \param path_metric_delta Path metric difference to subtract
      */
-    void set_on_final_path(bool _on_final_path = true)
+    void rebase(int depth_delta, float path_metric_delta)
     {
-        on_final_path = _on_final_path;
+        packed = (packed & ~depth_mask) | ((unsigned int) (get_depth() - depth_delta + 1) & depth_mask);
+        path_metric -= path_metric_delta;
     }
 
     /**
-     * Test the "on final path" marker
+     * Get the packed encoder registers
      */
-    bool is_on_final_path()
+    unsigned long long get_state() const
     {
-        return on_final_path;
+        return state;
     }
 
     /**
-     * Input symbol getter
+     * For ordering by increasing path metric
      */
-    const T_IOSymbol& get_in_symbol() const
+    bool operator<(const CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>& other) const
     {
-        return in_symbol;
+        return path_metric < other.path_metric;
     }
 
     /**
-     * Incoming edge metric getter
+     * For ordering by decreasing path metric
      */
-    float get_incoming_metric() const
+    bool operator>(const CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>& other) const
     {
-        return incoming_edge_metric;
+        return path_metric > other.path_metric;
     }
 
     /**
-     * R/O reference to tag
+     * Set the "on final path" marker
      */
-    const T_Tag& get_tag() const
+    void set_on_final_path(bool _on_final_path = true)
     {
-        return tag;
+        set_bit(final_path_bit, _on_final_path);
     }
 
     /**
-     * R/W reference to tag
+     * Test the "on final path" marker
      */
-    T_Tag& get_tag()
+    bool is_on_final_path() const
     {
-        return tag;
+        return (packed & final_path_bit) != 0;
     }
 
     /**
-     * Ordering - lesser
+     * Set the algorithm dependent flag (e.g. traversed back indicator in the Fano algorithm)
      */
-    bool operator<(const CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>& other)
+    void set_flag(bool _flag = true)
     {
-        if (path_metric == other.path_metric)
-        {
-            return id < other.id;
-        }
-        else
-        {
-            return path_metric < other.path_metric;
-        }
+        set_bit(flag_bit, _flag);
     }
 
     /**
-     * Ordering - greater
+     * Test the algorithm dependent flag
      */
-    bool operator>(const CC_TreeNodeEdge_base<T_IOSymbol, T_Tag>& other)
+    bool get_flag() const
     {
-        if (path_metric == other.path_metric)
+        return (packed & flag_bit) != 0;
+    }
+
+    /**
+     * Input symbol getter
+     */
+    T_IOSymbol get_in_symbol() const
+    {
+        return (T_IOSymbol) ((packed >> depth_bits) & in_symbol_mask);
+    }
+
+protected:
+    static const unsigned int depth_mask = (1<<depth_bits) - 1;
+    static const unsigned int in_symbol_mask = (1<<in_symbol_bits) - 1;
+    static const unsigned int final_path_bit = 1<<(depth_bits + in_symbol_bits);
+    static const unsigned int flag_bit = 1<<(depth_bits + in_symbol_bits + 1);
+
+    void set_bit(unsigned int bit, bool value)
+    {
+        if (value)
         {
-            return id > other.id;
+            packed |= bit;
         }
         else
         {
-            return path_metric > other.path_metric;
+            packed &= ~bit;
         }
     }
 
-
-protected:
-    unsigned int id; //!< Node-edge's unique ID
-    T_IOSymbol in_symbol; //!< Input symbol corresponding to the edge
-    float path_metric; //!< Path metric to the node
-    float incoming_edge_metric; //!< metric of the incoming edge to the node
-    int depth; //!< Depth of node in the tree: 0 = root
-    bool on_final_path; //!< Marks node when backtracking the solution
-    T_Tag tag; //!< Optional and versatile object to tag the node+edge
+    unsigned long long state;    //!< Encoder registers at the node packed in a single integer
+    unsigned int id;             //!< Node-edge's unique ID: its index in the pool
+    unsigned int incoming_index; //!< Pool index of the incoming node+edge
+    unsigned int packed;         //!< Depth + 1 (22 bits), input symbol (8 bits), on final path marker and algorithm flag
+    float path_metric;           //!< Path metric to the node
 };
 
 } // namespace ccsoft
@@ -0,0 +1,183 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Index of the best path metric reaching each trellis state at each depth
+ used to detect merging paths in the code tree
+
+ */
+#ifndef __CC_TRELLIS_STATE_INDEX_H__
+#define __CC_TRELLIS_STATE_INDEX_H__
+
+#include <vector>
+
+namespace ccsoft
+{
+
+/**
+ * \brief Best path metric by (depth, packed encoder state). Two code tree paths that reach the same encoder state at
+ * the same depth have the same future so the one with the lower metric can never win: it is dominated.
+ * This is an open addressing hash table with linear probing. Entries carry the generation of the decode that wrote
+ * them so that clearing between decodes is O(1) and the storage is kept from one decode to the next.
+ */
+class CC_TrellisStateIndex
+{
+public:
+    CC_TrellisStateIndex() :
+        nb_entries(0),
+        generation(1)
+    {
+        entries.resize(initial_capacity);
+    }
+
+    ~CC_TrellisStateIndex()
+    {}
+
+    /**
+     * Forget all entries
+     */
+    void clear()
+    {
+        nb_entries = 0;
+        generation++;
+
+        if (generation == 0) // wrapped around: stale entries could look current
+        {
+            entries.assign(entries.size(), Entry());
+            generation = 1;
+        }
+    }
+
+    /**
+     * Number of (depth, state) pairs indexed
+     */
+    unsigned int size() const
+    {
+        return nb_entries;
+    }
+
+    /**
+     * Record a path metric if it is better than the best one known for the same depth and state
+     * \param depth Depth of the node in the code tree
+     * \param state Packed encoder state at the node
+     * \param path_metric Path metric of the node
+     * \return true if the path is not dominated i.e. no other path reached this state at this depth with a metric
+     * greater or equal
+     */
+    bool improve(int depth, unsigned long long state, float path_metric)
+    {
+        if (2*(nb_entries+1) > entries.size()) // keep the load factor under 1/2
+        {
+            grow();
+        }
+
+        Entry& entry = entries[find(depth, state)];
+
+        if (entry.generation != generation)
+        {
+            entry.generation = generation;
+            entry.depth = depth;
+            entry.state = state;
+            entry.path_metric = path_metric;
+            nb_entries++;
+            return true;
+        }
+        else if (path_metric > entry.path_metric)
+        {
+            entry.path_metric = path_metric;
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    /**
+     * Tells if a path was superseded by a better one since it was recorded
+     * \param depth Depth of the node in the code tree
+     * \param state Packed encoder state at the node
+     * \param path_metric Path metric of the node
+     */
+    bool is_dominated(int depth, unsigned long long state, float path_metric) const
+    {
+        const Entry& entry = entries[find(depth, state)];
+        return (entry.generation == generation) && (entry.path_metric > path_metric);
+    }
+
+protected:
+    /**
+     * \brief Slot of the table
+     */
+    struct Entry
+    {
+        Entry() : state(0), depth(0), path_metric(0.0), generation(0) {}
+
+        unsigned long long state;
+        int depth;
+        float path_metric;
+        unsigned int generation; //!< Generation of the decode that wrote the entry. Entries of older generations are free.
+    };
+
+    static const unsigned int initial_capacity = 1<<10; //!< Initial number of slots. Always a power of two.
+
+    /**
+     * Find the slot of a key or the free slot where it would go
+     */
+    unsigned int find(int depth, unsigned long long state) const
+    {
+        unsigned long long h = state ^ ((unsigned long long) (unsigned int) depth << 40);
+        h ^= h >> 33; // 64 bit finalizer mix
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        unsigned int mask = entries.size() - 1;
+        unsigned int slot = (unsigned int) h & mask;
+
+        while ((entries[slot].generation == generation) && ((entries[slot].state != state) || (entries[slot].depth != depth)))
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        return slot;
+    }
+
+    /**
+     * Double the capacity and rehash the current entries
+     */
+    void grow()
+    {
+        std::vector<Entry> old_entries(entries.size()*2);
+        old_entries.swap(entries);
+
+        for (std::vector<Entry>::const_iterator it = old_entries.begin(); it != old_entries.end(); ++it)
+        {
+            if (it->generation == generation)
+            {
+                entries[find(it->depth, it->state)] = *it;
+            }
+        }
+    }
+
+    std::vector<Entry> entries; //!< Hash table slots
+    unsigned int nb_entries;    //!< Number of entries of the current generation
+    unsigned int generation;    //!< Current generation
+};
+
+} // namespace ccsoft
+
+#endif // __CC_TRELLIS_STATE_INDEX_H__
@@ -0,0 +1,510 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Convolutional soft-decision decoder based on the Viterbi algorithm.
+ Explores the whole code trellis hence has a fixed cost per symbol that
+ grows exponentially with the constraint length. Suits short constraint
+ codes.
+
+ */
+#ifndef __CC_VITERBI_DECODING_H__
+#define __CC_VITERBI_DECODING_H__
+
+#include "CC_SequentialDecoding.h"
+#include "CC_EdgeMetrics.h"
+#include "CC_ReliabilityMatrix.h"
+#include "CCSoft_Exception.h"
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+namespace ccsoft
+{
+
+/**
+ * \brief The Viterbi Decoding class. The trellis is derived from the encoder: a trellis state holds the
+ * constraint length - 1 most recent input bits of each register. The path metrics of all states are updated at each
+ * message symbol with add-compare-select (ACS) operations. For k=1 codes the ACS is done with butterflies that are
+ * vectorized with SSE (4 states) or AVX (8 states) when the compiler targets them. Survivor decisions are bit packed
+ * (k bits per state rounded up to a power of two). The decoded message is retrieved by tracing back survivors either
+ * over the whole message or by windows of the traceback length so that survivor memory does not depend on the
+ * message length. It shares the public interface of the sequential decoders.
+ * \tparam T_Register Type of the encoder internal registers
+ * \tparam T_IOSymbol Type of the input and output symbols
+ */
+template<typename T_Register, typename T_IOSymbol>
+class CC_ViterbiDecoding : public CC_SequentialDecoding<T_Register, T_IOSymbol>
+{
+public:
+    /**
+     * Constructor
+     * \param constraints Vector of register lengths (constraint length + 1). The number of elements determines k.
+     * \param genpoly_representations Generator polynomial numeric representations. There are as many elements as there
+     * are input bits (k). Each element is itself a vector with one polynomial value per output bit. The smallest size of
+     * these vectors is retained as the number of output bits n. The input bits of a symbol are clocked simultaneously into
+     * the right hand side, or least significant position of the internal registers. Therefore the given polynomial representation
+     * of generators should follow the same convention.
+     * \param _traceback_length Number of symbols traced back before decisions are output. Survivors are kept for twice
+     * this length. 0 means the whole message is traced back at the end.
+     */
+    CC_ViterbiDecoding(const std::vector<unsigned int>& constraints,
+            const std::vector<std::vector<T_Register> >& genpoly_representations,
+            unsigned int _traceback_length = 0) :
+                CC_SequentialDecoding<T_Register, T_IOSymbol>(constraints, genpoly_representations),
+                traceback_length(_traceback_length),
+                nb_tracebacks(0),
+                nb_branches(0)
+    {
+        init_trellis(constraints);
+    }
+
+    /**
+     * Destructor
+     */
+    virtual ~CC_ViterbiDecoding()
+    {}
+
+    /**
+     * Reset the decoding process
+     */
+    void reset()
+    {
+        Parent::reset();
+        nb_tracebacks = 0;
+        nb_branches = 0;
+    }
+
+    /**
+     * Get the number of trellis states
+     */
+    unsigned int get_nb_states() const
+    {
+        return nb_states;
+    }
+
+    /**
+     * Get the traceback length. 0 if the whole message is traced back.
+     */
+    unsigned int get_traceback_length() const
+    {
+        return traceback_length;
+    }
+
+    /**
+     * Get the number of tracebacks done during the last decode
+     */
+    unsigned int get_nb_tracebacks() const
+    {
+        return nb_tracebacks;
+    }
+
+    /**
+     * Get the number of branches explored during the last decode. The node count of the parent class gives the same
+     * number but saturates at the largest unsigned int for long messages with many states.
+     */
+    unsigned long long get_nb_branches() const
+    {
+        return nb_branches;
+    }
+
+    /**
+     * Decodes given the reliability matrix
+     * \param relmat Reference to the reliability matrix
+     * \param decoded_message Vector of symbols of retrieved message
+     */
+    virtual bool decode(const CC_ReliabilityMatrix& relmat, std::vector<T_IOSymbol>& decoded_message)
+    {
+        if (relmat.get_message_length() < Parent::encoding.get_m())
+        {
+            throw CCSoft_Exception("Reliability Matrix should have a number of columns at least equal to the code constraint");
+        }
+
+        if (relmat.get_nb_symbols_log2() != Parent::encoding.get_n())
+        {
+            throw CCSoft_Exception("Reliability Matrix is not compatible with code output symbol size");
+        }
+
+        reset();
+        CC_DecodingBudgetScope budget_scope(Parent::budget);
+        edge_metrics.init(relmat, Parent::edge_bias);
+
+        unsigned int message_length = relmat.get_message_length();
+        unsigned int emitted_length = 0; // number of symbols already decided by window tracebacks
+        survivors_length = ((traceback_length == 0) || (message_length <= 2*traceback_length) ? message_length : 2*traceback_length);
+        survivors.assign(survivors_length*words_per_step, 0);
+        path_metrics.assign(nb_states, -std::numeric_limits<float>::infinity());
+        path_metrics[0] = 0.0; // the encoder starts from the zero state
+        new_path_metrics.resize(nb_states);
+        decoded_message.resize(message_length);
+
+        for (unsigned int depth=0; depth<message_length; depth++)
+        {
+            unsigned long long *decisions = &survivors[(depth % survivors_length)*words_per_step];
+            std::fill(decisions, decisions + words_per_step, 0ULL);
+
+            if (k == 1)
+            {
+                acs_butterflies(edge_metrics.get_column(depth), decisions);
+            }
+            else
+            {
+                acs_generic(edge_metrics.get_column(depth), decisions);
+            }
+
+            path_metrics.swap(new_path_metrics);
+            nb_branches += ((unsigned long long) nb_states) << k; // branches explored
+            Parent::node_count = (nb_branches < std::numeric_limits<unsigned int>::max() ? nb_branches : std::numeric_limits<unsigned int>::max());
+
+            if ((survivors_length < message_length) && (depth + 1 - emitted_length == survivors_length))
+            {
+                traceback(get_best_state(), depth, emitted_length, emitted_length + traceback_length, decoded_message);
+                emitted_length += traceback_length;
+            }
+        }
+
+        unsigned int end_state = (Parent::tail_zeros ? 0 : get_best_state()); // zero tail brings the encoder back to the zero state
+        traceback(end_state, message_length - 1, emitted_length, message_length, decoded_message);
+        Parent::codeword_score = path_metrics[end_state];
+        Parent::cur_depth = message_length - 1;
+        Parent::max_depth = message_length - 1;
+
+        if (Parent::codeword_score == -std::numeric_limits<float>::infinity())
+        {
+            Parent::status = CC_Decoding_NoPath;
+            return false;
+        }
+
+        if ((Parent::use_metric_limit) && (Parent::codeword_score < Parent::metric_limit))
+        {
+            Parent::status = CC_Decoding_MetricLimit;
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Print stats to an output stream
+     * \param os Output stream
+     * \param success True if decoding was successful
+     */
+    virtual void print_stats(std::ostream& os, bool success)
+    {
+        os << "score = " << Parent::get_score()
+                << " #states = " << nb_states
+                << " #branches = " << nb_branches
+                << " tracebacks = " << nb_tracebacks;
+    }
+
+    /**
+     * Print stats summary to an output stream
+     * \param os Output stream
+     * \param success True if decoding was successful
+     */
+    virtual void print_stats_summary(std::ostream& os, bool success)
+    {
+        os << "_RES " << (success ? 1 : 0) << ","
+                << Parent::get_score() << ","
+                << nb_states << ","
+                << nb_branches << ","
+                << nb_tracebacks;
+    }
+
+    /**
+     * Print the dot (Graphviz) file. There is no code tree in trellis decoding so the graph is empty.
+     * \param os Output stream
+     */
+    virtual void print_dot(std::ostream& os)
+    {
+        os << "digraph G {" << std::endl;
+        os << "}" << std::endl;
+    }
+
+protected:
+    typedef CC_SequentialDecoding<T_Register, T_IOSymbol> Parent; //!< Parent class this class inherits from
+
+    static const unsigned int max_state_bits = 16; //!< Maximum number of bits of a trellis state
+
+    /**
+     * Build the trellis tables from the encoder
+     * \param constraints Vector of register lengths
+     */
+    void init_trellis(const std::vector<unsigned int>& constraints)
+    {
+        k = Parent::encoding.get_k();
+        std::vector<unsigned int> register_shifts; // position of registers in the encoder packed state
+        std::vector<unsigned int> memory_shifts;   // position of registers memory in the trellis state
+        std::vector<unsigned int> memory_lengths;
+        unsigned int register_shift = 0;
+        unsigned int state_bits = 0;
+
+        for (unsigned int ki=0; ki<k; ki++)
+        {
+            if (constraints[ki] < 2)
+            {
+                throw CCSoft_Exception("Viterbi decoding needs registers of at least 2 bits");
+            }
+
+            register_shifts.push_back(register_shift);
+            memory_shifts.push_back(state_bits);
+            memory_lengths.push_back(constraints[ki] - 1);
+            register_shift += constraints[ki];
+            state_bits += constraints[ki] - 1;
+        }
+
+        if (state_bits > max_state_bits)
+        {
+            throw CCSoft_Exception("Too many trellis states for Viterbi decoding");
+        }
+
+        nb_states = 1<<state_bits;
+        decision_bits = 1;
+
+        while (decision_bits < k)
+        {
+            decision_bits <<= 1;
+        }
+
+        words_per_step = (nb_states*decision_bits + 63) / 64;
+        outputs.resize(nb_states << k);
+        predecessors.resize(nb_states << k);
+        state_inputs.resize(nb_states);
+
+        for (unsigned int state=0; state<nb_states; state++)
+        {
+            unsigned long long packed_state = 0;
+            unsigned int decision = 0; // the oldest bit of each register memory is shifted out
+
+            for (unsigned int ki=0; ki<k; ki++)
+            {
+                unsigned long long memory = (state >> memory_shifts[ki]) & ((1ULL << memory_lengths[ki]) - 1);
+                packed_state |= memory << register_shifts[ki];
+                decision |= ((memory >> (memory_lengths[ki] - 1)) & 1) << ki;
+            }
+
+            for (unsigned int in_symbol=0; in_symbol < (1U<<k); in_symbol++)
+            {
+                unsigned long long next_packed_state = Parent::encoding.get_next_packed_state(packed_state, in_symbol);
+                unsigned int next_state = 0;
+
+                for (unsigned int ki=0; ki<k; ki++)
+                {
+                    next_state |= ((next_packed_state >> register_shifts[ki]) & ((1ULL << memory_lengths[ki]) - 1)) << memory_shifts[ki];
+                }
+
+                outputs[(state << k) + in_symbol] = Parent::encoding.get_output_symbol(next_packed_state);
+                predecessors[(next_state << k) + decision] = state;
+                state_inputs[next_state] = in_symbol;
+            }
+        }
+
+        if (k == 1)
+        {
+            branch_metrics_0.resize(nb_states);
+            branch_metrics_1.resize(nb_states);
+        }
+    }
+
+    /**
+     * Add-compare-select for k=1 codes. The predecessors of states 2i and 2i+1 are states i and i+S/2 (butterfly).
+     * \param metrics Edge metrics of each output symbol at this depth
+     * \param decisions Survivor decisions of this depth, 1 bit per state. Set to 1 when the predecessor is i+S/2.
+     */
+    void acs_butterflies(const float *metrics, unsigned long long *decisions)
+    {
+        unsigned int half = nb_states / 2;
+        unsigned int i = 0;
+
+        for (unsigned int state=0; state<nb_states; state++)
+        {
+            branch_metrics_0[state] = metrics[outputs[2*state]];
+            branch_metrics_1[state] = metrics[outputs[2*state+1]];
+        }
+
+        const float *pm = &path_metrics[0];
+        float *npm = &new_path_metrics[0];
+        const float *bm0 = &branch_metrics_0[0];
+        const float *bm1 = &branch_metrics_1[0];
+
+#ifdef __AVX__
+        for (; i + 8 <= half; i += 8)
+        {
+            __m256 pm_lo = _mm256_loadu_ps(pm + i);
+            __m256 pm_hi = _mm256_loadu_ps(pm + i + half);
+            __m256 c00 = _mm256_add_ps(pm_lo, _mm256_loadu_ps(bm0 + i));
+            __m256 c10 = _mm256_add_ps(pm_hi, _mm256_loadu_ps(bm0 + i + half));
+            __m256 c01 = _mm256_add_ps(pm_lo, _mm256_loadu_ps(bm1 + i));
+            __m256 c11 = _mm256_add_ps(pm_hi, _mm256_loadu_ps(bm1 + i + half));
+            __m256 m0 = _mm256_max_ps(c10, c00); // c10 > c00 ? c10 : c00
+            __m256 m1 = _mm256_max_ps(c11, c01);
+            __m256 d0 = _mm256_cmp_ps(c10, c00, _CMP_GT_OQ);
+            __m256 d1 = _mm256_cmp_ps(c11, c01, _CMP_GT_OQ);
+            __m256 m_lo = _mm256_unpacklo_ps(m0, m1); // unpack works within 128 bit lanes
+            __m256 m_hi = _mm256_unpackhi_ps(m0, m1);
+            __m256 d_lo = _mm256_unpacklo_ps(d0, d1);
+            __m256 d_hi = _mm256_unpackhi_ps(d0, d1);
+            _mm256_storeu_ps(npm + 2*i, _mm256_permute2f128_ps(m_lo, m_hi, 0x20));
+            _mm256_storeu_ps(npm + 2*i + 8, _mm256_permute2f128_ps(m_lo, m_hi, 0x31));
+            unsigned long long d_bits = _mm256_movemask_ps(_mm256_permute2f128_ps(d_lo, d_hi, 0x20))
+                | (_mm256_movemask_ps(_mm256_permute2f128_ps(d_lo, d_hi, 0x31)) << 8);
+            decisions[(2*i) / 64] |= d_bits << ((2*i) % 64);
+        }
+#endif
+#if defined(__AVX__) || defined(__SSE__)
+        for (; i + 4 <= half; i += 4)
+        {
+            __m128 pm_lo = _mm_loadu_ps(pm + i);
+            __m128 pm_hi = _mm_loadu_ps(pm + i + half);
+            __m128 c00 = _mm_add_ps(pm_lo, _mm_loadu_ps(bm0 + i));
+            __m128 c10 = _mm_add_ps(pm_hi, _mm_loadu_ps(bm0 + i + half));
+            __m128 c01 = _mm_add_ps(pm_lo, _mm_loadu_ps(bm1 + i));
+            __m128 c11 = _mm_add_ps(pm_hi, _mm_loadu_ps(bm1 + i + half));
+            __m128 m0 = _mm_max_ps(c10, c00); // c10 > c00 ? c10 : c00
+            __m128 m1 = _mm_max_ps(c11, c01);
+            __m128 d0 = _mm_cmpgt_ps(c10, c00);
+            __m128 d1 = _mm_cmpgt_ps(c11, c01);
+            _mm_storeu_ps(npm + 2*i, _mm_unpacklo_ps(m0, m1));
+            _mm_storeu_ps(npm + 2*i + 4, _mm_unpackhi_ps(m0, m1));
+            unsigned long long d_bits = _mm_movemask_ps(_mm_unpacklo_ps(d0, d1))
+                | (_mm_movemask_ps(_mm_unpackhi_ps(d0, d1)) << 4);
+            decisions[(2*i) / 64] |= d_bits << ((2*i) % 64);
+        }
+#endif
+        for (; i < half; i++)
+        {
+            float c00 = pm[i] + bm0[i];
+            float c10 = pm[i + half] + bm0[i + half];
+            float c01 = pm[i] + bm1[i];
+            float c11 = pm[i + half] + bm1[i + half];
+            npm[2*i] = (c10 > c00 ? c10 : c00);
+            npm[2*i + 1] = (c11 > c01 ? c11 : c01);
+            decisions[(2*i) / 64] |= ((unsigned long long) ((c10 > c00 ? 1 : 0) | (c11 > c01 ? 2 : 0))) << ((2*i) % 64);
+        }
+    }
+
+    /**
+     * Add-compare-select for any k. Each state has (1<<k) predecessors.
+     * \param metrics Edge metrics of each output symbol at this depth
+     * \param decisions Survivor decisions of this depth, decision_bits bits per state giving the selected predecessor.
+     */
+    void acs_generic(const float *metrics, unsigned long long *decisions)
+    {
+        for (unsigned int state=0; state<nb_states; state++)
+        {
+            unsigned int in_symbol = state_inputs[state];
+            unsigned int best_decision = 0;
+            float best_metric = -std::numeric_limits<float>::infinity();
+
+            for (unsigned int decision=0; decision < (1U<<k); decision++)
+            {
+                unsigned int predecessor = predecessors[(state << k) + decision];
+                float metric = path_metrics[predecessor] + metrics[outputs[(predecessor << k) + in_symbol]];
+
+                if ((decision == 0) || (metric > best_metric))
+                {
+                    best_metric = metric;
+                    best_decision = decision;
+                }
+            }
+
+            new_path_metrics[state] = best_metric;
+            decisions[(state*decision_bits) / 64] |= ((unsigned long long) best_decision) << ((state*decision_bits) % 64);
+        }
+    }
+
+    /**
+     * Trace back survivors from a state
+     * \param state State to start from
+     * \param from_depth Depth of the state
+     * \param to_depth Lowest depth traced back
+     * \param output_limit Decided symbols are stored only below this depth
+     * \param decoded_message Decoded message
+     */
+    void traceback(unsigned int state,
+            unsigned int from_depth,
+            unsigned int to_depth,
+            unsigned int output_limit,
+            std::vector<T_IOSymbol>& decoded_message)
+    {
+        unsigned int decision_mask = (1<<decision_bits) - 1;
+
+        for (int depth = from_depth; depth >= (int) to_depth; depth--)
+        {
+            const unsigned long long *decisions = &survivors[(depth % survivors_length)*words_per_step];
+            unsigned int decision = (decisions[(state*decision_bits) / 64] >> ((state*decision_bits) % 64)) & decision_mask;
+
+            if ((unsigned int) depth < output_limit)
+            {
+                decoded_message[depth] = state_inputs[state];
+            }
+
+            state = predecessors[(state << k) + decision];
+        }
+
+        nb_tracebacks++;
+    }
+
+    /**
+     * Get the state with the best path metric
+     */
+    unsigned int get_best_state() const
+    {
+        unsigned int best_state = 0;
+
+        for (unsigned int state=1; state<nb_states; state++)
+        {
+            if (path_metrics[state] > path_metrics[best_state])
+            {
+                best_state = state;
+            }
+        }
+
+        return best_state;
+    }
+
+    unsigned int k;                           //!< Number of input bits
+    unsigned int nb_states;                   //!< Number of trellis states
+    unsigned int decision_bits;               //!< Number of survivor decision bits per state
+    unsigned int words_per_step;              //!< Number of 64 bit words of survivor decisions per depth
+    unsigned int traceback_length;            //!< Traceback window length (0 for the whole message)
+    unsigned int survivors_length;            //!< Number of depths kept in survivors memory
+    unsigned int nb_tracebacks;               //!< Number of tracebacks done during the last decode
+    unsigned long long nb_branches;           //!< Number of branches explored during the last decode
+    std::vector<T_IOSymbol> outputs;          //!< Output symbol by (state << k) + input symbol
+    std::vector<unsigned int> predecessors;   //!< Predecessor state by (state << k) + decision
+    std::vector<T_IOSymbol> state_inputs;     //!< Input symbol leading to each state
+    std::vector<float> path_metrics;          //!< Path metrics of each state
+    std::vector<float> new_path_metrics;      //!< Path metrics of each state at the next depth
+    std::vector<float> branch_metrics_0;      //!< Branch metrics of input 0 by predecessor state (k=1)
+    std::vector<float> branch_metrics_1;      //!< Branch metrics of input 1 by predecessor state (k=1)
+    std::vector<unsigned long long> survivors; //!< Bit packed survivor decisions, circular by depth
+    CC_EdgeMetrics edge_metrics;              //!< Biased log2 reliabilities computed once per decode
+};
+
+} // namespace ccsoft
+
+#endif // __CC_VITERBI_DECODING_H__
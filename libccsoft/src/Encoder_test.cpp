@@ -25,6 +25,81 @@
 #include "CCSoft_Exception.h"
 #include <iostream>
 
+// ================================================================================================
+// Differential test of the bulk encoder against the symbol by symbol encoder. The message is
+// encoded twice from the same (non zero) register state with and without zero tail.
+template<typename T_Register, typename T_IOSymbol>
+bool check_bulk_encoding(ccsoft::CC_Encoding<T_Register, T_IOSymbol>& encoder, unsigned int nb_symbols, bool zero_tail, unsigned int seed)
+{
+    unsigned int k = encoder.get_k();
+    unsigned int n = encoder.get_n();
+    unsigned int lcg = seed;
+    std::vector<T_IOSymbol> in_symbols;
+
+    for (unsigned int si=0; si<nb_symbols; si++)
+    {
+        lcg = lcg*1103515245 + 12345;
+        in_symbols.push_back((lcg >> 16) & ((1<<k) - 1));
+    }
+
+    if (zero_tail)
+    {
+        in_symbols.insert(in_symbols.end(), encoder.get_m()-1, 0);
+    }
+
+    std::vector<unsigned char> in_packed((nb_symbols*k + 7) / 8, 0);
+    std::vector<unsigned char> out_packed_ref((in_symbols.size()*n + 7) / 8, 0);
+    std::vector<unsigned char> out_packed;
+
+    for (unsigned int si=0; si<nb_symbols; si++)
+    {
+        for (unsigned int ki=0; ki<k; ki++)
+        {
+            in_packed[(si*k + ki) / 8] |= ((in_symbols[si] >> ki) & 1) << ((si*k + ki) % 8);
+        }
+    }
+
+    T_IOSymbol out_symbol;
+    encoder.clear();
+    encoder.encode((1<<k) - 1, out_symbol); // start from a non zero state
+    std::vector<T_Register> start_registers = encoder.get_registers();
+
+    for (unsigned int si=0; si<in_symbols.size(); si++)
+    {
+        encoder.encode(in_symbols[si], out_symbol);
+
+        for (unsigned int ni=0; ni<n; ni++)
+        {
+            out_packed_ref[(si*n + ni) / 8] |= ((out_symbol >> ni) & 1) << ((si*n + ni) % 8);
+        }
+    }
+
+    std::vector<T_Register> end_registers = encoder.get_registers();
+    encoder.set_registers(start_registers);
+    unsigned int nb_out_symbols = encoder.encode_bulk(in_packed.size() ? &in_packed[0] : 0, nb_symbols, out_packed, zero_tail);
+
+    return (nb_out_symbols == in_symbols.size())
+        && (out_packed == out_packed_ref)
+        && (encoder.get_registers() == end_registers);
+}
+
+// ================================================================================================
+template<typename T_Register, typename T_IOSymbol>
+void test_bulk_encoding(ccsoft::CC_Encoding<T_Register, T_IOSymbol>& encoder)
+{
+    static const unsigned int nb_symbols[] = {1, 7, 63, 64, 65, 200, 1000};
+    bool success = true;
+
+    for (unsigned int i=0; i<sizeof(nb_symbols)/sizeof(unsigned int); i++)
+    {
+        success = success && check_bulk_encoding(encoder, nb_symbols[i], false, i);
+        success = success && check_bulk_encoding(encoder, nb_symbols[i], true, i);
+    }
+
+    std::cout << "bulk encoding: " << (success ? "OK" : "MISMATCH") << std::endl;
+    encoder.clear();
+}
+
 int main(int argc, char *argv[])
 {
     try
@@ -41,23 +116,24 @@ int main(int argc, char *argv[])
 
         std::cout << "JT CC encoder:" << std::endl;
         jt_cc_encoder.print(std::cout);
+        test_bulk_encoding(jt_cc_encoder);
         std::cout << std::endl;
 
-        // Example given for Mathworks poly2treillis function
+        // Example given for Mathworks poly2treillis function. Generator polynomials are given in octal.
 
         std::vector<unsigned int> p2t_ks;
         p2t_ks.push_back(5);
         p2t_ks.push_back(4);
 
         std::vector<unsigned char> p2t_g0;
-        p2t_g0.push_back(23);
-        p2t_g0.push_back(35);
+        p2t_g0.push_back(023);
+        p2t_g0.push_back(035);
         p2t_g0.push_back(0);
 
         std::vector<unsigned char> p2t_g1;
         p2t_g1.push_back(0);
-        p2t_g1.push_back(5);
-        p2t_g1.push_back(13);
+        p2t_g1.push_back(05);
+        p2t_g1.push_back(013);
 
         std::vector<std::vector<unsigned char> > p2t_gs;
         p2t_gs.push_back(p2t_g0);
@@ -67,6 +143,7 @@ int main(int argc, char *argv[])
 
         std::cout << "Mathworks poly2treillis example:" << std::endl;
         p2t_cc_encoder.print(std::cout);
+        test_bulk_encoding(p2t_cc_encoder);
         std::cout << std::endl;
 
         // Yunghsiang S. Han and Po-Ning Chen Sequential Decoding of Convolutional Codes
@@ -83,6 +160,7 @@ int main(int argc, char *argv[])
 
         std::cout << "Han & Chen example 1:" << std::endl;
         hanchen1_cc_encoder.print(std::cout);
+        test_bulk_encoding(hanchen1_cc_encoder);
 
         unsigned char hanchen1_in_symbols[7] = {1,1,1,0,1,0,0};
         unsigned char out_symbol;
@@ -117,6 +195,7 @@ int main(int argc, char *argv[])
 
         std::cout << "Han & Chen example 2:" << std::endl;
         hanchen2_cc_encoder.print(std::cout);
+        test_bulk_encoding(hanchen2_cc_encoder);
 
         unsigned char hanchen2_in_symbols[4] = {3,2,0,0};
 
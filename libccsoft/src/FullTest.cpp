@@ -25,6 +25,14 @@
 #include "CC_Encoding.h"
 #include "CC_StackDecoding.h"
 #include "CC_FanoDecoding.h"
+#include "CC_StackBucketDecoding.h"
+#include "CC_ViterbiDecoding.h"
+#include "CC_StackStreamDecoding.h"
+#include "CC_BidirectionalStackDecoding.h"
+#include "CC_MaxLogBCJRDecoding.h"
+#include "CC_DecoderPool.h"
+#include "CC_Simulation.h"
+#include "CC_Channel.h"
 #include "CCSoft_Exception.h"
 #include "URandom.h"
 
@@ -36,8 +44,10 @@
 #include <fstream>
 #include <cstring>
 #include <cctype> // for toupper
+#include <time.h>
 
 static URandom ur; // Global random generator object
+static ccsoft::CC_Channel channel; // Global bulk channel generator used with the channel option
 
 
 // ================================================================================================
@@ -121,7 +131,12 @@ public:
 	typedef enum
 	{
 		Algorithm_Stack,
-		Algorithm_FanoLike
+		Algorithm_FanoLike,
+		Algorithm_StackBucket,
+		Algorithm_Viterbi,
+		Algorithm_StackStream,
+		Algorithm_BidirectionalStack,
+		Algorithm_MaxLogBCJR
 	} Algorithm_type_t;
 
     Options() :
@@ -139,13 +154,31 @@ public:
         use_node_limit(false),
         metric_limit(0.0),
         use_metric_limit(false),
+        time_limit(0.0),
+        use_time_limit(false),
+        move_limit(0),
+        use_move_limit(false),
         algorithm_type(Algorithm_Stack),
         fano_init_metric(-1.0),
         fano_delta_metric(1.0),
         fano_tree_cache_size(0),
         edge_bias(0.0),
+        merge_detection(false),
         fano_delta_init_threshold(0.0),
-        interleave(false)
+        bucket_width(1.0),
+        stack_size_limit(0),
+        traceback_length(0),
+        decision_delay(0),
+        nb_frames(1),
+        nb_threads(0),
+        list_size(1),
+        interleave(false),
+        interleaver_type(ccsoft::CC_Interleaver_BitReversal),
+        interleaver_nb_rows(1),
+        interleaver_delay(1),
+        target_frame_errors(0),
+        use_channel(false),
+        channel_model(ccsoft::CC_Channel_AWGN)
     {}
 
     ~Options()
@@ -171,17 +204,38 @@ public:
     bool use_node_limit;
     float metric_limit;
     bool use_metric_limit;
+    float time_limit;
+    bool use_time_limit;
+    unsigned int move_limit;
+    bool use_move_limit;
     Algorithm_type_t algorithm_type;
     float fano_init_metric;
     float fano_delta_metric;
     unsigned int fano_tree_cache_size;
     float edge_bias;
+    bool merge_detection;
     float fano_delta_init_threshold;
+    float bucket_width;
+    unsigned int stack_size_limit;
+    unsigned int traceback_length;
+    unsigned int decision_delay;
+    unsigned int nb_frames;
+    unsigned int nb_threads;
+    unsigned int list_size;
     bool interleave;
+    ccsoft::CC_InterleaverType interleaver_type;
+    unsigned int interleaver_nb_rows;
+    unsigned int interleaver_delay;
+    std::vector<float> sim_snrs_dB;
+    unsigned int target_frame_errors;
+    bool use_channel; //!< generate the noise of a frame in one block with CC_Channel instead of URandom
+    ccsoft::CC_ChannelModel channel_model;
 
 private:
     bool parse_generator_polys_data(std::string generator_polys_data_str);
+    bool parse_channel_model(std::string channel_model_str);
     bool parse_algorithm_type(std::string algorithm_type_str);
+    bool parse_interleaver_type(std::string interleaver_type_str);
 };
 
 // ================================================================================================
@@ -208,11 +262,20 @@ bool Options::get_options(int argc, char *argv[])
             {"seed", required_argument, 0, 's'},
             {"node-limit", required_argument, 0, 'N'},
             {"metric-limit", required_argument, 0, 'M'},
+            {"time-limit", required_argument, 0, 'T'},
+            {"move-limit", required_argument, 0, 'L'},
             {"algorithm-type", required_argument,0, 'a'},
+            {"nb-frames", required_argument, 0, 'F'},
+            {"threads", required_argument, 0, 't'},
+            {"list-size", required_argument, 0, 'l'},
+            {"interleaver", required_argument, 0, 'I'},
+            {"sim-snrs", required_argument, 0, 'S'},
+            {"target-errors", required_argument, 0, 'E'},
+            {"channel", required_argument, 0, 'C'},
         };
 
         int option_index = 0;
-        c = getopt_long (argc, argv, "n:v:d:k:g:i:r:s:N:M:a:", long_options, &option_index);
+        c = getopt_long (argc, argv, "n:v:d:k:g:i:r:s:N:M:T:L:a:F:t:l:I:S:E:C:", long_options, &option_index);
 
         if (c == -1) // end of options
         {
@@ -267,14 +330,46 @@ bool Options::get_options(int argc, char *argv[])
                 status = extract_option<float, float>(metric_limit, 'M');
                 use_metric_limit = true;
                 break;
+            case 'T':
+                status = extract_option<float, float>(time_limit, 'T');
+                use_time_limit = true;
+                break;
+            case 'L':
+                status = extract_option<int, unsigned int>(move_limit, 'L');
+                use_move_limit = true;
+                break;
             case 'a':
                 status = parse_algorithm_type(std::string(optarg));
                 break;
+            case 'F':
+                status = extract_option<int, unsigned int>(nb_frames, 'F');
+                break;
+            case 't':
+                status = extract_option<int, unsigned int>(nb_threads, 't');
+                break;
+            case 'l':
+                status = extract_option<int, unsigned int>(list_size, 'l');
+                break;
+            case 'I':
+                status = parse_interleaver_type(std::string(optarg));
+                interleave = true;
+                break;
+            case 'S':
+                status = extract_vector<float>(sim_snrs_dB, ",", std::string(optarg));
+                break;
+            case 'E':
+                status = extract_option<int, unsigned int>(target_frame_errors, 'E');
+                break;
+            case 'C':
+                status = parse_channel_model(std::string(optarg));
+                break;
             case '?':
                 status = false;
                 break;
         }
     }
+
+    return status;
 }
 
 // ================================================================================================
@@ -307,6 +402,76 @@ bool Options::parse_generator_polys_data(std::string generator_polys_data_str)
     return true;
 }
 
+// ================================================================================================
+// AWGN or RAYLEIGH
+bool Options::parse_channel_model(std::string channel_model_str)
+{
+    std::transform(channel_model_str.begin(), channel_model_str.end(), channel_model_str.begin(), toupper);
+    use_channel = true;
+
+    if (channel_model_str == "AWGN")
+    {
+        channel_model = ccsoft::CC_Channel_AWGN;
+        return true;
+    }
+    else if (channel_model_str == "RAYLEIGH")
+    {
+        channel_model = ccsoft::CC_Channel_Rayleigh;
+        return true;
+    }
+    else
+    {
+        std::cerr << "Invalid channel model specification" << std::endl;
+        return false;
+    }
+}
+
+// ================================================================================================
+// BITREV (default), BLOCK:nb_rows or CONV:nb_branches,delay
+bool Options::parse_interleaver_type(std::string interleaver_type_str)
+{
+    std::vector<std::string> interleaver_strings;
+
+    if (!extract_vector(interleaver_strings, ":", interleaver_type_str))
+    {
+        std::cerr << "Invalid interleaver specification" << std::endl;
+        return false;
+    }
+
+    std::transform(interleaver_strings[0].begin(), interleaver_strings[0].end(), interleaver_strings[0].begin(), toupper);
+    std::vector<unsigned int> interleaver_parms;
+
+    if ((interleaver_strings.size() > 1) && !extract_vector(interleaver_parms, ",", interleaver_strings[1]))
+    {
+        std::cerr << "Invalid interleaver parameters specification" << std::endl;
+        return false;
+    }
+
+    if (interleaver_strings[0] == "BITREV")
+    {
+        interleaver_type = ccsoft::CC_Interleaver_BitReversal;
+        return true;
+    }
+    else if ((interleaver_strings[0] == "BLOCK") && (interleaver_parms.size() > 0))
+    {
+        interleaver_type = ccsoft::CC_Interleaver_Block;
+        interleaver_nb_rows = interleaver_parms[0];
+        return true;
+    }
+    else if ((interleaver_strings[0] == "CONV") && (interleaver_parms.size() > 1))
+    {
+        interleaver_type = ccsoft::CC_Interleaver_Convolutional;
+        interleaver_nb_rows = interleaver_parms[0];
+        interleaver_delay = interleaver_parms[1];
+        return true;
+    }
+    else
+    {
+        std::cerr << "Invalid interleaver specification" << std::endl;
+        return false;
+    }
+}
+
 // ================================================================================================
 bool Options::parse_algorithm_type(std::string algorithm_type_str)
 {
@@ -371,6 +536,10 @@ bool Options::parse_algorithm_type(std::string algorithm_type_str)
 				{
 					edge_bias = stack_parms[0];
 				}
+				if (stack_parms.size() > 1)
+				{
+					merge_detection = (stack_parms[1] != 0.0);
+				}
 			}
 			else
 			{
@@ -382,6 +551,115 @@ bool Options::parse_algorithm_type(std::string algorithm_type_str)
 		algorithm_type = Algorithm_Stack;
 		return true;
 	}
+	else if (algo_strings[0] == "BUCKET")
+	{
+		if (algo_strings.size() > 1)
+		{
+			std::vector<float> bucket_parms;
+
+			if (extract_vector(bucket_parms, ",", algo_strings[1]))
+			{
+				if (bucket_parms.size() > 0)
+				{
+					edge_bias = bucket_parms[0];
+				}
+				if (bucket_parms.size() > 1)
+				{
+					bucket_width = bucket_parms[1];
+				}
+				if (bucket_parms.size() > 2)
+				{
+					stack_size_limit = int(bucket_parms[2]);
+				}
+			}
+			else
+			{
+				std::cerr << "Invalid Stack-Bucket parameters specification" << std::endl;
+				return false;
+			}
+		}
+
+		algorithm_type = Algorithm_StackBucket;
+		return true;
+	}
+	else if (algo_strings[0] == "VITERBI")
+	{
+		if (algo_strings.size() > 1)
+		{
+			std::vector<unsigned int> viterbi_parms;
+
+			if (extract_vector(viterbi_parms, ",", algo_strings[1]))
+			{
+				if (viterbi_parms.size() > 0)
+				{
+					traceback_length = viterbi_parms[0];
+				}
+			}
+			else
+			{
+				std::cerr << "Invalid Viterbi parameters specification" << std::endl;
+				return false;
+			}
+		}
+
+		algorithm_type = Algorithm_Viterbi;
+		return true;
+	}
+	else if (algo_strings[0] == "STREAM")
+	{
+		if (algo_strings.size() > 1)
+		{
+			std::vector<float> stream_parms;
+
+			if (extract_vector(stream_parms, ",", algo_strings[1]))
+			{
+				if (stream_parms.size() > 0)
+				{
+					edge_bias = stream_parms[0];
+				}
+				if (stream_parms.size() > 1)
+				{
+					decision_delay = int(stream_parms[1]);
+				}
+			}
+			else
+			{
+				std::cerr << "Invalid Stack streaming parameters specification" << std::endl;
+				return false;
+			}
+		}
+
+		algorithm_type = Algorithm_StackStream;
+		return true;
+	}
+	else if (algo_strings[0] == "BIDIR")
+	{
+		if (algo_strings.size() > 1)
+		{
+			std::vector<float> bidir_parms;
+
+			if (extract_vector(bidir_parms, ",", algo_strings[1]))
+			{
+				if (bidir_parms.size() > 0)
+				{
+					edge_bias = bidir_parms[0];
+				}
+			}
+			else
+			{
+				std::cerr << "Invalid bidirectional Stack parameters specification" << std::endl;
+				return false;
+			}
+		}
+
+		algorithm_type = Algorithm_BidirectionalStack;
+		return true;
+	}
+	else if (algo_strings[0] == "BCJR")
+	{
+		algorithm_type = Algorithm_MaxLogBCJR;
+		return true;
+	}
 	else
 	{
 		return false;
@@ -412,6 +690,278 @@ void create_symbol_data(float *symbol_data,
     }
 }
 
+// ================================================================================================
+// enters the received symbol data of a frame in the reliability matrix either symbol by symbol from URandom or in
+// one block from the bulk channel generator seeded from URandom
+void enter_frame_data(ccsoft::CC_ReliabilityMatrix& relmat,
+        const std::vector<unsigned int>& out_symbols,
+        unsigned int nb_symbols,
+        const Options& options)
+{
+    if (options.use_channel && options.make_noise)
+    {
+        channel.fill(relmat, out_symbols);
+    }
+    else
+    {
+        float *symbol_data = new float[nb_symbols];
+
+        for (unsigned int i=0; i<out_symbols.size(); i++)
+        {
+            create_symbol_data(symbol_data, nb_symbols, out_symbols[i], options.snr_dB, options.make_noise);
+            relmat.enter_symbol_data(symbol_data);
+        }
+
+        delete[] symbol_data;
+    }
+}
+
+// ================================================================================================
+// creates and configures a decoder from the options. Returns 0 if the algorithm type is not recognized.
+ccsoft::CC_SequentialDecoding<unsigned int, unsigned int> *create_decoding(const Options& options)
+{
+    ccsoft::CC_SequentialDecoding<unsigned int, unsigned int> *cc_decoding;
+
+    if (options.algorithm_type == Options::Algorithm_Stack)
+    {
+        ccsoft::CC_StackDecoding<unsigned int, unsigned int> *stack_decoding = new ccsoft::CC_StackDecoding<unsigned int, unsigned int>(options.k_constraints, options.generator_polys);
+        stack_decoding->set_merge_detection(options.merge_detection);
+        cc_decoding = stack_decoding;
+    }
+    else if (options.algorithm_type == Options::Algorithm_FanoLike)
+    {
+        cc_decoding = new ccsoft::CC_FanoDecoding<unsigned int, unsigned int>(options.k_constraints,
+                options.generator_polys,
+                options.fano_init_metric,
+                options.fano_delta_metric,
+                options.fano_tree_cache_size,
+                options.fano_delta_init_threshold);
+    }
+    else if (options.algorithm_type == Options::Algorithm_StackBucket)
+    {
+        cc_decoding = new ccsoft::CC_StackBucketDecoding<unsigned int, unsigned int>(options.k_constraints,
+                options.generator_polys,
+                options.bucket_width,
+                options.stack_size_limit);
+    }
+    else if (options.algorithm_type == Options::Algorithm_Viterbi)
+    {
+        cc_decoding = new ccsoft::CC_ViterbiDecoding<unsigned int, unsigned int>(options.k_constraints,
+                options.generator_polys,
+                options.traceback_length);
+    }
+    else if (options.algorithm_type == Options::Algorithm_StackStream)
+    {
+        cc_decoding = new ccsoft::CC_StackStreamDecoding<unsigned int, unsigned int>(options.k_constraints,
+                options.generator_polys,
+                options.decision_delay);
+    }
+    else if (options.algorithm_type == Options::Algorithm_BidirectionalStack)
+    {
+        cc_decoding = new ccsoft::CC_BidirectionalStackDecoding<unsigned int, unsigned int>(options.k_constraints, options.generator_polys);
+    }
+    else if (options.algorithm_type == Options::Algorithm_MaxLogBCJR)
+    {
+        cc_decoding = new ccsoft::CC_MaxLogBCJRDecoding<unsigned int, unsigned int>(options.k_constraints, options.generator_polys);
+    }
+    else
+    {
+        return 0;
+    }
+
+    cc_decoding->set_verbosity(options.verbosity);
+    cc_decoding->set_edge_bias(options.edge_bias);
+
+    if (options.use_node_limit)
+    {
+        cc_decoding->set_node_limit(options.node_limit);
+    }
+
+    if (options.use_metric_limit)
+    {
+        cc_decoding->set_metric_limit(options.metric_limit);
+    }
+
+    if (options.use_time_limit)
+    {
+        cc_decoding->set_time_limit(options.time_limit);
+    }
+
+    if (options.use_move_limit)
+    {
+        cc_decoding->set_move_limit(options.move_limit);
+    }
+
+    if (options.interleaver_type == ccsoft::CC_Interleaver_Block)
+    {
+        cc_decoding->set_block_interleaver(options.interleaver_nb_rows);
+    }
+    else if (options.interleaver_type == ccsoft::CC_Interleaver_Convolutional)
+    {
+        cc_decoding->set_convolutional_interleaver(options.interleaver_nb_rows, options.interleaver_delay);
+    }
+
+    return cc_decoding;
+}
+
+// ================================================================================================
+// decodes a batch of frames over a pool of threads each running its own decoder
+void decode_batch(Options& options, ccsoft::CC_Encoding<unsigned int, unsigned int>& encoding)
+{
+    unsigned int nb_symbols = 1<<encoding.get_n();
+    unsigned int in_symbols_nb = 1<<encoding.get_k();
+    std::vector<std::vector<unsigned int> > messages(options.nb_frames);
+    std::vector<ccsoft::CC_ReliabilityMatrix> relmats;
+
+    for (unsigned int fi=0; fi<options.nb_frames; fi++)
+    {
+        if (options.generate_random_symbols)
+        {
+            for (unsigned int i=0; i<options.nb_random_symbols; i++)
+            {
+                messages[fi].push_back(ur.rand_int(in_symbols_nb));
+            }
+
+            for (unsigned int i=0; i<encoding.get_m()-1; i++)
+            {
+                messages[fi].push_back(0);
+            }
+        }
+        else
+        {
+            messages[fi] = options.input_symbols;
+        }
+
+        relmats.push_back(ccsoft::CC_ReliabilityMatrix(encoding.get_n(), messages[fi].size()));
+        std::vector<unsigned int> out_symbols(messages[fi].size());
+        encoding.clear();
+
+        for (unsigned int i=0; i<messages[fi].size(); i++)
+        {
+            encoding.encode(messages[fi][i], out_symbols[i]);
+        }
+
+        enter_frame_data(relmats.back(), out_symbols, nb_symbols, options);
+        relmats.back().normalize();
+    }
+
+    ccsoft::CC_DecoderPool<ccsoft::CC_SequentialDecoding<unsigned int, unsigned int>, unsigned int> decoder_pool(
+            [&options]() { return create_decoding(options); }, options.nb_threads);
+    std::vector<ccsoft::CC_DecoderPoolResult<unsigned int> > results;
+    ccsoft::CC_DecodeStatsAggregator stats_aggregator;
+    decoder_pool.set_stats_aggregator(&stats_aggregator);
+
+    timespec time1, time2;
+    clock_gettime(CLOCK_MONOTONIC, &time1);
+    decoder_pool.decode(relmats, results);
+    clock_gettime(CLOCK_MONOTONIC, &time2);
+
+    unsigned int nb_ok = 0;
+    unsigned int nb_errors = 0;
+    unsigned int nb_erasures = 0;
+    unsigned long long nb_nodes = 0;
+
+    for (unsigned int fi=0; fi<options.nb_frames; fi++)
+    {
+        nb_nodes += results[fi].nb_nodes;
+
+        if (!results[fi].success)
+        {
+            nb_erasures++;
+        }
+        else if (results[fi].decoded_message == messages[fi])
+        {
+            nb_ok++;
+        }
+        else
+        {
+            nb_errors++;
+        }
+
+        if (options.verbosity > 0)
+        {
+            std::cout << fi << ": " << (results[fi].success ? "decoded" : ccsoft::get_decoding_status_string(results[fi].status))
+                    << " score=" << results[fi].score << " nodes=" << results[fi].nb_nodes << std::endl;
+        }
+    }
+
+    double elapsed = (time2.tv_sec - time1.tv_sec) + (time2.tv_nsec - time1.tv_nsec) / 1e9;
+    std::cout << "_BATCH " << options.nb_frames << "," << decoder_pool.get_nb_threads() << "," << nb_ok << "," << nb_errors << ","
+            << nb_erasures << "," << nb_nodes << "," << decoder_pool.get_nb_steals() << "," << elapsed << std::endl;
+    std::cout << "_BSTATS ";
+    stats_aggregator.print(std::cout);
+    std::cout << std::endl;
+}
+
+// ================================================================================================
+// simulates the error rates at each SNR of the list with nb_frames frames at most of nb_random_symbols symbols
+void simulate(const Options& options)
+{
+    ccsoft::CC_Simulation<ccsoft::CC_SequentialDecoding<unsigned int, unsigned int>, unsigned int> simulation(
+            [&options]() { return create_decoding(options); }, options.nb_random_symbols, options.nb_threads);
+    unsigned int seed = (options.has_seed ? options.seed : ur.rand_uword());
+    std::cout << "Seed = " << std::dec << seed << std::endl;
+    simulation.set_seed(seed);
+    simulation.set_max_frames(options.nb_frames);
+    simulation.set_target_frame_errors(options.target_frame_errors);
+    simulation.set_channel_model(options.channel_model);
+    ccsoft::CC_DecodeStatsAggregator stats_aggregator;
+    simulation.set_stats_aggregator(&stats_aggregator);
+
+    std::vector<ccsoft::CC_SimulationPoint> points;
+    simulation.run(options.sim_snrs_dB, points);
+    ccsoft::CC_Simulation<ccsoft::CC_SequentialDecoding<unsigned int, unsigned int>, unsigned int>::print_table(std::cout, points, "_SIM ");
+    std::cout << "_BSTATS ";
+    stats_aggregator.print(std::cout);
+    std::cout << std::endl;
+}
+
+// ================================================================================================
+// decodes the list of the best messages with the stack algorithm. Returns true if the sent message is in the list.
+bool decode_list(const Options& options, ccsoft::CC_SequentialDecoding<unsigned int, unsigned int> *cc_decoding, const ccsoft::CC_ReliabilityMatrix& relmat)
+{
+    ccsoft::CC_StackDecoding<unsigned int, unsigned int> *stack_decoding = dynamic_cast<ccsoft::CC_StackDecoding<unsigned int, unsigned int> *>(cc_decoding);
+
+    if (!stack_decoding)
+    {
+        std::cerr << "List decoding is only available with the stack algorithm" << std::endl;
+        return false;
+    }
+
+    ccsoft::CC_DecodedList<unsigned int> decoded_list;
+
+    if (!stack_decoding->decode_list(relmat, decoded_list, options.list_size))
+    {
+        std::cout << "Message cannot be decoded" << std::endl;
+        std::cerr << cc_decoding->get_status_string() << std::endl;
+        return false;
+    }
+
+    bool found = false;
+    std::vector<unsigned int> message;
+
+    for (unsigned int i=0; i<decoded_list.size(); i++)
+    {
+        decoded_list.get_message(i, message);
+        bool sent = (message == options.input_symbols);
+        found |= sent;
+        std::cout << "#" << i << " " << decoded_list.get_score(i) << " ";
+        print_vector<unsigned int>(message, std::cout);
+        std::cout << (sent ? " <- sent" : "") << std::endl;
+    }
+
+    if (found)
+    {
+        std::cout << "Success!" << std::endl;
+    }
+    else
+    {
+        std::cout << "Failed :(" << std::endl;
+    }
+
+    return found;
+}
+
 // ================================================================================================
 int main(int argc, char *argv[])
 {
@@ -424,41 +974,18 @@ int main(int argc, char *argv[])
     
         try
         {
-            if (options.algorithm_type == Options::Algorithm_Stack)
-            {
-                cc_decoding = new ccsoft::CC_StackDecoding<unsigned int, unsigned int>(options.k_constraints, options.generator_polys);
-            }
-            else if (options.algorithm_type == Options::Algorithm_FanoLike)
-            {
-                cc_decoding = new ccsoft::CC_FanoDecoding<unsigned int, unsigned int>(options.k_constraints,
-                        options.generator_polys,
-                        options.fano_init_metric,
-                        options.fano_delta_metric,
-                        options.fano_tree_cache_size,
-                        options.fano_delta_init_threshold);
-            }
-            else
+            cc_decoding = create_decoding(options);
+
+            if (!cc_decoding)
             {
                 std::cerr << "Unrecognized algorithm type" << std::endl;
                 return 1;
             }
-             
-            cc_decoding->set_verbosity(options.verbosity);
-            cc_decoding->set_edge_bias(options.edge_bias); 
+
             cc_decoding->get_encoding().print(std::cout);
             unsigned int out_symbols_nb = 1<<cc_decoding->get_encoding().get_n();
             unsigned int in_symbols_nb = 1<<cc_decoding->get_encoding().get_k();
 
-            if (options.use_node_limit)
-            {
-                cc_decoding->set_node_limit(options.node_limit);
-            }
-
-            if (options.use_metric_limit)
-            {
-                cc_decoding->set_metric_limit(options.metric_limit);
-            }
-
             if (options.has_seed)
             {
                 ur.set_seed(options.seed);
@@ -481,7 +1008,27 @@ int main(int argc, char *argv[])
                 }
             }
 
-            if (options.input_symbols.size() > 0)
+            if (options.use_channel) // seeded after the random symbols so that they do not depend on the channel option
+            {
+                channel = ccsoft::CC_Channel(options.channel_model, ur.rand_uword());
+                channel.set_snr(options.snr_dB);
+            }
+
+            if (options.sim_snrs_dB.size() > 0)
+            {
+                if (options.nb_random_symbols == 0)
+                {
+                    std::cerr << "Simulation needs the number of random symbols of a frame (-r)" << std::endl;
+                    return 1;
+                }
+
+                simulate(options);
+            }
+            else if (options.nb_frames > 1)
+            {
+                decode_batch(options, cc_decoding->get_encoding());
+            }
+            else if (options.input_symbols.size() > 0)
             {
                 for (unsigned int i=0; i<cc_decoding->get_encoding().get_m()-1; i++)
                 {
@@ -490,14 +1037,12 @@ int main(int argc, char *argv[])
 
                 ccsoft::CC_ReliabilityMatrix relmat(cc_decoding->get_encoding().get_n(), options.input_symbols.size());
                 unsigned int nb_symbols = 1<<cc_decoding->get_encoding().get_n();
-                float *symbol_data = new float[nb_symbols];
-
+                std::vector<unsigned int> out_symbols;
                 std::ostringstream oos;
 
                 if (options.interleave)
                 {
                 	std::cout << "interleave" << std::endl;
-                	std::vector<unsigned int> out_symbols;
 
 					for (unsigned int i=0; i<options.input_symbols.size(); i++)
 					{
@@ -510,13 +1055,8 @@ int main(int argc, char *argv[])
 
 					cc_decoding->interleave(out_symbols);
 
-					for (unsigned int i=0; i<out_symbols.size(); i++)
-					{
-						create_symbol_data(symbol_data, nb_symbols, out_symbols[i], options.snr_dB, options.make_noise);
-						relmat.enter_symbol_data(symbol_data);
-					}
-
-					relmat.deinterleave();
+					relmat.set_deinterleaving(&cc_decoding->get_permutation(out_symbols.size())); // columns go to their place on entry
+					enter_frame_data(relmat, out_symbols, nb_symbols, options);
                 }
                 else
                 {
@@ -524,21 +1064,25 @@ int main(int argc, char *argv[])
 					{
 						unsigned int out_symbol;
 						cc_decoding->get_encoding().encode(options.input_symbols[i], out_symbol);
-						create_symbol_data(symbol_data, nb_symbols, out_symbol, options.snr_dB, options.make_noise);
-						relmat.enter_symbol_data(symbol_data);
+						out_symbols.push_back(out_symbol);
 						std::cout << options.input_symbols[i] << " ";
 						oos << out_symbol << " ";
 					}
+
+					enter_frame_data(relmat, out_symbols, nb_symbols, options);
                 }
 
-                delete[] symbol_data;
                 std::cout << std::endl;
                 std::cout << oos.str() << std::endl;
 
                 relmat.normalize();
                 std::vector<unsigned int> result;
 
-                if (cc_decoding->decode(relmat, result))
+                if (options.list_size > 1)
+                {
+                    success = decode_list(options, cc_decoding, relmat);
+                }
+                else if (cc_decoding->decode(relmat, result))
                 {
                     print_vector<unsigned int>(result, std::cout);
                     std::cout << " ";
@@ -565,6 +1109,7 @@ int main(int argc, char *argv[])
                 else
                 {
                     std::cout << "Message cannot be decoded" << std::endl;
+                    std::cerr << cc_decoding->get_status_string() << std::endl;
                 }
                 
                 cc_decoding->print_stats(std::cout, success);
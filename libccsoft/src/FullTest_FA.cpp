@@ -22,9 +22,7 @@
 */
 
 #include "CC_ReliabilityMatrix.h"
-#include "CC_Encoding_FA.h"
-#include "CC_StackDecoding_FA.h"
-#include "CC_FanoDecoding_FA.h"
+#include "CC_DecoderFactory.h"
 #include "CCSoft_Exception.h"
 #include "URandom.h"
 
@@ -121,7 +119,8 @@ public:
 	typedef enum
 	{
 		Algorithm_Stack,
-		Algorithm_FanoLike
+		Algorithm_FanoLike,
+		Algorithm_StackBucket
 	} Algorithm_type_t;
 
     Options() :
@@ -139,12 +138,19 @@ public:
         use_node_limit(false),
         metric_limit(0.0),
         use_metric_limit(false),
+        time_limit(0.0),
+        use_time_limit(false),
+        move_limit(0),
+        use_move_limit(false),
         algorithm_type(Algorithm_Stack),
         fano_init_metric(-1.0),
         fano_delta_metric(1.0),
         fano_tree_cache_size(0),
         edge_bias(0.0),
+        merge_detection(false),
         fano_delta_init_threshold(0.0),
+        bucket_width(1.0),
+        stack_size_limit(0),
         interleave(false)
     {}
 
@@ -171,12 +177,19 @@ public:
     bool use_node_limit;
     float metric_limit;
     bool use_metric_limit;
+    float time_limit;
+    bool use_time_limit;
+    unsigned int move_limit;
+    bool use_move_limit;
     Algorithm_type_t algorithm_type;
     float fano_init_metric;
     float fano_delta_metric;
     unsigned int fano_tree_cache_size;
     float edge_bias;
+    bool merge_detection;
     float fano_delta_init_threshold;
+    float bucket_width;
+    unsigned int stack_size_limit;
     bool interleave;
 
 private:
@@ -208,11 +221,13 @@ bool Options::get_options(int argc, char *argv[])
             {"seed", required_argument, 0, 's'},
             {"node-limit", required_argument, 0, 'N'},
             {"metric-limit", required_argument, 0, 'M'},
+            {"time-limit", required_argument, 0, 'T'},
+            {"move-limit", required_argument, 0, 'L'},
             {"algorithm-type", required_argument,0, 'a'},
         };
 
         int option_index = 0;
-        c = getopt_long (argc, argv, "n:v:d:k:g:i:r:s:N:M:a:", long_options, &option_index);
+        c = getopt_long (argc, argv, "n:v:d:k:g:i:r:s:N:M:T:L:a:", long_options, &option_index);
 
         if (c == -1) // end of options
         {
@@ -267,6 +282,14 @@ bool Options::get_options(int argc, char *argv[])
                 status = extract_option<float, float>(metric_limit, 'M');
                 use_metric_limit = true;
                 break;
+            case 'T':
+                status = extract_option<float, float>(time_limit, 'T');
+                use_time_limit = true;
+                break;
+            case 'L':
+                status = extract_option<int, unsigned int>(move_limit, 'L');
+                use_move_limit = true;
+                break;
             case 'a':
                 status = parse_algorithm_type(std::string(optarg));
                 break;
@@ -275,6 +298,8 @@ bool Options::get_options(int argc, char *argv[])
                 break;
         }
     }
+
+    return status;
 }
 
 // ================================================================================================
@@ -371,6 +396,10 @@ bool Options::parse_algorithm_type(std::string algorithm_type_str)
 				{
 					edge_bias = stack_parms[0];
 				}
+				if (stack_parms.size() > 1)
+				{
+					merge_detection = (stack_parms[1] != 0.0);
+				}
 			}
 			else
 			{
@@ -382,6 +411,37 @@ bool Options::parse_algorithm_type(std::string algorithm_type_str)
 		algorithm_type = Algorithm_Stack;
 		return true;
 	}
+	else if (algo_strings[0] == "BUCKET")
+	{
+		if (algo_strings.size() > 1)
+		{
+			std::vector<float> bucket_parms;
+
+			if (extract_vector(bucket_parms, ",", algo_strings[1]))
+			{
+				if (bucket_parms.size() > 0)
+				{
+					edge_bias = bucket_parms[0];
+				}
+				if (bucket_parms.size() > 1)
+				{
+					bucket_width = bucket_parms[1];
+				}
+				if (bucket_parms.size() > 2)
+				{
+					stack_size_limit = int(bucket_parms[2]);
+				}
+			}
+			else
+			{
+				std::cerr << "Invalid Stack-Bucket parameters specification" << std::endl;
+				return false;
+			}
+		}
+
+		algorithm_type = Algorithm_StackBucket;
+		return true;
+	}
 	else
 	{
 		return false;
@@ -420,34 +480,46 @@ int main(int argc, char *argv[])
 
     if (options.get_options(argc, argv))
     {
-        ccsoft::CC_SequentialDecoding_FA<unsigned int, unsigned int, 1> *cc_decoding;
+        ccsoft::CC_Decoder<unsigned int> *cc_decoding;
     
         try
         {
+            ccsoft::CC_DecoderAlgorithm algorithm;
+            ccsoft::CC_DecoderParameters parameters;
+
             if (options.algorithm_type == Options::Algorithm_Stack)
             {
-                cc_decoding = new ccsoft::CC_StackDecoding_FA<unsigned int, unsigned int, 1>(options.k_constraints, options.generator_polys);
+                algorithm = ccsoft::CC_Algorithm_Stack;
+                parameters.stack_merge_detection = options.merge_detection;
             }
             else if (options.algorithm_type == Options::Algorithm_FanoLike)
             {
-                cc_decoding = new ccsoft::CC_FanoDecoding_FA<unsigned int, unsigned int, 1>(options.k_constraints,
-                        options.generator_polys,
-                        options.fano_init_metric,
-                        options.fano_delta_metric,
-                        options.fano_tree_cache_size,
-                        options.fano_delta_init_threshold);
+                algorithm = ccsoft::CC_Algorithm_Fano;
+                parameters.fano_init_threshold = options.fano_init_metric;
+                parameters.fano_delta_threshold = options.fano_delta_metric;
+                parameters.fano_tree_cache_size = options.fano_tree_cache_size;
+                parameters.fano_delta_init_threshold = options.fano_delta_init_threshold;
+            }
+            else if (options.algorithm_type == Options::Algorithm_StackBucket)
+            {
+                algorithm = ccsoft::CC_Algorithm_StackBucket;
+                parameters.bucket_width = options.bucket_width;
+                parameters.stack_size_limit = options.stack_size_limit;
             }
             else
             {
                 std::cerr << "Unrecognized algorithm type" << std::endl;
                 return 1;
             }
+
+            // picks the fixed array instantiation matching k and the register size or falls back to the vector classes
+            cc_decoding = ccsoft::create_decoder<unsigned int>(algorithm, options.k_constraints, options.generator_polys, parameters);
              
             cc_decoding->set_verbosity(options.verbosity);
             cc_decoding->set_edge_bias(options.edge_bias); 
-            cc_decoding->get_encoding().print(std::cout);
-            unsigned int out_symbols_nb = 1<<cc_decoding->get_encoding().get_n();
-            unsigned int in_symbols_nb = 1<<cc_decoding->get_encoding().get_k();
+            cc_decoding->print_encoding(std::cout);
+            unsigned int out_symbols_nb = 1<<cc_decoding->get_n();
+            unsigned int in_symbols_nb = 1<<cc_decoding->get_k();
 
             if (options.use_node_limit)
             {
@@ -459,6 +531,16 @@ int main(int argc, char *argv[])
                 cc_decoding->set_metric_limit(options.metric_limit);
             }
 
+            if (options.use_time_limit)
+            {
+                cc_decoding->set_time_limit(options.time_limit);
+            }
+
+            if (options.use_move_limit)
+            {
+                cc_decoding->set_move_limit(options.move_limit);
+            }
+
             if (options.has_seed)
             {
                 ur.set_seed(options.seed);
@@ -483,13 +565,13 @@ int main(int argc, char *argv[])
 
             if (options.input_symbols.size() > 0)
             {
-                for (unsigned int i=0; i<cc_decoding->get_encoding().get_m()-1; i++)
+                for (unsigned int i=0; i<cc_decoding->get_m()-1; i++)
                 {
                     options.input_symbols.push_back(0);
                 }
 
-                ccsoft::CC_ReliabilityMatrix relmat(cc_decoding->get_encoding().get_n(), options.input_symbols.size());
-                unsigned int nb_symbols = 1<<cc_decoding->get_encoding().get_n();
+                ccsoft::CC_ReliabilityMatrix relmat(cc_decoding->get_n(), options.input_symbols.size());
+                unsigned int nb_symbols = 1<<cc_decoding->get_n();
                 float *symbol_data = new float[nb_symbols];
 
                 std::ostringstream oos;
@@ -501,7 +583,7 @@ int main(int argc, char *argv[])
 					for (unsigned int i=0; i<options.input_symbols.size(); i++)
 					{
 						unsigned int out_symbol;
-						cc_decoding->get_encoding().encode(options.input_symbols[i], out_symbol);
+						cc_decoding->encode(options.input_symbols[i], out_symbol);
 						out_symbols.push_back(out_symbol);
 						std::cout << options.input_symbols[i] << " ";
 						oos << out_symbol << " ";
@@ -510,21 +592,21 @@ int main(int argc, char *argv[])
                 	std::cout << std::endl << "interleave" << std::endl;
 					cc_decoding->interleave(out_symbols);
 
+                	std::cout << "deinterleave" << std::endl;
+					relmat.set_deinterleaving(&cc_decoding->get_permutation(out_symbols.size())); // columns go to their place on entry
+
 					for (unsigned int i=0; i<out_symbols.size(); i++)
 					{
 						create_symbol_data(symbol_data, nb_symbols, out_symbols[i], options.snr_dB, options.make_noise);
 						relmat.enter_symbol_data(symbol_data);
 					}
-
-                	std::cout << "deinterleave" << std::endl;
-					relmat.deinterleave();
                 }
                 else
                 {
 					for (unsigned int i=0; i<options.input_symbols.size(); i++)
 					{
 						unsigned int out_symbol;
-						cc_decoding->get_encoding().encode(options.input_symbols[i], out_symbol);
+						cc_decoding->encode(options.input_symbols[i], out_symbol);
 						create_symbol_data(symbol_data, nb_symbols, out_symbol, options.snr_dB, options.make_noise);
 						relmat.enter_symbol_data(symbol_data);
 						std::cout << options.input_symbols[i] << " ";
@@ -566,6 +648,7 @@ int main(int argc, char *argv[])
                 else
                 {
                     std::cout << "Message cannot be decoded" << std::endl;
+                    std::cerr << cc_decoding->get_status_string() << std::endl;
                 }
                 
                 cc_decoding->print_stats(std::cout, success);
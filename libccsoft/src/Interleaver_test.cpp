@@ -79,6 +79,52 @@ int main(int argc, char *argv[])
         cc_decoding.interleave(test_symbols, false);
         print_vector<unsigned int, unsigned int, std::ostream>(test_symbols, std::cout);
         std::cout << std::endl;
+
+        std::cout << "block interleave 2 rows:" << std::endl;
+        cc_decoding.set_block_interleaver(2);
+        cc_decoding.interleave(test_symbols);
+        print_vector<unsigned int, unsigned int, std::ostream>(test_symbols, std::cout);
+        std::cout << std::endl;
+        cc_decoding.interleave(test_symbols, false);
+        print_vector<unsigned int, unsigned int, std::ostream>(test_symbols, std::cout);
+        std::cout << std::endl;
+
+        std::cout << "convolutional interleave 2 branches delay 1:" << std::endl;
+        cc_decoding.set_convolutional_interleaver(2, 1);
+        cc_decoding.interleave(test_symbols);
+        print_vector<unsigned int, unsigned int, std::ostream>(test_symbols, std::cout);
+        std::cout << std::endl;
+        cc_decoding.interleave(test_symbols, false);
+        print_vector<unsigned int, unsigned int, std::ostream>(test_symbols, std::cout);
+        std::cout << std::endl;
+
+        std::cout << "reliability matrix columns:" << std::endl;
+        ccsoft::CC_ReliabilityMatrix relmat(1, test_symbols.size());
+
+        for (unsigned int i=0; i<test_symbols.size(); i++)
+        {
+            relmat(0, i) = test_symbols[i];
+            relmat(1, i) = 0.0;
+        }
+
+        cc_decoding.set_bit_reversal_interleaver();
+        cc_decoding.deinterleave(relmat, true);
+        std::cout << relmat;
+        cc_decoding.deinterleave(relmat);
+        std::cout << relmat;
+
+        std::cout << "deinterleave on ingest:" << std::endl;
+        cc_decoding.interleave(test_symbols);
+        relmat.set_deinterleaving(&cc_decoding.get_permutation(test_symbols.size()));
+
+        for (unsigned int i=0; i<test_symbols.size(); i++)
+        {
+            float symbol_data[2] = {(float) test_symbols[i], 0.0};
+            relmat.enter_symbol_data(symbol_data);
+            std::cout << relmat.get_nb_ready_columns() << " ";
+        }
+
+        std::cout << std::endl << relmat;
     }
     catch (ccsoft::CCSoft_Exception& e)
     {
@@ -39,12 +39,14 @@ int main(int argc, char *argv[])
     std::cout << "TreeNode .........: " << sizeof(ccsoft::CC_TreeNode<unsigned int, unsigned int, ccsoft::CC_TreeEdgeTag_Empty>) << " bytes" << std::endl;
     std::cout << "TreeEdge .........: " << sizeof(ccsoft::CC_TreeEdge<unsigned int, unsigned int, ccsoft::CC_TreeEdgeTag_Empty>) << " bytes" << std::endl;
     std::cout << "TreeNodeEdge .....: " << sizeof(ccsoft::CC_TreeNodeEdge<unsigned int, unsigned int, ccsoft::CC_TreeNodeEdgeTag_Empty>) << " bytes" << std::endl;
+    std::cout << "TreeNodeEdge rec. : " << ccsoft::CC_TreeNodeEdge<unsigned int, unsigned int, ccsoft::CC_TreeNodeEdgeTag_Empty>::get_record_size(1) << " bytes (k=1)" << std::endl;
     std::cout << std::endl;
 
     std::cout << "<unsigned int, unsigned int, bool>" << std::endl;
     std::cout << "TreeNode .........: " << sizeof(ccsoft::CC_TreeNode<unsigned int, unsigned int, bool>) << " bytes" << std::endl;
     std::cout << "TreeEdge .........: " << sizeof(ccsoft::CC_TreeEdge<unsigned int, unsigned int, bool>) << " bytes" << std::endl;
     std::cout << "TreeNodeEdge .....: " << sizeof(ccsoft::CC_TreeNodeEdge<unsigned int, unsigned int, bool>) << " bytes" << std::endl;
+    std::cout << "TreeNodeEdge rec. : " << ccsoft::CC_TreeNodeEdge<unsigned int, unsigned int, bool>::get_record_size(1) << " bytes (k=1)" << std::endl;
     std::cout << std::endl;
 
     std::cout << "<unsigned int, unsigned int, empty, 1>" << std::endl;
@@ -0,0 +1,430 @@
+/*
+     Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+     This file is part of CCSoft. A Convolutional Codes Soft Decoding library
+
+     This program is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published by
+     the Free Software Foundation; either version 2 of the License, or
+     (at your option) any later version.
+
+     This program is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+     GNU General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with this program; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+     Stack versus stack-bucket decoder comparison on the same AWGN frames
+
+*/
+
+#include "CC_ReliabilityMatrix.h"
+#include "CC_Encoding.h"
+#include "CC_StackDecoding.h"
+#include "CC_StackBucketDecoding.h"
+#include "CCSoft_Exception.h"
+#include "URandom.h"
+
+#include <getopt.h>
+#include <time.h>
+#include <boost/lexical_cast.hpp>
+#include <boost/tokenizer.hpp>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+static URandom ur; // Global random generator object
+
+// ================================================================================================
+// template to extract information from getopt more easily
+template<typename TOpt, typename TField> bool extract_option(TField& field, char short_option)
+{
+    TOpt option_value;
+
+    try
+    {
+        option_value = boost::lexical_cast<TOpt>(optarg);
+        field = option_value;
+        return true;
+    }
+    catch (boost::bad_lexical_cast &)
+    {
+        std::cout << "wrong argument for -" << short_option << ": " << optarg << " leave default (" << field << ")";
+        std::cout << std::endl;
+        return false;
+    }
+}
+
+// ================================================================================================
+// template to extract a vector of elements from a delimiter separated string
+template<typename TElement> bool extract_vector(std::vector<TElement>& velements, const char *separator, std::string cs_string)
+{
+    std::string element_str;
+    TElement element;
+
+    boost::char_separator<char> sep(separator);
+    boost::tokenizer<boost::char_separator<char> > tokens(cs_string, sep);
+
+    boost::tokenizer<boost::char_separator<char> >::iterator tok_iter = tokens.begin();
+    boost::tokenizer<boost::char_separator<char> >::iterator toks_end = tokens.end();
+
+    try
+    {
+        for (; tok_iter != toks_end; ++tok_iter)
+        {
+            element = boost::lexical_cast<TElement>(*tok_iter);
+            velements.push_back(element);
+        }
+        return true;
+    }
+    catch (boost::bad_lexical_cast &)
+    {
+        std::cout << "wrong element in delimiter separated string argument: " << *tok_iter << std::endl;
+        return false;
+    }
+}
+
+// ================================================================================================
+struct Options
+{
+public:
+    Options() :
+        snr_dB(0),
+        nb_random_symbols(60),
+        nb_frames(100),
+        seed(0),
+        has_seed(false),
+        node_limit(0),
+        use_node_limit(false),
+        metric_limit(0.0),
+        use_metric_limit(false),
+        edge_bias(0.0),
+        bucket_width(1.0),
+        stack_size_limit(0)
+    {}
+
+    ~Options()
+    {}
+
+    bool get_options(int argc, char *argv[]);
+
+    float snr_dB;
+    std::vector<unsigned int> k_constraints;
+    std::vector<std::vector<unsigned int> > generator_polys;
+    unsigned int nb_random_symbols;
+    unsigned int nb_frames;
+    unsigned int seed;
+    bool has_seed;
+    unsigned int node_limit;
+    bool use_node_limit;
+    float metric_limit;
+    bool use_metric_limit;
+    float edge_bias;
+    float bucket_width;
+    unsigned int stack_size_limit;
+
+private:
+    bool parse_generator_polys_data(std::string generator_polys_data_str);
+};
+
+// ================================================================================================
+bool Options::get_options(int argc, char *argv[])
+{
+    int c;
+    bool status = true;
+
+    while (true)
+    {
+        static struct option long_options[] =
+        {
+            {"snr", required_argument, 0, 'n'},
+            {"k-constraints", required_argument, 0, 'k'},
+            {"gen-polys", required_argument, 0, 'g'},
+            {"nb-random-symbols", required_argument, 0, 'r'},
+            {"nb-frames", required_argument, 0, 'f'},
+            {"seed", required_argument, 0, 's'},
+            {"node-limit", required_argument, 0, 'N'},
+            {"metric-limit", required_argument, 0, 'M'},
+            {"edge-bias", required_argument, 0, 'b'},
+            {"bucket-width", required_argument, 0, 'w'},
+            {"stack-size-limit", required_argument, 0, 'c'},
+            {0, 0, 0, 0}
+        };
+
+        int option_index = 0;
+        c = getopt_long (argc, argv, "n:k:g:r:f:s:N:M:b:w:c:", long_options, &option_index);
+
+        if (c == -1) // end of options
+        {
+            break;
+        }
+
+        switch(c)
+        {
+            case 'n':
+                status = extract_option<double, float>(snr_dB, 'n');
+                break;
+            case 'k':
+                status = extract_vector<unsigned int>(k_constraints, ",", std::string(optarg));
+                break;
+            case 'g':
+                status = parse_generator_polys_data(std::string(optarg));
+                break;
+            case 'r':
+                status = extract_option<int, unsigned int>(nb_random_symbols, 'r');
+                break;
+            case 'f':
+                status = extract_option<int, unsigned int>(nb_frames, 'f');
+                break;
+            case 's':
+                status = extract_option<int, unsigned int>(seed, 's');
+                has_seed = true;
+                break;
+            case 'N':
+                status = extract_option<int, unsigned int>(node_limit, 'N');
+                use_node_limit = true;
+                break;
+            case 'M':
+                status = extract_option<float, float>(metric_limit, 'M');
+                use_metric_limit = true;
+                break;
+            case 'b':
+                status = extract_option<float, float>(edge_bias, 'b');
+                break;
+            case 'w':
+                status = extract_option<float, float>(bucket_width, 'w');
+                break;
+            case 'c':
+                status = extract_option<int, unsigned int>(stack_size_limit, 'c');
+                break;
+            case '?':
+                status = false;
+                break;
+        }
+    }
+
+    if (status)
+    {
+        if ((k_constraints.size() == 0) || (generator_polys.size() != k_constraints.size()))
+        {
+            std::cerr << "There must be one register length (-k) and one set of generator polynomials (-g) per input bit" << std::endl;
+            status = false;
+        }
+        else
+        {
+            for (unsigned int ki=0; ki<generator_polys.size(); ki++)
+            {
+                if (generator_polys[ki].size() == 0)
+                {
+                    std::cerr << "Empty generator polynomials specification" << std::endl;
+                    status = false;
+                }
+            }
+        }
+    }
+
+    return status;
+}
+
+// ================================================================================================
+bool Options::parse_generator_polys_data(std::string generator_polys_data_str)
+{
+    std::vector<std::string> g_strings;
+
+    if (!extract_vector(g_strings, ":", generator_polys_data_str))
+    {
+    	std::cerr << "Invalid generator polynomials specification" << std::endl;
+        return false;
+    }
+
+    std::vector<std::string>::const_iterator gs_it = g_strings.begin();
+
+    for (; gs_it != g_strings.end(); ++gs_it)
+    {
+        std::vector<unsigned int> g;
+
+        if (extract_vector<unsigned int>(g, ",", *gs_it))
+        {
+            generator_polys.push_back(g);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ================================================================================================
+// Accumulated results of one decoder over all frames
+struct DecoderResults
+{
+    DecoderResults() :
+        nb_success(0),
+        nb_nodes(0),
+        elapsed_s(0.0)
+    {}
+
+    unsigned int nb_success;
+    unsigned long nb_nodes;
+    double elapsed_s;
+};
+
+// ================================================================================================
+double elapsed_seconds(const timespec& start, const timespec& stop)
+{
+    return (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// ================================================================================================
+void run_decoder(ccsoft::CC_SequentialDecoding<unsigned int, unsigned int>& decoding,
+        const ccsoft::CC_ReliabilityMatrix& relmat,
+        const std::vector<unsigned int>& input_symbols,
+        DecoderResults& results)
+{
+    std::vector<unsigned int> decoded;
+    timespec start, stop;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    bool decoded_ok = decoding.decode(relmat, decoded);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    results.elapsed_s += elapsed_seconds(start, stop);
+    results.nb_nodes += decoding.get_nb_nodes();
+
+    if (decoded_ok && (decoded == input_symbols))
+    {
+        results.nb_success++;
+    }
+}
+
+// ================================================================================================
+void print_results(const char *name, const DecoderResults& results, unsigned int nb_frames)
+{
+    std::cout << std::setw(8) << name
+            << " success = " << results.nb_success << "/" << nb_frames
+            << " avg #nodes = " << (nb_frames > 0 ? results.nb_nodes / nb_frames : 0)
+            << " time = " << std::fixed << std::setprecision(3) << results.elapsed_s << " s"
+            << std::endl;
+}
+
+// ================================================================================================
+void print_usage(const char *program_name)
+{
+    std::cerr << "Usage: " << program_name << " -k constraints -g gen_polys [options]" << std::endl
+            << "  -k, --k-constraints     comma separated register lengths, one per input bit (e.g. 7)" << std::endl
+            << "  -g, --gen-polys         comma separated generator polynomials of each input bit, inputs separated by colons (e.g. 91,121)" << std::endl
+            << "  -n, --snr               SNR in dB" << std::endl
+            << "  -r, --nb-random-symbols number of random symbols per frame" << std::endl
+            << "  -f, --nb-frames         number of frames" << std::endl
+            << "  -s, --seed              random seed" << std::endl
+            << "  -N, --node-limit        node limit" << std::endl
+            << "  -M, --metric-limit      metric limit" << std::endl
+            << "  -b, --edge-bias         edge metric bias" << std::endl
+            << "  -w, --bucket-width      stack-bucket width" << std::endl
+            << "  -c, --stack-size-limit  stack-bucket size limit" << std::endl;
+}
+
+// ================================================================================================
+int main(int argc, char *argv[])
+{
+    Options options;
+
+    if (!options.get_options(argc, argv))
+    {
+        std::cout << "Wrong options" << std::endl;
+        print_usage(argv[0]);
+        return -1;
+    }
+
+    try
+    {
+        ccsoft::CC_StackDecoding<unsigned int, unsigned int> stack_decoding(options.k_constraints, options.generator_polys);
+        ccsoft::CC_StackBucketDecoding<unsigned int, unsigned int> bucket_decoding(options.k_constraints,
+                options.generator_polys,
+                options.bucket_width,
+                options.stack_size_limit);
+        ccsoft::CC_SequentialDecoding<unsigned int, unsigned int> *decodings[2] = {&stack_decoding, &bucket_decoding};
+
+        for (unsigned int di=0; di<2; di++)
+        {
+            decodings[di]->set_edge_bias(options.edge_bias);
+
+            if (options.use_node_limit)
+            {
+                decodings[di]->set_node_limit(options.node_limit);
+            }
+
+            if (options.use_metric_limit)
+            {
+                decodings[di]->set_metric_limit(options.metric_limit);
+            }
+        }
+
+        if (options.has_seed)
+        {
+            ur.set_seed(options.seed);
+        }
+
+        ccsoft::CC_Encoding<unsigned int, unsigned int> encoding(options.k_constraints, options.generator_polys);
+        encoding.print(std::cout);
+        unsigned int in_symbols_nb = 1<<encoding.get_k();
+        unsigned int nb_symbols = 1<<encoding.get_n();
+        unsigned int message_length = options.nb_random_symbols + encoding.get_m() - 1;
+        double std_dev = 1.0 / pow(10.0, (options.snr_dB/10.0)); // Standard deviation for power AWGN
+        std::vector<float> symbol_data(nb_symbols);
+        DecoderResults stack_results, bucket_results;
+
+        for (unsigned int fi=0; fi<options.nb_frames; fi++)
+        {
+            std::vector<unsigned int> input_symbols;
+            ccsoft::CC_ReliabilityMatrix relmat(encoding.get_n(), message_length);
+
+            for (unsigned int i=0; i<options.nb_random_symbols; i++)
+            {
+                input_symbols.push_back(ur.rand_int(in_symbols_nb));
+            }
+
+            for (unsigned int i=0; i<encoding.get_m()-1; i++)
+            {
+                input_symbols.push_back(0);
+            }
+
+            encoding.clear();
+
+            for (unsigned int i=0; i<input_symbols.size(); i++)
+            {
+                unsigned int out_symbol;
+                encoding.encode(input_symbols[i], out_symbol);
+
+                for (unsigned int si=0; si<nb_symbols; si++)
+                {
+                    symbol_data[si] = (si == out_symbol ? 1.0 : 0.0) + std_dev * ur.rand_gaussian();
+                    symbol_data[si] *= symbol_data[si];
+                }
+
+                relmat.enter_symbol_data(&symbol_data[0]);
+            }
+
+            relmat.normalize();
+
+            run_decoder(stack_decoding, relmat, input_symbols, stack_results);
+            run_decoder(bucket_decoding, relmat, input_symbols, bucket_results);
+        }
+
+        print_results("stack", stack_results, options.nb_frames);
+        print_results("bucket", bucket_results, options.nb_frames);
+        std::cout << "bucket dropped (last frame) = " << bucket_decoding.get_nb_dropped() << std::endl;
+    }
+    catch (ccsoft::CCSoft_Exception& e)
+    {
+        std::cout << "CCSoft exception caught: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,443 @@
+/*
+     Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+     This file is part of RSSoft. A Reed-Solomon Soft Decoding library
+
+     This program is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published by
+     the Free Software Foundation; either version 2 of the License, or
+     (at your option) any later version.
+
+     This program is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+     GNU General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with this program; if not, write to the Free Software
+     Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+	 Micro and macro benchmarks of the Reed-Solomon library: field and
+	 polynomial arithmetic, channel noise generation and full soft
+	 decoding of AWGN codewords at
+	 several multiplicities and SNRs. Inputs are generated from fixed
+	 seeds so that runs are comparable.
+
+*/
+
+#include "GFq.h"
+#include "GF2_Element.h"
+#include "GF2_Polynomial.h"
+#include "GFq_Element.h"
+#include "GFq_Polynomial.h"
+#include "GFq_BivariateMonomial.h"
+#include "GFq_BivariatePolynomial.h"
+#include "GF_Utils.h"
+#include "EvaluationValues.h"
+#include "RS_ReliabilityMatrix.h"
+#include "MultiplicityMatrix.h"
+#include "GSKV_Interpolation.h"
+#include "RR_Factorization.h"
+#include "FinalEvaluation.h"
+#include "RS_Encoding.h"
+#include "Channel.h"
+#include "URandom.h"
+#include "Bench.h"
+
+#include <cmath>
+#include <sstream>
+
+static URandom ur; // Global random generator object
+
+/*
+   GF(2^4) with P(X) = X^4+X+1
+*/
+rssoft::gf::GF2_Element ppe[5] = {1,0,0,1,1};
+rssoft::gf::GF2_Polynomial ppoly(5,ppe);
+rssoft::gf::GFq gf16(4,ppoly);
+
+static const unsigned int rs_k = 5; // RS(15,5)
+
+// ================================================================================================
+// random univariate polynomial with a non zero leading coefficient
+rssoft::gf::GFq_Polynomial random_polynomial(unsigned int degree)
+{
+    std::vector<rssoft::gf::GFq_Element> coefficients;
+
+    for (unsigned int i=0; i<degree; i++)
+    {
+        coefficients.push_back(rssoft::gf::GFq_Element(gf16, ur.rand_int(gf16.size()+1)));
+    }
+
+    coefficients.push_back(rssoft::gf::GFq_Element(gf16, 1 + ur.rand_int(gf16.size())));
+    return rssoft::gf::GFq_Polynomial(gf16, coefficients);
+}
+
+// ================================================================================================
+// random bivariate polynomial with (1,k-1) weights and all monomials up to the given weighted degree
+rssoft::gf::GFq_BivariatePolynomial random_bivariate_polynomial(unsigned int wdeg)
+{
+    std::vector<rssoft::gf::GFq_BivariateMonomial> monomials;
+
+    for (unsigned int j=0; j*(rs_k-1)<=wdeg; j++)
+    {
+        for (unsigned int i=0; i+j*(rs_k-1)<=wdeg; i++)
+        {
+            monomials.push_back(rssoft::gf::GFq_BivariateMonomial(rssoft::gf::GFq_Element(gf16, 1 + ur.rand_int(gf16.size())), i, j));
+        }
+    }
+
+    rssoft::gf::GFq_BivariatePolynomial P(1,rs_k-1);
+    P.init(monomials);
+    return P;
+}
+
+// ================================================================================================
+// micro: field multiplication and division on symbols and on elements
+void bench_gf_mul(BenchState& state)
+{
+    ur.set_stream_seed(1);
+    std::vector<rssoft::gf::GFq_Symbol> symbols;
+
+    for (unsigned int i=0; i<1024; i++)
+    {
+        symbols.push_back(1 + ur.rand_int(gf16.size()));
+    }
+
+    rssoft::gf::GFq_Symbol acc = 1;
+    unsigned int i = 0;
+
+    while (state.keep_running())
+    {
+        acc = gf16.mul(acc, symbols[i]);
+        bench_do_not_optimize(acc);
+        i = (i+1) & 1023;
+    }
+}
+
+void bench_gf_div(BenchState& state)
+{
+    ur.set_stream_seed(1);
+    std::vector<rssoft::gf::GFq_Symbol> symbols;
+
+    for (unsigned int i=0; i<1024; i++)
+    {
+        symbols.push_back(1 + ur.rand_int(gf16.size()));
+    }
+
+    rssoft::gf::GFq_Symbol acc = 1;
+    unsigned int i = 0;
+
+    while (state.keep_running())
+    {
+        acc = gf16.div(acc, symbols[i]);
+        bench_do_not_optimize(acc);
+        i = (i+1) & 1023;
+    }
+}
+
+void bench_gf_element_mul(BenchState& state)
+{
+    ur.set_stream_seed(1);
+    std::vector<rssoft::gf::GFq_Element> elements;
+
+    for (unsigned int i=0; i<1024; i++)
+    {
+        elements.push_back(rssoft::gf::GFq_Element(gf16, 1 + ur.rand_int(gf16.size())));
+    }
+
+    rssoft::gf::GFq_Element acc(gf16, 1);
+    unsigned int i = 0;
+
+    while (state.keep_running())
+    {
+        acc *= elements[i];
+        bench_do_not_optimize(acc);
+        i = (i+1) & 1023;
+    }
+}
+
+// ================================================================================================
+// micro: univariate polynomial multiplication, division and Chien search
+void bench_poly_mul(BenchState& state, unsigned int degree)
+{
+    ur.set_stream_seed(2);
+    rssoft::gf::GFq_Polynomial a = random_polynomial(degree);
+    rssoft::gf::GFq_Polynomial b = random_polynomial(degree);
+
+    while (state.keep_running())
+    {
+        rssoft::gf::GFq_Polynomial c = a * b;
+        bench_do_not_optimize(c);
+    }
+}
+
+void bench_poly_div(BenchState& state, unsigned int degree)
+{
+    ur.set_stream_seed(3);
+    rssoft::gf::GFq_Polynomial a = random_polynomial(2*degree);
+    rssoft::gf::GFq_Polynomial b = random_polynomial(degree);
+
+    while (state.keep_running())
+    {
+        rssoft::gf::GFq_Polynomial c = a / b;
+        bench_do_not_optimize(c);
+    }
+}
+
+void bench_poly_rootChien(BenchState& state, unsigned int degree)
+{
+    ur.set_stream_seed(4);
+    rssoft::gf::GFq_Polynomial a = random_polynomial(degree);
+    std::vector<rssoft::gf::GFq_Element> roots;
+
+    while (state.keep_running())
+    {
+        roots.clear();
+        a.rootChien(roots);
+        bench_do_not_optimize(roots);
+    }
+}
+
+// ================================================================================================
+// micro: bivariate polynomial Hasse derivative, multiplication and composition as in the factorization
+void bench_bpoly_dHasse(BenchState& state, unsigned int wdeg, unsigned int mu, unsigned int nu)
+{
+    ur.set_stream_seed(5);
+    rssoft::gf::GFq_BivariatePolynomial P = random_bivariate_polynomial(wdeg);
+
+    while (state.keep_running())
+    {
+        rssoft::gf::GFq_BivariatePolynomial D = rssoft::gf::dHasse(mu, nu, P);
+        bench_do_not_optimize(D);
+    }
+}
+
+void bench_bpoly_mul(BenchState& state, unsigned int wdeg)
+{
+    ur.set_stream_seed(6);
+    rssoft::gf::GFq_BivariatePolynomial P = random_bivariate_polynomial(wdeg);
+    rssoft::gf::GFq_BivariatePolynomial Q = random_bivariate_polynomial(wdeg);
+
+    while (state.keep_running())
+    {
+        rssoft::gf::GFq_BivariatePolynomial R = P * Q;
+        bench_do_not_optimize(R);
+    }
+}
+
+void bench_bpoly_compose(BenchState& state, unsigned int wdeg)
+{
+    ur.set_stream_seed(7);
+    rssoft::gf::GFq_BivariatePolynomial P = random_bivariate_polynomial(wdeg);
+    rssoft::gf::GFq_BivariatePolynomial X1Y0(P.get_weights());
+    X1Y0.init_x_pow(gf16, 1); // X1Y0(X,Y) = X
+    rssoft::gf::GFq_BivariatePolynomial Yv(P.get_weights()); // Yv(X,Y) = X*Y + ry
+    std::vector<rssoft::gf::GFq_BivariateMonomial> monos_Yv;
+    monos_Yv.push_back(rssoft::gf::GFq_BivariateMonomial(rssoft::gf::GFq_Element(gf16, 3), 0, 0));
+    monos_Yv.push_back(rssoft::gf::GFq_BivariateMonomial(rssoft::gf::GFq_Element(gf16, 1), 1, 1));
+    Yv.init(monos_Yv);
+
+    while (state.keep_running())
+    {
+        rssoft::gf::GFq_BivariatePolynomial R = P(X1Y0, Yv);
+        bench_do_not_optimize(R);
+    }
+}
+
+// ================================================================================================
+// micro: AWGN reliability matrix of a codeword with a URandom gaussian sample per matrix element
+void bench_noise_urandom(BenchState& state)
+{
+    unsigned int q = gf16.size()+1;
+    unsigned int n = q-1;
+    double std_dev = 1.0 / pow(10.0, (5.0/10.0));
+    rssoft::EvaluationValues evaluation_values(gf16);
+    std::vector<float> mat_Pi_col(q);
+    rssoft::RS_ReliabilityMatrix mat_Pi(gf16.pwr(), n);
+    ur.set_stream_seed(1);
+
+    while (state.keep_running())
+    {
+        mat_Pi.reset_message_symbol_count();
+
+        for (unsigned int c=0; c<n; c++)
+        {
+            for (unsigned int r=0; r<q; r++)
+            {
+                mat_Pi_col[r] = (evaluation_values.get_y_values()[r] == c ? 1.0 : 0.0) + std_dev * ur.rand_gaussian();
+                mat_Pi_col[r] *= mat_Pi_col[r];
+            }
+
+            mat_Pi.enter_symbol_data(&mat_Pi_col[0]);
+        }
+
+        bench_do_not_optimize(mat_Pi(0,0));
+    }
+}
+
+// ================================================================================================
+// micro: same reliability matrix generated in one block by the bulk channel generator
+void bench_noise_channel(BenchState& state, rssoft::Channel::Model model)
+{
+    unsigned int n = gf16.size();
+    rssoft::EvaluationValues evaluation_values(gf16);
+    rssoft::RS_ReliabilityMatrix mat_Pi(gf16.pwr(), n);
+    rssoft::Channel channel(evaluation_values, model, 1);
+    channel.set_snr(5.0);
+    std::vector<rssoft::gf::GFq_Symbol> codeword;
+
+    for (unsigned int c=0; c<n; c++)
+    {
+        codeword.push_back(c);
+    }
+
+    while (state.keep_running())
+    {
+        channel.fill(mat_Pi, codeword);
+        bench_do_not_optimize(mat_Pi(0,0));
+    }
+}
+
+// ================================================================================================
+// AWGN codewords: random messages encoded and turned into normalized reliability matrices
+struct Codewords
+{
+    std::vector<std::vector<rssoft::gf::GFq_Symbol> > messages;
+    std::vector<rssoft::RS_ReliabilityMatrix> relmats;
+};
+
+void create_codewords(unsigned int seed, unsigned int nb_codewords, float snr_dB, Codewords& codewords)
+{
+    unsigned int q = gf16.size()+1;
+    unsigned int n = q-1;
+    double std_dev = 1.0 / pow(10.0, (snr_dB/10.0)); // Standard deviation for power AWGN
+    rssoft::EvaluationValues evaluation_values(gf16);
+    rssoft::RS_Encoding rs_encoding(gf16, rs_k, evaluation_values);
+    std::vector<float> mat_Pi_col(q);
+
+    ur.set_stream_seed(seed);
+
+    for (unsigned int ci=0; ci<nb_codewords; ci++)
+    {
+        std::vector<rssoft::gf::GFq_Symbol> message;
+        std::vector<rssoft::gf::GFq_Symbol> codeword;
+
+        for (unsigned int i=0; i<rs_k; i++)
+        {
+            message.push_back(ur.rand_int(q));
+        }
+
+        rs_encoding.run(message, codeword);
+        rssoft::RS_ReliabilityMatrix mat_Pi(gf16.pwr(), n);
+
+        for (unsigned int c=0; c<n; c++)
+        {
+            for (unsigned int r=0; r<q; r++)
+            {
+                mat_Pi_col[r] = (evaluation_values.get_y_values()[r] == codeword[c] ? 1.0 : 0.0) + std_dev * ur.rand_gaussian();
+                mat_Pi_col[r] *= mat_Pi_col[r];
+            }
+
+            mat_Pi.enter_symbol_data(&mat_Pi_col[0]);
+        }
+
+        mat_Pi.normalize();
+        codewords.messages.push_back(message);
+        codewords.relmats.push_back(mat_Pi);
+    }
+}
+
+// ================================================================================================
+// macro: multiplicity matrix, interpolation, factorization and final evaluation of codewords in turn
+void bench_rs_decode(BenchState& state, const Codewords& codewords, unsigned int multiplicity)
+{
+    rssoft::EvaluationValues evaluation_values(gf16);
+    rssoft::GSKV_Interpolation gskv(gf16, rs_k, evaluation_values);
+    rssoft::RR_Factorization rr(gf16, rs_k);
+    rssoft::FinalEvaluation final_evaluation(gf16, rs_k, evaluation_values);
+    unsigned int nb_decodes = 0;
+    unsigned int nb_found = 0;
+    unsigned int ci = 0;
+
+    while (state.keep_running())
+    {
+        bool found = false;
+        rssoft::MultiplicityMatrix mat_M(codewords.relmats[ci], multiplicity);
+        const rssoft::gf::GFq_BivariatePolynomial& Q = gskv.run(mat_M);
+
+        if (!Q.is_in_X())
+        {
+            std::vector<rssoft::gf::GFq_Polynomial>& res_polys = rr.run(Q);
+
+            if (res_polys.size() > 0)
+            {
+                final_evaluation.run(res_polys, codewords.relmats[ci]);
+                const std::vector<rssoft::ProbabilityCodeword>& messages = final_evaluation.get_messages();
+                std::vector<rssoft::ProbabilityCodeword>::const_iterator ms_it = messages.begin();
+
+                for (; ms_it != messages.end(); ++ms_it)
+                {
+                    found = found || rssoft::gf::compare_symbol_vectors(ms_it->get_codeword(), codewords.messages[ci]);
+                }
+
+                final_evaluation.init();
+            }
+        }
+
+        gskv.init();
+        rr.init();
+
+        nb_decodes++;
+        nb_found += (found ? 1 : 0);
+        ci = (ci+1) % codewords.relmats.size();
+    }
+
+    state.set_counter("success_rate", nb_decodes ? ((double) nb_found) / nb_decodes : 0.0);
+}
+
+// ================================================================================================
+int main(int argc, char *argv[])
+{
+    BenchRunner runner("RSBench", argc, argv);
+    static const unsigned int nb_codewords = 16;
+    static const unsigned int multiplicities[] = {8, 16, 32};
+    static const float snrs_dB[] = {3.0, 5.0, 7.0};
+
+    runner.add("gf/mul", bench_gf_mul);
+    runner.add("gf/div", bench_gf_div);
+    runner.add("gf/element_mul", bench_gf_element_mul);
+    runner.add("poly/mul/4", [](BenchState& state) { bench_poly_mul(state, 4); });
+    runner.add("poly/mul/14", [](BenchState& state) { bench_poly_mul(state, 14); });
+    runner.add("poly/div/4", [](BenchState& state) { bench_poly_div(state, 4); });
+    runner.add("poly/div/7", [](BenchState& state) { bench_poly_div(state, 7); });
+    runner.add("poly/rootChien/4", [](BenchState& state) { bench_poly_rootChien(state, 4); });
+    runner.add("poly/rootChien/14", [](BenchState& state) { bench_poly_rootChien(state, 14); });
+    runner.add("bpoly/dHasse/wdeg:12/1,1", [](BenchState& state) { bench_bpoly_dHasse(state, 12, 1, 1); });
+    runner.add("bpoly/dHasse/wdeg:24/2,1", [](BenchState& state) { bench_bpoly_dHasse(state, 24, 2, 1); });
+    runner.add("bpoly/mul/wdeg:12", [](BenchState& state) { bench_bpoly_mul(state, 12); });
+    runner.add("bpoly/compose/wdeg:12", [](BenchState& state) { bench_bpoly_compose(state, 12); });
+    runner.add("bpoly/compose/wdeg:24", [](BenchState& state) { bench_bpoly_compose(state, 24); });
+    runner.add("noise/urandom", bench_noise_urandom);
+    runner.add("noise/awgn", [](BenchState& state) { bench_noise_channel(state, rssoft::Channel::AWGN); });
+    runner.add("noise/rayleigh", [](BenchState& state) { bench_noise_channel(state, rssoft::Channel::Rayleigh); });
+
+    // codewords are shared by all multiplicities and generated once for each SNR
+    std::vector<Codewords> all_codewords(sizeof(snrs_dB)/sizeof(float));
+
+    for (unsigned int si=0; si<sizeof(snrs_dB)/sizeof(float); si++)
+    {
+        const Codewords& codewords = all_codewords[si];
+        create_codewords(100+si, nb_codewords, snrs_dB[si], all_codewords[si]);
+
+        for (unsigned int mi=0; mi<sizeof(multiplicities)/sizeof(unsigned int); mi++)
+        {
+            unsigned int multiplicity = multiplicities[mi];
+            std::ostringstream name;
+            name << "rs_decode/RS(15," << rs_k << ")/m:" << multiplicity << "/snr:" << snrs_dB[si];
+            runner.add(name.str(), [&codewords, multiplicity](BenchState& state) { bench_rs_decode(state, codewords, multiplicity); }, 1<<16);
+        }
+    }
+
+    return runner.run();
+}
@@ -0,0 +1,171 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of RSSoft. A Reed-Solomon Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Channel simulation
+
+ */
+
+#include "Channel.h"
+#include "EvaluationValues.h"
+#include "RS_ReliabilityMatrix.h"
+#include "RSSoft_Exception.h"
+#include <cmath>
+
+namespace rssoft
+{
+
+// ================================================================================================
+Xoshiro256::Xoshiro256(unsigned long long seed)
+{
+	set_seed(seed);
+}
+
+// ================================================================================================
+Xoshiro256::~Xoshiro256()
+{}
+
+// ================================================================================================
+void Xoshiro256::set_seed(unsigned long long seed)
+{
+	for (unsigned int i=0; i<4; i++) // SplitMix64
+	{
+		unsigned long long z = (seed += 0x9e3779b97f4a7c15ULL);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		s[i] = z ^ (z >> 31);
+	}
+}
+
+// ================================================================================================
+void Xoshiro256::fill_gaussian(float *samples, unsigned int nb_samples)
+{
+	unsigned int nb_pairs = (nb_samples + 1) / 2;
+
+	if (radii.size() < nb_pairs)
+	{
+		radii.resize(nb_pairs);
+		angles.resize(nb_pairs);
+	}
+
+	for (unsigned int i=0; i<nb_pairs; i++) // 24 bits uniforms from each half of a 64 bit value
+	{
+		unsigned long long r = next();
+		radii[i] = ((r >> 40) + 0.5f) * (1.0f / 16777216.0f);
+		angles[i] = ((r >> 8) & 0xffffff) * (1.0f / 16777216.0f);
+	}
+
+	unsigned int nb_full_pairs = nb_samples / 2;
+
+	for (unsigned int i=0; i<nb_full_pairs; i++) // no dependencies between iterations so that it can be vectorized
+	{
+		float radius = sqrtf(-2.0f * logf(radii[i]));
+		float angle = 2.0f * (float) M_PI * angles[i];
+		samples[2*i] = radius * cosf(angle);
+		samples[2*i+1] = radius * sinf(angle);
+	}
+
+	if (nb_full_pairs < nb_pairs) // odd number of samples
+	{
+		samples[nb_samples-1] = sqrtf(-2.0f * logf(radii[nb_full_pairs])) * cosf(2.0f * (float) M_PI * angles[nb_full_pairs]);
+	}
+}
+
+// ================================================================================================
+Channel::Channel(const EvaluationValues& evaluation_values, Model _model, unsigned long long seed) :
+		model(_model),
+		random(seed),
+		std_dev(1.0)
+{
+	const std::vector<gf::GFq_Element>& y_values = evaluation_values.get_y_values();
+	symbol_rows.resize(y_values.size());
+
+	for (unsigned int r=0; r<y_values.size(); r++)
+	{
+		symbol_rows[y_values[r].poly()] = r;
+	}
+}
+
+// ================================================================================================
+Channel::~Channel()
+{}
+
+// ================================================================================================
+void Channel::set_snr(float snr_dB)
+{
+	std_dev = 1.0 / pow(10.0, (snr_dB/10.0)); // Standard deviation for power AWGN
+}
+
+// ================================================================================================
+void Channel::fill(RS_ReliabilityMatrix& relmat, const std::vector<gf::GFq_Symbol>& codeword)
+{
+	unsigned int nb_rows = relmat.get_nb_symbols();
+	unsigned int nb_columns = relmat.get_message_length();
+	unsigned int nb_samples = nb_rows * nb_columns;
+
+	if (codeword.size() != nb_columns)
+	{
+		throw RSSoft_Exception("Codeword length does not match the reliability matrix length");
+	}
+
+	if (nb_rows != symbol_rows.size())
+	{
+		throw RSSoft_Exception("Reliability matrix does not match the evaluation values");
+	}
+
+	if (noise.size() < nb_samples)
+	{
+		noise.resize(nb_samples);
+	}
+
+	random.fill_gaussian(&noise[0], nb_samples);
+
+	if (model == Rayleigh)
+	{
+		fading.resize(2*nb_columns);
+		random.fill_gaussian(&fading[0], 2*nb_columns);
+	}
+
+	for (unsigned int c=0; c<nb_columns; c++)
+	{
+		float *column = &noise[c*nb_rows];
+
+		for (unsigned int r=0; r<nb_rows; r++)
+		{
+			column[r] *= std_dev;
+		}
+
+		if (model == Rayleigh)
+		{
+			column[symbol_rows[codeword[c]]] += sqrtf(0.5f * (fading[2*c]*fading[2*c] + fading[2*c+1]*fading[2*c+1]));
+		}
+		else
+		{
+			column[symbol_rows[codeword[c]]] += 1.0f;
+		}
+
+		for (unsigned int r=0; r<nb_rows; r++)
+		{
+			column[r] *= column[r];
+		}
+
+		relmat.enter_symbol_data(c, column);
+	}
+}
+
+} // namespace rssoft
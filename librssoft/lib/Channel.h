@@ -0,0 +1,160 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of RSSoft. A Reed-Solomon Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Channel simulation. Fast pseudo random generator, block gaussian noise
+ generation and symbol power models filling a whole reliability matrix.
+
+ */
+
+#ifndef __CHANNEL_H__
+#define __CHANNEL_H__
+
+#include "GFq.h"
+#include <vector>
+
+namespace rssoft
+{
+
+class EvaluationValues;
+class RS_ReliabilityMatrix;
+
+/**
+ * \brief xoshiro256** pseudo random generator by D. Blackman and S. Vigna. The 256 bit state is initialized from a
+ * 64 bit seed with SplitMix64.
+ */
+class Xoshiro256
+{
+public:
+	/**
+	 * Constructor
+	 * \param seed Seed of the generator
+	 */
+	Xoshiro256(unsigned long long seed = 0);
+
+	/**
+	 * Destructor
+	 */
+	~Xoshiro256();
+
+	/**
+	 * Restart the generator from a seed
+	 */
+	void set_seed(unsigned long long seed);
+
+	/**
+	 * Next 64 bit random value
+	 */
+	unsigned long long next()
+	{
+		unsigned long long result = rotl(s[1] * 5, 7) * 9;
+		unsigned long long t = s[1] << 17;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 45);
+		return result;
+	}
+
+	/**
+	 * Random integer from 0 to n-1
+	 */
+	unsigned int rand_int(unsigned int n)
+	{
+		return (unsigned int) (((next() >> 32) * n) >> 32);
+	}
+
+	/**
+	 * Fill an array with standard normal samples using the Box-Muller method on a whole block of uniforms
+	 * \param samples Array of nb_samples samples
+	 * \param nb_samples Number of samples
+	 */
+	void fill_gaussian(float *samples, unsigned int nb_samples);
+
+protected:
+	static unsigned long long rotl(unsigned long long x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+
+	unsigned long long s[4];  //!< Generator state
+	std::vector<float> radii;  //!< Uniforms in (0,1) of the Box-Muller radius of a block
+	std::vector<float> angles; //!< Uniforms in [0,1) of the Box-Muller angle of a block
+};
+
+/**
+ * \brief Symbol power channel model. For each symbol position the power of each possible symbol value is (s + n)^2
+ * where n is a gaussian noise sample of standard deviation 10^(-SNR/10) and s is 0 except for the sent symbol where it
+ * is 1 (AWGN) or a Rayleigh distributed amplitude of unit mean power (Rayleigh).
+ */
+class Channel
+{
+public:
+	typedef enum
+	{
+		AWGN,    //!< Additive white gaussian noise
+		Rayleigh //!< Rayleigh fading per symbol position followed by AWGN
+	} Model;
+
+	/**
+	 * Constructor
+	 * \param evaluation_values Evaluation values giving the reliability matrix row of each symbol value
+	 * \param _model Channel model
+	 * \param seed Seed of the random generator
+	 */
+	Channel(const EvaluationValues& evaluation_values, Model _model = AWGN, unsigned long long seed = 0);
+
+	/**
+	 * Destructor
+	 */
+	~Channel();
+
+	/**
+	 * Set the SNR in dB
+	 */
+	void set_snr(float snr_dB);
+
+	/**
+	 * Get the random generator
+	 */
+	Xoshiro256& get_random()
+	{
+		return random;
+	}
+
+	/**
+	 * Fill the whole reliability matrix with the received symbol powers of a sent codeword. The matrix is not normalized.
+	 * \param relmat Reliability matrix
+	 * \param codeword Sent codeword symbols
+	 */
+	void fill(RS_ReliabilityMatrix& relmat, const std::vector<gf::GFq_Symbol>& codeword);
+
+protected:
+	Model model;                       //!< Channel model
+	Xoshiro256 random;                 //!< Random generator
+	float std_dev;                     //!< Noise standard deviation
+	std::vector<unsigned int> symbol_rows; //!< Reliability matrix row of each symbol value
+	std::vector<float> noise;          //!< Noise samples column first
+	std::vector<float> fading;         //!< In-phase and quadrature fading samples of each column
+};
+
+} // namespace rssoft
+
+#endif // __CHANNEL_H__
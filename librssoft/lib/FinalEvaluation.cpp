@@ -25,6 +25,7 @@
 #include "EvaluationValues.h"
 #include "RS_ReliabilityMatrix.h"
 #include "RSSoft_Exception.h"
+#include "Instrumentation.h"
  
 #include <algorithm>
 #include <utility>
@@ -71,7 +72,8 @@ void ProbabilityCodeword::print_codeword(std::ostream& os) const
 FinalEvaluation::FinalEvaluation(const gf::GFq& _gf, unsigned int _k, const EvaluationValues& _evaluation_values) :
     gf(_gf),
     k(_k),
-    evaluation_values(_evaluation_values)
+    evaluation_values(_evaluation_values),
+    stats(0)
 {
 	std::vector<gf::GFq_Element>::const_iterator s_it = evaluation_values.get_symbols().begin();
     unsigned int i_s = 0;
@@ -96,6 +98,8 @@ void FinalEvaluation::init()
 // ================================================================================================
 void FinalEvaluation::run(const std::vector<gf::GFq_Polynomial>& polynomials, const RS_ReliabilityMatrix& relmat)
 {
+    INSTRUMENTATION_TIMER(stats, DecodingStats::Stage_FinalEvaluation);
+
     if (polynomials.size() == 0)
     {
         throw RSSoft_Exception("Cannot evaluate empty list of polynomials");
@@ -38,6 +38,7 @@ class GFq_Polynomial;
 
 class EvaluationValues;
 class RS_ReliabilityMatrix;
+class DecodingStats;
 
 /**
  * \brief Probability score weighted codeword 
@@ -150,6 +151,15 @@ public:
      */
     void init();
 
+    /**
+     * Set the statistics updated by the next runs. Active only in instrumentation mode (_INSTRUMENTATION defined)
+     * \param _stats Pointer to the statistics or 0 for none
+     */
+    void set_stats(DecodingStats *_stats)
+    {
+        stats = _stats;
+    }
+
     /**
      * Runs one evaluation for the given polynomials
      */
@@ -199,6 +209,7 @@ protected:
     std::map<gf::GFq_Element, unsigned int> symbol_index; //!< Symbol index in reliability matrix row order
     std::vector<ProbabilityCodeword> codewords; //!< The codewords (overriden at each run)
     std::vector<ProbabilityCodeword> messages; //!< The encoded messages (overriden at each run)
+    DecodingStats *stats; //!< Statistics to update, 0 for none
 };
 
 } // namespace rssoft
@@ -29,6 +29,7 @@
 #include "EvaluationValues.h"
 #include "MultiplicityMatrix.h"
 #include "Debug.h"
+#include "Instrumentation.h"
 #include <cmath>
 #include <iostream>
 #include <string>
@@ -46,6 +47,7 @@ GSKV_Interpolation::GSKV_Interpolation(const gf::GFq& _gf, unsigned int _k, cons
 		Cm(0),
 		final_ig(0),
         verbosity(0),
+        stats(0),
         dX(0),
         dY(0),
         mcost(0)
@@ -74,6 +76,7 @@ void GSKV_Interpolation::init()
 // ================================================================================================
 const gf::GFq_BivariatePolynomial& GSKV_Interpolation::run(const MultiplicityMatrix& mmat)
 {
+	INSTRUMENTATION_TIMER(stats, DecodingStats::Stage_Interpolation);
 	std::pair<unsigned int, unsigned int> max_degrees = maximum_degrees(mmat);
 	dX = max_degrees.first;
 	dY = max_degrees.second;
@@ -172,6 +175,7 @@ void GSKV_Interpolation::process_hasse(const gf::GFq_Element& x, const gf::GFq_E
         {
             gf::GFq_BivariatePolynomial h = dHasse(mu, nu, *it_g);
             hasse_xy_G.push_back(h(x,y));
+            INSTRUMENTATION_COUNT(stats, nb_hasse_evaluations, 1);
             unsigned int wd = it_g->wdeg();
             
             if (hasse_xy_G.back().is_zero())
@@ -203,6 +207,7 @@ void GSKV_Interpolation::process_hasse(const gf::GFq_Element& x, const gf::GFq_E
         {
             ind = "x";
             hasse_xy_G.push_back(gf::GFq_Element(gf,0));
+            INSTRUMENTATION_COUNT(stats, nb_calcG_skips, 1);
         }
         
         // debug print stuff
@@ -39,6 +39,7 @@ class GFq;
 
 class MultiplicityMatrix;
 class EvaluationValues;
+class DecodingStats;
 
 class GSKV_Interpolation
 {
@@ -77,6 +78,15 @@ public:
     {
         verbosity = _verbosity;
     }
+
+    /**
+     * Set the statistics updated by the next runs. Active only in instrumentation mode (_INSTRUMENTATION defined)
+     * \param _stats Pointer to the statistics or 0 for none
+     */
+    void set_stats(DecodingStats *_stats)
+    {
+        stats = _stats;
+    }
     
     unsigned int get_dX() const
     {
@@ -134,6 +144,7 @@ protected:
 	unsigned int k; //!< k factor as in RS(n,k)
 	const EvaluationValues& evaluation_values; //!< Interpolation X,Y values
     unsigned int verbosity; //!< Verbose level, 0 to shut down any debug message
+    DecodingStats *stats; //!< Statistics to update, 0 for none
 
 	// parameters changing at each process run
     unsigned int dX;
@@ -0,0 +1,223 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of RSSoft. A Reed-Solomon Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Instrumentation of the soft decoding stages
+
+ */
+
+#include "Instrumentation.h"
+#include <cstring>
+
+namespace rssoft
+{
+
+// ================================================================================================
+DecodingStats::DecodingStats()
+{
+    clear();
+}
+
+// ================================================================================================
+DecodingStats::~DecodingStats()
+{}
+
+// ================================================================================================
+void DecodingStats::clear()
+{
+    memset(stage_ns, 0, sizeof(stage_ns));
+    nb_hasse_evaluations = 0;
+    nb_calcG_skips = 0;
+    nb_rr_nodes = 0;
+    nb_chien_searches = 0;
+}
+
+// ================================================================================================
+DecodingStats& DecodingStats::operator+=(const DecodingStats& other)
+{
+    for (unsigned int i=0; i<Stage_Count; i++)
+    {
+        stage_ns[i] += other.stage_ns[i];
+    }
+
+    nb_hasse_evaluations += other.nb_hasse_evaluations;
+    nb_calcG_skips += other.nb_calcG_skips;
+    nb_rr_nodes += other.nb_rr_nodes;
+    nb_chien_searches += other.nb_chien_searches;
+    return *this;
+}
+
+// ================================================================================================
+const char *DecodingStats::get_stage_name(Stage stage)
+{
+    switch (stage)
+    {
+    case Stage_Normalize:
+        return "normalize";
+    case Stage_Multiplicity:
+        return "multiplicity";
+    case Stage_Interpolation:
+        return "interpolation";
+    case Stage_Factorization:
+        return "factorization";
+    case Stage_FinalEvaluation:
+        return "final_evaluation";
+    default:
+        return "unknown";
+    }
+}
+
+// ================================================================================================
+void DecodingStats::print(std::ostream& os) const
+{
+    for (unsigned int i=0; i<Stage_Count; i++)
+    {
+        os << get_stage_name((Stage) i) << "_ns=" << stage_ns[i] << " ";
+    }
+
+    os << "hasse=" << nb_hasse_evaluations
+       << " calcG_skips=" << nb_calcG_skips
+       << " rr_nodes=" << nb_rr_nodes
+       << " chien=" << nb_chien_searches;
+}
+
+// ================================================================================================
+std::ostream& operator <<(std::ostream& os, const DecodingStats& stats)
+{
+    stats.print(os);
+    return os;
+}
+
+// ================================================================================================
+StatsHistogram::StatsHistogram()
+{
+    clear();
+}
+
+// ================================================================================================
+StatsHistogram::~StatsHistogram()
+{}
+
+// ================================================================================================
+void StatsHistogram::clear()
+{
+    count = 0;
+    sum = 0;
+    min = 0;
+    max = 0;
+    memset(buckets, 0, sizeof(buckets));
+}
+
+// ================================================================================================
+void StatsHistogram::add(unsigned long long v)
+{
+    if ((count == 0) || (v < min))
+    {
+        min = v;
+    }
+
+    if ((count == 0) || (v > max))
+    {
+        max = v;
+    }
+
+    count++;
+    sum += v;
+
+    unsigned int b = 0;
+
+    for (; v; v >>= 1) // number of significant bits
+    {
+        b++;
+    }
+
+    buckets[b]++;
+}
+
+// ================================================================================================
+void StatsHistogram::print(std::ostream& os) const
+{
+    os << "n=" << count << " mean=" << get_mean() << " min=" << min << " max=" << max;
+
+    for (unsigned int b=0; b<nb_buckets; b++)
+    {
+        if (buckets[b])
+        {
+            os << " <" << (b ? "2^" : "") << (b ? b : 1) << ":" << buckets[b];
+        }
+    }
+}
+
+// ================================================================================================
+DecodingStatsAggregate::DecodingStatsAggregate()
+{}
+
+// ================================================================================================
+DecodingStatsAggregate::~DecodingStatsAggregate()
+{}
+
+// ================================================================================================
+void DecodingStatsAggregate::clear()
+{
+    for (unsigned int i=0; i<DecodingStats::Stage_Count; i++)
+    {
+        stage_ns[i].clear();
+    }
+
+    nb_hasse_evaluations.clear();
+    nb_calcG_skips.clear();
+    nb_rr_nodes.clear();
+    nb_chien_searches.clear();
+}
+
+// ================================================================================================
+void DecodingStatsAggregate::add(const DecodingStats& stats)
+{
+    for (unsigned int i=0; i<DecodingStats::Stage_Count; i++)
+    {
+        stage_ns[i].add(stats.stage_ns[i]);
+    }
+
+    nb_hasse_evaluations.add(stats.nb_hasse_evaluations);
+    nb_calcG_skips.add(stats.nb_calcG_skips);
+    nb_rr_nodes.add(stats.nb_rr_nodes);
+    nb_chien_searches.add(stats.nb_chien_searches);
+}
+
+// ================================================================================================
+void DecodingStatsAggregate::print(std::ostream& os, const char *prefix) const
+{
+    for (unsigned int i=0; i<DecodingStats::Stage_Count; i++)
+    {
+        os << prefix << DecodingStats::get_stage_name((DecodingStats::Stage) i) << "_ns ";
+        stage_ns[i].print(os);
+        os << std::endl;
+    }
+
+    os << prefix << "hasse ";
+    nb_hasse_evaluations.print(os);
+    os << std::endl << prefix << "calcG_skips ";
+    nb_calcG_skips.print(os);
+    os << std::endl << prefix << "rr_nodes ";
+    nb_rr_nodes.print(os);
+    os << std::endl << prefix << "chien ";
+    nb_chien_searches.print(os);
+    os << std::endl;
+}
+
+} // namespace rssoft
@@ -0,0 +1,197 @@
+/*
+ Copyright 2013 Edouard Griffiths <f4exb at free dot fr>
+
+ This file is part of RSSoft. A Reed-Solomon Soft Decoding library
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Boston, MA  02110-1301  USA
+
+ Instrumentation of the soft decoding stages: per stage timers and hot
+ path counters. The hooks are compiled in only when _INSTRUMENTATION is
+ defined (CPPFLAGS=-D_INSTRUMENTATION) else they cost nothing.
+
+ */
+#ifndef __INSTRUMENTATION_H__
+#define __INSTRUMENTATION_H__
+
+#include <time.h>
+#include <iostream>
+
+namespace rssoft
+{
+
+/**
+ * \brief Statistics of one soft decoding
+ */
+class DecodingStats
+{
+public:
+    /**
+     * \brief Timed decoding stages
+     */
+    typedef enum
+    {
+        Stage_Normalize,       //!< Reliability matrix normalization
+        Stage_Multiplicity,    //!< Multiplicity matrix construction
+        Stage_Interpolation,   //!< GSKV interpolation
+        Stage_Factorization,   //!< Roth-Ruckenstein factorization
+        Stage_FinalEvaluation, //!< Final evaluation of the candidate codewords
+        Stage_Count
+    } Stage;
+
+    DecodingStats();
+    ~DecodingStats();
+
+    /**
+     * Zero all timers and counters
+     */
+    void clear();
+
+    /**
+     * Accumulate the statistics of another decoding
+     */
+    DecodingStats& operator+=(const DecodingStats& other);
+
+    /**
+     * Name of a stage for display
+     */
+    static const char *get_stage_name(Stage stage);
+
+    /**
+     * Print to an output stream on one line
+     */
+    void print(std::ostream& os) const;
+
+    unsigned long long stage_ns[Stage_Count]; //!< Time spent in each stage in nanoseconds
+    unsigned long long nb_hasse_evaluations;  //!< Hasse derivatives evaluated by the interpolation
+    unsigned long long nb_calcG_skips;        //!< Polynomials skipped by the interpolation as per Li Chen's optimization
+    unsigned long long nb_rr_nodes;           //!< Roth-Ruckenstein nodes created not counting the roots
+    unsigned long long nb_chien_searches;     //!< Chien searches of the Roth-Ruckenstein factorization
+};
+
+/**
+ * Print decoding statistics to an output stream
+ */
+std::ostream& operator <<(std::ostream& os, const DecodingStats& stats);
+
+/**
+ * \brief Accumulates the time spent in its scope to a stage of decoding statistics. Does nothing if the statistics
+ * pointer is null.
+ */
+class InstrumentationTimer
+{
+public:
+    InstrumentationTimer(DecodingStats *_stats, DecodingStats::Stage _stage) :
+        stats(_stats),
+        stage(_stage)
+    {
+        if (stats)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &start_time);
+        }
+    }
+
+    ~InstrumentationTimer()
+    {
+        if (stats)
+        {
+            timespec stop_time;
+            clock_gettime(CLOCK_MONOTONIC, &stop_time);
+            stats->stage_ns[stage] += (stop_time.tv_sec - start_time.tv_sec)*1000000000LL + (stop_time.tv_nsec - start_time.tv_nsec);
+        }
+    }
+
+protected:
+    DecodingStats *stats;        //!< Statistics to update. Null for none.
+    DecodingStats::Stage stage;  //!< Stage timed
+    timespec start_time;         //!< Time at construction
+};
+
+/**
+ * \brief Histogram of a quantity over many decodings. Buckets are powers of two: bucket b counts values v with
+ * 2^(b-1) <= v < 2^b and bucket 0 counts zeros.
+ */
+class StatsHistogram
+{
+public:
+    static const unsigned int nb_buckets = 65;
+
+    StatsHistogram();
+    ~StatsHistogram();
+
+    void clear();                   //!< Forget all samples
+    void add(unsigned long long v); //!< Add a sample
+
+    unsigned long long get_count() const { return count; }
+    unsigned long long get_sum() const { return sum; }
+    unsigned long long get_min() const { return min; }
+    unsigned long long get_max() const { return max; }
+    unsigned long long get_bucket(unsigned int b) const { return buckets[b]; }
+    double get_mean() const { return (count ? ((double) sum) / count : 0.0); }
+
+    /**
+     * Print count, mean, min, max and the non empty buckets on one line
+     */
+    void print(std::ostream& os) const;
+
+protected:
+    unsigned long long count;
+    unsigned long long sum;
+    unsigned long long min;
+    unsigned long long max;
+    unsigned long long buckets[nb_buckets];
+};
+
+/**
+ * \brief Histograms of each timer and counter of the decoding statistics over many decodings
+ */
+class DecodingStatsAggregate
+{
+public:
+    DecodingStatsAggregate();
+    ~DecodingStatsAggregate();
+
+    void clear();                           //!< Forget all decodings
+    void add(const DecodingStats& stats);   //!< Add the statistics of one decoding
+
+    const StatsHistogram& get_stage_histogram(DecodingStats::Stage stage) const { return stage_ns[stage]; }
+    const StatsHistogram& get_hasse_evaluations_histogram() const { return nb_hasse_evaluations; }
+    const StatsHistogram& get_calcG_skips_histogram() const { return nb_calcG_skips; }
+    const StatsHistogram& get_rr_nodes_histogram() const { return nb_rr_nodes; }
+    const StatsHistogram& get_chien_searches_histogram() const { return nb_chien_searches; }
+
+    /**
+     * Print one histogram per line each prefixed by the given string
+     */
+    void print(std::ostream& os, const char *prefix = "") const;
+
+protected:
+    StatsHistogram stage_ns[DecodingStats::Stage_Count];
+    StatsHistogram nb_hasse_evaluations;
+    StatsHistogram nb_calcG_skips;
+    StatsHistogram nb_rr_nodes;
+    StatsHistogram nb_chien_searches;
+};
+
+} // namespace rssoft
+
+#ifdef _INSTRUMENTATION
+#define INSTRUMENTATION_TIMER(stats, stage) rssoft::InstrumentationTimer instrumentation_timer((stats), (stage))
+#define INSTRUMENTATION_COUNT(stats, counter, n) do { if (stats) { (stats)->counter += (n); } } while (0)
+#else
+#define INSTRUMENTATION_TIMER(stats, stage) do {} while (0)
+#define INSTRUMENTATION_COUNT(stats, counter, n) do {} while (0)
+#endif
+
+#endif // __INSTRUMENTATION_H__
@@ -22,6 +22,7 @@
  */
 #include "MultiplicityMatrix.h"
 #include "RS_ReliabilityMatrix.h"
+#include "Instrumentation.h"
 #include <iomanip>
 #include <cmath>
  
@@ -29,12 +30,14 @@ namespace rssoft
 { 
 
 // ================================================================================================
-MultiplicityMatrix::MultiplicityMatrix(const RS_ReliabilityMatrix& relmat, unsigned int multiplicity, bool soft_decision) :
+MultiplicityMatrix::MultiplicityMatrix(const RS_ReliabilityMatrix& relmat, unsigned int multiplicity, bool soft_decision, DecodingStats *stats) :
     _nb_symbols_log2(relmat.get_nb_symbols_log2()),
     _nb_symbols(relmat.get_nb_symbols()),
     _message_length(relmat.get_message_length()),
     _cost(0)
 {
+    INSTRUMENTATION_TIMER(stats, DecodingStats::Stage_Multiplicity);
+
     if (soft_decision)
     {
         RS_ReliabilityMatrix w_relmat(relmat);
@@ -81,12 +84,14 @@ MultiplicityMatrix::MultiplicityMatrix(const RS_ReliabilityMatrix& relmat, unsig
 }
 
 // ================================================================================================
-MultiplicityMatrix::MultiplicityMatrix(const RS_ReliabilityMatrix& relmat, float lambda) :
+MultiplicityMatrix::MultiplicityMatrix(const RS_ReliabilityMatrix& relmat, float lambda, DecodingStats *stats) :
     _nb_symbols_log2(relmat.get_nb_symbols_log2()),
     _nb_symbols(relmat.get_nb_symbols()),
     _message_length(relmat.get_message_length()),
     _cost(0)
  {
+    INSTRUMENTATION_TIMER(stats, DecodingStats::Stage_Multiplicity);
+
     for (unsigned int ic = 0; ic < _message_length; ic++)
     {
         for (unsigned int ir = 0; ir < _nb_symbols; ir++)
@@ -31,6 +31,7 @@ namespace rssoft
 {
 
 class RS_ReliabilityMatrix;
+class DecodingStats;
 
 /**
  * \brief Ordering of elements in the sparse matrix according to the column first order. Indexes are pairs of (row, column) indexes
@@ -109,15 +110,17 @@ public:
      * \param multiplicity For soft decision: target global multiplicity of interpolation points. For hard decision: multiplicity at each point
      * \param soft_decision True to build the matrix for soft decision decoding (default) 
      *                      else to build the matrix for hard decision list decoding with specified multiplicity at each point
+     * \param stats Statistics to update in instrumentation mode (_INSTRUMENTATION defined) or 0 for none
      */
-    MultiplicityMatrix(const RS_ReliabilityMatrix& relmat, unsigned int multiplicity, bool soft_decision=true);
+    MultiplicityMatrix(const RS_ReliabilityMatrix& relmat, unsigned int multiplicity, bool soft_decision=true, DecodingStats *stats=0);
 
     /**
      * Constructs a new multiplicity matrix. Uses short construction algorithm.
      * \param relmat Reliability matrix to build the multiplicity matrix from
      * \param lambda Multiplicative constant
+     * \param stats Statistics to update in instrumentation mode (_INSTRUMENTATION defined) or 0 for none
      */
-    MultiplicityMatrix(const RS_ReliabilityMatrix& relmat, float lambda);
+    MultiplicityMatrix(const RS_ReliabilityMatrix& relmat, float lambda, DecodingStats *stats=0);
     
     /**
      * Destructor
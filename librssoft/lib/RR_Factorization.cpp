@@ -27,6 +27,7 @@
 #include "GFq_BivariatePolynomial.h"
 #include "RSSoft_Exception.h"
 #include "Debug.h"
+#include "Instrumentation.h"
 
 namespace rssoft
 {
@@ -56,7 +57,8 @@ RR_Factorization::RR_Factorization(const gf::GFq& _gf, unsigned int _k) :
 		gf(_gf),
 		k(_k),
 		t(0),
-        verbosity(0)
+        verbosity(0),
+        stats(0)
 {
 
 }
@@ -77,6 +79,8 @@ void RR_Factorization::init()
 // ================================================================================================
 std::vector<gf::GFq_Polynomial>& RR_Factorization::run(const gf::GFq_BivariatePolynomial& polynomial)
 {
+    INSTRUMENTATION_TIMER(stats, DecodingStats::Stage_Factorization);
+
     if (!polynomial.is_valid())
     {
         throw RSSoft_Exception("Invalid polynomial");
@@ -97,6 +101,7 @@ gf::GFq_Polynomial RR_Factorization::node_run(RR_Node& rr_node)
     gf::GFq_Polynomial Qy = Qu.get_0_Y();
 	std::vector<rssoft::gf::GFq_Element> roots_y;
 	Qy.rootChien(roots_y);
+	INSTRUMENTATION_COUNT(stats, nb_chien_searches, 1);
 	std::vector<rssoft::gf::GFq_Element>::const_iterator ry_it = roots_y.begin();
     
     DEBUG_OUT(verbosity > 0, "*** Node #" << rr_node.get_id() << ": " << rr_node.get_degree() << " " << rr_node.get_coeff() << std::endl);
@@ -149,6 +154,7 @@ gf::GFq_Polynomial RR_Factorization::node_run(RR_Node& rr_node)
 				else
 				{ // construct a child node
 					t++;
+					INSTRUMENTATION_COUNT(stats, nb_rr_nodes, 1);
 					DEBUG_OUT(verbosity > 1, "    child #" << t << std::endl);
 					RR_Node child_node(&rr_node, Qv, *ry_it, t);
 					gf::GFq_Polynomial part_Fv = node_run(child_node); // Recursive call
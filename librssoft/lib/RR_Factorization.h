@@ -38,6 +38,8 @@ class GFq;
 class GFq_BivariatePolynomial;
 }
 
+class DecodingStats;
+
 /**
  * \brief Node in the Roth-Ruckenstein's algorithm
  */
@@ -146,6 +148,14 @@ public:
         verbosity = _verbosity;
     }
 
+    /**
+     * Set the statistics updated by the next runs. Active only in instrumentation mode (_INSTRUMENTATION defined)
+     */
+    void set_stats(DecodingStats *_stats)
+    {
+        stats = _stats;
+    }
+
 	/**
 	 * Run factorization of given polynomial
 	 * \param polynomial Input polynomial
@@ -164,6 +174,7 @@ protected:
 	const gf::GFq& gf; //!< Reference to the Galois Field being used
 	unsigned int k;    //!< k as in RS(n,k)
     unsigned int verbosity; //!< verbosity level, 0 for none
+    DecodingStats *stats; //!< statistics to update, 0 for none
     
 	unsigned int t;    //!< nodes but root node count
 	std::vector<gf::GFq_Polynomial> F; //!< Result list of f(X) polynomials
@@ -22,6 +22,7 @@
  */
 
 #include "RS_ReliabilityMatrix.h"
+#include "Instrumentation.h"
 #include <iomanip>
 #include <cstring>
 
@@ -106,8 +107,10 @@ void RS_ReliabilityMatrix::enter_erasure(unsigned int message_symbol_index)
 }
 
 // ================================================================================================
-void RS_ReliabilityMatrix::normalize()
+void RS_ReliabilityMatrix::normalize(DecodingStats *stats)
 {
+	INSTRUMENTATION_TIMER(stats, DecodingStats::Stage_Normalize);
+
 	float col_sum = 0;
 	float last_col_sum;
 
@@ -30,6 +30,8 @@
 namespace rssoft
 {
 
+class DecodingStats;
+
 /**
  * \brief Reliability Matrix class. Analog data is entered first then the normalization method is called to get the actual reliability data (probabilities).
  */
@@ -78,8 +80,9 @@ public:
 
 	/**
 	 * Normalize each column so that values represent an a posteriori probability i.e. sum of each column is 1.0
+	 * \param stats Statistics to update in instrumentation mode (_INSTRUMENTATION defined) or 0 for none
 	 */
-	void normalize();
+	void normalize(DecodingStats *stats=0);
 
 	/**
 	 * Resets the message symbol counter
@@ -34,11 +34,14 @@
 #include "FinalEvaluation.h"
 #include "RS_Encoding.h"
 #include "RS_SystematicEncoding.h"
+#include "Instrumentation.h"
+#include "Channel.h"
 #include "URandom.h"
 #include <iostream>
 #include <iomanip>
 #include <cmath>
 #include <cstdio>
+#include <algorithm>
 #include <getopt.h>
 #include <boost/lexical_cast.hpp>
 #include <boost/tokenizer.hpp>
@@ -113,7 +116,9 @@ public:
         nb_erasures(0),
         _indicator_int(0),
         message_symbols_given(false),
-        systematic_coding(false)
+        systematic_coding(false),
+        use_channel(false),
+        channel_model(rssoft::Channel::AWGN)
     {
         // http://theory.cs.uvic.ca/gen/poly.html
         rssoft::gf::GF2_Element pp_gf8[4]   = {1,1,0,1};
@@ -137,6 +142,7 @@ public:
     }
     
     bool get_options(int argc, char *argv[]);
+    bool parse_channel_model(std::string channel_model_str);
     
     bool make_noise;
     float snr_dB;
@@ -155,6 +161,8 @@ public:
     std::vector<rssoft::gf::GFq_Symbol> message_symbols;
     bool message_symbols_given;
     bool systematic_coding; //!< use systematic coding scheme
+    bool use_channel; //!< generate the noise of a codeword in one block with rssoft::Channel instead of URandom
+    rssoft::Channel::Model channel_model;
 private:
     std::vector<rssoft::gf::GF2_Polynomial> ppolys;
 };
@@ -235,10 +243,11 @@ bool Options::get_options(int argc, char *argv[])
             {"seed", required_argument, 0, 's'},              
             {"nb-iterations-max", required_argument, 0, 'i'},
             {"nb-erasures", required_argument, 0, 'e'},
+            {"channel", required_argument, 0, 'C'},
         };    
         
         int option_index = 0;
-        c = getopt_long (argc, argv, "n:m:k:M:v:s:i:e:c:", long_options, &option_index);
+        c = getopt_long (argc, argv, "n:m:k:M:v:s:i:e:c:C:", long_options, &option_index);
         
         if (c == -1) // end of options
         {
@@ -296,6 +305,9 @@ bool Options::get_options(int argc, char *argv[])
             	status = extract_vector<rssoft::gf::GFq_Symbol>(message_symbols, std::string(optarg));
             	message_symbols_given = true;
                 break;
+            case 'C':
+                status = parse_channel_model(std::string(optarg));
+                break;
             case '?':
                 status = false;
                 break;
@@ -333,6 +345,28 @@ bool Options::get_options(int argc, char *argv[])
     return status;
 }
 
+// ================================================================================================
+bool Options::parse_channel_model(std::string channel_model_str)
+{
+    std::transform(channel_model_str.begin(), channel_model_str.end(), channel_model_str.begin(), toupper);
+    use_channel = true;
+
+    if (channel_model_str == "AWGN")
+    {
+        channel_model = rssoft::Channel::AWGN;
+        return true;
+    }
+    else if (channel_model_str == "RAYLEIGH")
+    {
+        channel_model = rssoft::Channel::Rayleigh;
+        return true;
+    }
+    else
+    {
+        std::cerr << "Invalid channel model specification" << std::endl;
+        return false;
+    }
+}
 
 // ================================================================================================
 int main(int argc, char *argv[])
@@ -423,6 +457,14 @@ int main(int argc, char *argv[])
         std::vector<rssoft::gf::GFq_Symbol> hard_decision;
         unsigned int hard_decision_errors = 0;
         float *mat_Pi_col = new float[q];
+        bool channel_noise = options.use_channel && options.make_noise;
+
+        if (channel_noise) // whole matrix noise in one block, erased columns are cleared next
+        {
+            rssoft::Channel channel(evaluation_values, options.channel_model, ur.rand_uword());
+            channel.set_snr(options.snr_dB);
+            channel.fill(mat_Pi, codeword);
+        }
 
         for (unsigned int c=0; c<n; c++)
         {
@@ -436,8 +478,20 @@ int main(int argc, char *argv[])
                     if (evaluation_values.get_y_values()[r] == codeword[c]) // evaluation point
                     {
                         row_indexes.push_back(r);
-                        mat_Pi_col[r] = 1.0 + (options.make_noise ? std_dev * ur.rand_gaussian() : 0.0);
-                        mat_Pi_col[r] *= mat_Pi_col[r];
+
+                        if (channel_noise)
+                        {
+                            mat_Pi_col[r] = mat_Pi(r,c);
+                        }
+                        else
+                        {
+                            mat_Pi_col[r] = 1.0 + (options.make_noise ? std_dev * ur.rand_gaussian() : 0.0);
+                            mat_Pi_col[r] *= mat_Pi_col[r];
+                        }
+                    }
+                    else if (channel_noise)
+                    {
+                        mat_Pi_col[r] = mat_Pi(r,c);
                     }
                     else
                     {
@@ -452,7 +506,7 @@ int main(int argc, char *argv[])
                     }
                 }
 
-                mat_Pi.enter_symbol_data(mat_Pi_col);
+                mat_Pi.enter_symbol_data(c, mat_Pi_col);
                 hard_decision.push_back(evaluation_values.get_y_values()[r_max].poly());
 
                 if (hard_decision.back() != codeword[c])
@@ -462,7 +516,7 @@ int main(int argc, char *argv[])
             }
             else // erased symbol
             {
-                mat_Pi.enter_erasure();
+                mat_Pi.enter_erasure(c);
                 row_indexes.push_back(0);
                 hard_decision.push_back(0);
             }
@@ -482,7 +536,9 @@ int main(int argc, char *argv[])
         	std::cout << std::endl;
         }
 
-        mat_Pi.normalize();
+        rssoft::DecodingStats decoding_stats; // normalization is accounted to the first iteration
+        rssoft::DecodingStatsAggregate decoding_stats_aggregate;
+        mat_Pi.normalize(&decoding_stats);
         float codeword_score = 0.0;
         unsigned int codeword_count = 0;
         float best_score, worst_score;
@@ -529,7 +585,7 @@ int main(int argc, char *argv[])
         for (unsigned int ni=1; (ni<=options.iterations) && (!found); ni++)
         {
    			std::cout << std::endl;
-			rssoft::MultiplicityMatrix mat_M(mat_Pi, global_multiplicity);
+			rssoft::MultiplicityMatrix mat_M(mat_Pi, global_multiplicity, true, &decoding_stats);
 
 			if (options.verbosity > 0)
 			{
@@ -545,6 +601,8 @@ int main(int argc, char *argv[])
 			rssoft::RR_Factorization rr(gfq, options.k);
 			gskv.set_verbosity(options.verbosity);
 			rr.set_verbosity(options.verbosity);
+			gskv.set_stats(&decoding_stats);
+			rr.set_stats(&decoding_stats);
 
 			const rssoft::gf::GFq_BivariatePolynomial& Q = gskv.run(mat_M);
 			std::cout << "Q(X,Y) = " << Q << std::endl;
@@ -570,6 +628,7 @@ int main(int argc, char *argv[])
 					}
 
 					rssoft::FinalEvaluation final_evaluation(gfq, options.k, evaluation_values);
+					final_evaluation.set_stats(&decoding_stats);
 					final_evaluation.run(res_polys, mat_Pi);
 					std::cout << "Codewords:" << std::endl;
 					final_evaluation.print_codewords(std::cout, final_evaluation.get_codewords());
@@ -675,12 +734,21 @@ int main(int argc, char *argv[])
 			stat_output.nb_iterations = ni;
 			gskv.init();
 			rr.init();
+
+#ifdef _INSTRUMENTATION
+			std::cout << "_INS " << ni << " " << decoding_stats << std::endl;
+#endif
+			decoding_stats_aggregate.add(decoding_stats);
+			decoding_stats.clear();
         } // retry iterations
 
         if (options.print_stats)
         {
             std::cout << std::endl;
         	std::cout << "_RES " << stat_output << std::endl;
+#ifdef _INSTRUMENTATION
+        	decoding_stats_aggregate.print(std::cout, "_INH ");
+#endif
         }
 
         return 0;
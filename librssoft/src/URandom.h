@@ -27,6 +27,8 @@
 
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 class URandom
 {
@@ -34,6 +36,7 @@ public:
     URandom() : use_seed(false)
     {
         rf = fopen("/dev/urandom", "r");
+        memset(&seeded_state, 0, sizeof(seeded_state));
     }
     
     ~URandom() 
@@ -47,7 +50,7 @@ public:
         
         if (use_seed)
         {
-            ri = (rand()/2) - RAND_MAX;
+            ri = (seeded_rand()/2) - RAND_MAX;
         }
         else
         {
@@ -63,7 +66,7 @@ public:
         
         if (use_seed)
         {
-            ri = rand();
+            ri = seeded_rand();
         }
         else
         {
@@ -85,7 +88,7 @@ public:
     
     unsigned int rand_int(unsigned int n) // GENERATE RANDOM INTEGER FROM 0, 1, ..., (n-1)
     { 
-      return (unsigned int) (n * rand_uniform());
+        return (unsigned int) (n * rand_uniform());
     }    
     
     double rand_gaussian() // GAUSSIAN GENERATOR.  Done by using the Box-Muller method
@@ -98,8 +101,15 @@ public:
     
     void set_seed(unsigned int seed)
     {
-        std::cout << "use seed: " << seed << std::endl;
-        srand(seed);
+        std::cout << "use seed: " << std::dec << seed << std::endl;
+        set_stream_seed(seed);
+    }
+
+    // Seed silently e.g. once per frame in a worker thread. Each instance has its own state (same sequence as srand/rand)
+    // so instances seeded from different threads are independent.
+    void set_stream_seed(unsigned int seed)
+    {
+        initstate_r(seed, seeded_state_buffer, sizeof(seeded_state_buffer), &seeded_state);
         use_seed = true;
     }
     
@@ -109,8 +119,17 @@ public:
     }
     
 private:
+    int seeded_rand()
+    {
+        int32_t ri;
+        random_r(&seeded_state, &ri);
+        return ri;
+    }
+
     FILE *rf;
     bool use_seed;
+    random_data seeded_state;
+    char seeded_state_buffer[128];
 };
 
 #endif // __URANDOM_H__